@@ -8,11 +8,14 @@ set (LINK_LIBRARIES)
 # Headers
 set (TARGET_HEADERS
 	${HEADER_PATH}/soloud.h
+	${HEADER_PATH}/soloud_ambisonicbus.h
+	${HEADER_PATH}/soloud_asyncloader.h
 	${HEADER_PATH}/soloud_audiosource.h
 	${HEADER_PATH}/soloud_bassboostfilter.h
 	${HEADER_PATH}/soloud_biquadresonantfilter.h
 	${HEADER_PATH}/soloud_bus.h
 	${HEADER_PATH}/soloud_c.h
+	${HEADER_PATH}/soloud_convert.h
 	${HEADER_PATH}/soloud_dcremovalfilter.h
 	${HEADER_PATH}/soloud_echofilter.h
 	${HEADER_PATH}/soloud_error.h
@@ -24,13 +27,18 @@ set (TARGET_HEADERS
 	${HEADER_PATH}/soloud_file_hack_on.h
 	${HEADER_PATH}/soloud_filter.h
 	${HEADER_PATH}/soloud_flangerfilter.h
+	${HEADER_PATH}/soloud_hrtfbus.h
 	${HEADER_PATH}/soloud_internal.h
 	${HEADER_PATH}/soloud_lofifilter.h
 	${HEADER_PATH}/soloud_monotone.h
 	${HEADER_PATH}/soloud_openmpt.h
 	${HEADER_PATH}/soloud_queue.h
 	${HEADER_PATH}/soloud_robotizefilter.h
+	${HEADER_PATH}/soloud_samplecache.h
+	${HEADER_PATH}/soloud_scheduler.h
 	${HEADER_PATH}/soloud_sfxr.h
+	${HEADER_PATH}/soloud_simd.h
+	${HEADER_PATH}/soloud_soundbank.h
 	${HEADER_PATH}/soloud_speech.h
 	${HEADER_PATH}/soloud_tedsid.h
 	${HEADER_PATH}/soloud_thread.h
@@ -46,13 +54,16 @@ set (TARGET_HEADERS
 set (CORE_PATH ${SOURCE_PATH}/core)
 set (CORE_SOURCES
 	${CORE_PATH}/soloud.cpp
+	${CORE_PATH}/soloud_ambisonicbus.cpp
 	${CORE_PATH}/soloud_audiosource.cpp
 	${CORE_PATH}/soloud_bus.cpp
+	${CORE_PATH}/soloud_convert.cpp
 	${CORE_PATH}/soloud_core_3d.cpp
 	${CORE_PATH}/soloud_core_basicops.cpp
 	${CORE_PATH}/soloud_core_faderops.cpp
 	${CORE_PATH}/soloud_core_filterops.cpp
 	${CORE_PATH}/soloud_core_getters.cpp
+	${CORE_PATH}/soloud_core_scheduler.cpp
 	${CORE_PATH}/soloud_core_setters.cpp
 	${CORE_PATH}/soloud_core_voicegroup.cpp
 	${CORE_PATH}/soloud_core_voiceops.cpp
@@ -61,7 +72,10 @@ set (CORE_SOURCES
 	${CORE_PATH}/soloud_fft_lut.cpp
 	${CORE_PATH}/soloud_file.cpp
 	${CORE_PATH}/soloud_filter.cpp
+	${CORE_PATH}/soloud_hrtfbus.cpp
 	${CORE_PATH}/soloud_queue.cpp
+	${CORE_PATH}/soloud_scheduler.cpp
+	${CORE_PATH}/soloud_simd.cpp
 	${CORE_PATH}/soloud_thread.cpp
 )
 
@@ -84,6 +98,9 @@ set (AUDIOSOURCES_SOURCES
 	${AUDIOSOURCES_PATH}/vic/soloud_vic.cpp
 	${AUDIOSOURCES_PATH}/vizsn/soloud_vizsn.cpp
 	${AUDIOSOURCES_PATH}/wav/dr_impl.cpp
+	${AUDIOSOURCES_PATH}/wav/soloud_asyncloader.cpp
+	${AUDIOSOURCES_PATH}/wav/soloud_samplecache.cpp
+	${AUDIOSOURCES_PATH}/wav/soloud_soundbank.cpp
 	${AUDIOSOURCES_PATH}/wav/soloud_wav.cpp
 	${AUDIOSOURCES_PATH}/wav/soloud_wavstream.cpp
 	${AUDIOSOURCES_PATH}/wav/stb_vorbis.c
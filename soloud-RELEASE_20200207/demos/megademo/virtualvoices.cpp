@@ -110,7 +110,7 @@ namespace virtualvoices
 		ImGui::PlotHistogram("##FFT", fft, 256 / 2, 0, "FFT", 0, 10, ImVec2(264, 80), 8);
 		ImGui::Text("Active voices    : %d", gSoloud.getActiveVoiceCount());
 		ImGui::Text("Total voices     : %d", gSoloud.getVoiceCount());
-		ImGui::Text("Maximum voices   : %d", VOICE_COUNT);
+		ImGui::Text("Maximum voices   : %d", gSoloud.getVoiceCapacity());
 		ImGui::End();
 
 		DemoUpdateEnd();
@@ -42,6 +42,9 @@ src = [
     "newsoundsources.mmd",
     "wav.mmd",
     "wavstream.mmd",
+    "asyncloader.mmd",
+    "samplecache.mmd",
+    "soundbank.mmd",
     "speech.mmd",
     "sfxr.mmd",
     "modplug.mmd",
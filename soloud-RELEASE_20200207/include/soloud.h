@@ -82,18 +82,53 @@ freely, subject to the following restrictions:
 // Maximum number of filters per stream
 #define FILTERS_PER_STREAM 8
 
-// Number of samples to process on one go
+// Default and maximum number of samples to process on one go
 #define SAMPLE_GRANULARITY 512
 
-// Maximum number of concurrent voices (hard limit is 4095)
+// Smallest granularity accepted by Soloud::init
+#define SAMPLE_GRANULARITY_MIN 64
+
+// Samples per channel resampled at a time when a voice is mixed straight from its sample data
+// and there is no fused kernel for its channel layout
+#define DIRECT_MIX_TILE 512
+
+// Default number of voice slots; see Soloud::setVoiceCapacity()
 #define VOICE_COUNT 1024
 
+// Voice handles hold the voice slot + 1 in the low bits and the play index in the rest.
+// A play index with all bits set marks a voice group handle.
+#define VOICE_HANDLE_SLOT_BITS 16
+#define VOICE_HANDLE_SLOT_MASK ((1u << VOICE_HANDLE_SLOT_BITS) - 1)
+#define VOICE_HANDLE_INDEX_MASK (0xffffffffu >> VOICE_HANDLE_SLOT_BITS)
+#define VOICE_GROUP_HANDLE_MASK (0xffffffffu << VOICE_HANDLE_SLOT_BITS)
+
+// Maximum number of voice slots (limited by the handle encoding)
+#define VOICE_COUNT_MAX VOICE_HANDLE_SLOT_MASK
+
 // Use linear resampler
 #define RESAMPLER_LINEAR
 
 // 1)mono, 2)stereo 4)quad 6)5.1 8)7.1
 #define MAX_CHANNELS 8
 
+// Highest ambisonic order an ambisonic bus can be set to
+#define AMBISONIC_MAX_ORDER 3
+
+// B-format channels at the highest ambisonic order, (order + 1)^2
+#define AMBISONIC_MAX_CHANNELS ((AMBISONIC_MAX_ORDER + 1) * (AMBISONIC_MAX_ORDER + 1))
+
+// Maximum number of blocks mixed ahead; see Soloud::setMixAhead()
+#define MIX_AHEAD_MAX_BLOCKS 64
+
+// Voices quieter than this are mixed at lowered quality while the governor is active
+#define GOVERNOR_QUIET_VOLUME 0.1f
+
+// Blocks the governor waits after a level change before raising the level again
+#define GOVERNOR_COOLDOWN_BLOCKS 8
+
+// Blocks with load under half the budget before the governor lowers its level
+#define GOVERNOR_RESTORE_BLOCKS 256
+
 //
 /////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////
@@ -103,11 +138,16 @@ freely, subject to the following restrictions:
 namespace SoLoud
 {
 	class Soloud;
+	struct SimdKernels;
 	typedef void (*mutexCallFunction)(void *aMutexPtr);
 	typedef void (*soloudCallFunction)(Soloud *aSoloud);
 	typedef unsigned int result;
 	typedef unsigned int handle;
 	typedef double time;
+	namespace Thread
+	{
+		struct ThreadHandleData;
+	};
 };
 
 namespace SoLoud
@@ -144,6 +184,7 @@ namespace SoLoud
 
 #include "soloud_filter.h"
 #include "soloud_fader.h"
+#include "soloud_scheduler.h"
 #include "soloud_audiosource.h"
 #include "soloud_bus.h"
 #include "soloud_queue.h"
@@ -198,11 +239,54 @@ namespace SoLoud
 			CLIP_ROUNDOFF = 1,
 			ENABLE_VISUALIZATION = 2,
 			LEFT_HANDED_3D = 4,
-			NO_FPU_REGISTER_CHANGE = 8
+			NO_FPU_REGISTER_CHANGE = 8,
+			// Add TPDF dither when mixing to 16-bit output
+			DITHER_OUTPUT = 16,
+			// Lower mixing quality when mixing falls behind; see setGovernorEnable
+			ENABLE_GOVERNOR = 32
+		};
+
+		// Load governor levels, each including the ones before it
+		enum GOVERNOR_LEVELS
+		{
+			// Full quality
+			GOVERNOR_FULL = 0,
+			// Quiet voices use point sampling instead of linear interpolation
+			GOVERNOR_POINT_SAMPLING,
+			// Quiet voices skip their filters
+			GOVERNOR_SKIP_FILTERS,
+			// Active voice limit cut to 3/4
+			GOVERNOR_VOICES_75,
+			// Active voice limit cut to 1/2
+			GOVERNOR_VOICES_50,
+			// Active voice limit cut to 1/4
+			GOVERNOR_VOICES_25,
+			GOVERNOR_LEVEL_MAX
+		};
+
+		// Scheduling policies for the mixing threads
+		enum THREAD_SCHEDULING
+		{
+			// The system's default time-sharing scheduling
+			SCHEDULE_NORMAL = 0,
+			// Real-time, first in first out (SCHED_FIFO)
+			SCHEDULE_FIFO,
+			// Real-time, round robin (SCHED_RR)
+			SCHEDULE_RR
+		};
+
+		enum SIMD_LEVELS
+		{
+			SIMD_SCALAR = 0,
+			SIMD_SSE2,
+			SIMD_AVX2,
+			SIMD_AVX512,
+			SIMD_LEVEL_MAX
 		};
 
 		// Initialize SoLoud. Must be called before SoLoud can be used.
-		result init(unsigned int aFlags = Soloud::CLIP_ROUNDOFF, unsigned int aBackend = Soloud::AUTO, unsigned int aSamplerate = Soloud::AUTO, unsigned int aBufferSize = Soloud::AUTO, unsigned int aChannels = 2);
+		// aGranularity is the mixer block size in samples; a power of two from SAMPLE_GRANULARITY_MIN to SAMPLE_GRANULARITY.
+		result init(unsigned int aFlags = Soloud::CLIP_ROUNDOFF, unsigned int aBackend = Soloud::AUTO, unsigned int aSamplerate = Soloud::AUTO, unsigned int aBufferSize = Soloud::AUTO, unsigned int aChannels = 2, unsigned int aGranularity = Soloud::AUTO);
 
 		// Deinitialize SoLoud. Must be called before shutting down.
 		void deinit();
@@ -223,6 +307,14 @@ namespace SoLoud
 		unsigned int getBackendSamplerate();
 		// Returns current backend buffer size
 		unsigned int getBackendBufferSize();
+		// Returns the fastest instruction set (SIMD_LEVELS enum) usable on this CPU with this build
+		unsigned int getSupportedSimdLevel();
+		// Returns the instruction set (SIMD_LEVELS enum) the mixer currently uses
+		unsigned int getSimdLevel();
+		// Returns the mixer block size in samples
+		unsigned int getGranularity();
+		// Force the mixer to use a given instruction set, e.g. to test each path. Levels the CPU can't run are rejected.
+		result setSimdLevel(unsigned int aLevel);
 
 		// Set speaker position in 3d space
 		result setSpeakerPosition(unsigned int aChannel, float aX, float aY, float aZ);
@@ -239,6 +331,18 @@ namespace SoLoud
 		handle play3dClocked(time aSoundTime, AudioSource &aSound, float aPosX, float aPosY, float aPosZ, float aVelX = 0.0f, float aVelY = 0.0f, float aVelZ = 0.0f, float aVolume = 1.0f, unsigned int aBus = 0);
 		// Start playing a sound without any panning. It will be played at full volume.
 		handle playBackground(AudioSource &aSound, float aVolume = -1.0f, bool aPaused = 0, unsigned int aBus = 0);
+		// Schedule a sound to start at an exact sample in the future (see getScheduleTime). Does not use a voice until it starts. Returns event id, or 0 on failure.
+		unsigned int playScheduled(time aStartTime, AudioSource &aSound, float aVolume = -1.0f, float aPan = 0.0f, unsigned int aBus = 0);
+		// Schedule a 3d audio source to start at an exact sample in the future. Returns event id, or 0 on failure.
+		unsigned int play3dScheduled(time aStartTime, AudioSource &aSound, float aPosX, float aPosY, float aPosZ, float aVelX = 0.0f, float aVelY = 0.0f, float aVelZ = 0.0f, float aVolume = 1.0f, unsigned int aBus = 0);
+		// Cancel a scheduled play that hasn't started yet.
+		result cancelScheduled(unsigned int aEventId);
+		// Cancel all scheduled plays.
+		void cancelAllScheduled();
+		// Get the number of scheduled plays that haven't started yet.
+		unsigned int getScheduledCount();
+		// Get the scheduler clock, in seconds. This is the time at the start of the next mixed buffer.
+		time getScheduleTime();
 
 		// Seek the audio stream to certain point in time. Some streams can't seek backwards. Relative play speed affects time.
 		result seek(handle aVoiceHandle, time aSeconds);
@@ -250,6 +354,8 @@ namespace SoLoud
 		void stopAudioSource(AudioSource &aSound);
 		// Count voices that play this audio source
 		int countAudioSource(AudioSource &aSound);
+		// Destroy the instances of voices that have stopped. Called by the API calls that stop voices; only needed if voices end while no such calls are made.
+		void destroyRetiredVoices();
 
 		// Set a live filter parameter. Use 0 for the global filters.
 		void setFilterParameter(handle aVoiceHandle, unsigned int aFilterId, unsigned int aAttributeId, float aValue);
@@ -290,6 +396,10 @@ namespace SoLoud
 		float getGlobalVolume() const;
 		// Get current maximum active voice setting
 		unsigned int getMaxActiveVoiceCount() const;
+		// Get the number of voice slots
+		unsigned int getVoiceCapacity() const;
+		// Get the volume below which voices are inaudible
+		float getAudibilityThreshold() const;
 		// Query whether a voice is set to loop.
 		bool getLooping(handle aVoiceHandle);
 		// Get voice loop point value
@@ -301,8 +411,13 @@ namespace SoLoud
 		void setLooping(handle aVoiceHandle, bool aLooping);
 		// Set current maximum active voice setting
 		result setMaxActiveVoiceCount(unsigned int aVoiceCount);
+		// Set the number of voice slots, up to VOICE_COUNT_MAX. Voices in slots past the new capacity are stopped.
+		// Don't call while another thread may be using the 3d functions.
+		result setVoiceCapacity(unsigned int aVoiceCount);
 		// Set behavior for inaudible sounds
 		void setInaudibleBehavior(handle aVoiceHandle, bool aMustTick, bool aKill);
+		// Set the volume below which 3d voices are inaudible (default 0.001). Voices become audible again at twice this volume.
+		void setAudibilityThreshold(float aThreshold);
 		// Set the global volume
 		void setGlobalVolume(float aVolume);
 		// Set the post clip scaler value
@@ -354,6 +469,38 @@ namespace SoLoud
 		// Enable or disable visualization data gathering
 		void setVisualizationEnable(bool aEnable);
 
+		// Enable or disable the load governor, which lowers mixing quality step by step while mixing takes too long
+		void setGovernorEnable(bool aEnable);
+		// Set the share of each block's duration mixing may take before the governor steps in (default 0.7)
+		result setGovernorBudget(float aBudget);
+		// Get the smoothed mixing time as a share of the block duration
+		float getGovernorLoad() const;
+		// Get the current governor level; see Soloud::GOVERNOR_LEVELS
+		unsigned int getGovernorLevel() const;
+		// Get the active voice limit in effect, which the governor may have cut below the maximum active voice count
+		unsigned int getGovernorVoiceLimit() const;
+		// Get the number of voices mixed at lowered quality in the last block
+		unsigned int getGovernorDegradedVoiceCount() const;
+
+		// Mix aBlocks blocks of aBlockSize samples ahead on a separate thread, so that a slow block doesn't reach the device.
+		// Adds up to aBlocks * aBlockSize samples of latency. 0 blocks (default) mixes in the back-end. Takes effect at the next init.
+		result setMixAhead(unsigned int aBlocks, unsigned int aBlockSize = 0);
+		// Get the number of blocks mixed ahead
+		unsigned int getMixAhead() const;
+		// Get the number of times the back-end asked for more samples than were mixed ahead
+		unsigned int getMixAheadUnderrunCount() const;
+
+		// Run the mixing threads SoLoud creates with aPolicy (see THREAD_SCHEDULING) at aPriority (0 = mid-range), pinned
+		// to the cores set in aCoreMask (0 = any). Real-time policies also give the audio mutex priority inheritance. Takes effect at the next init.
+		// Decoding threads (AsyncLoader, Wav slice and progressive decoding) are not affected.
+		result setAudioThreadScheduling(unsigned int aPolicy, int aPriority = 0, unsigned long long aCoreMask = 0);
+		// Get the scheduling policy a mixing thread actually got; SCHEDULE_NORMAL if the system refused (see THREAD_SCHEDULING)
+		unsigned int getAudioThreadScheduling() const;
+		// Get the cores a mixing thread is actually pinned to; 0 if not pinned
+		unsigned long long getAudioThreadAffinity() const;
+		// Get whether the audio mutex actually uses priority inheritance
+		bool getAudioMutexPriorityInheritance() const;
+
 		// Calculate and get 256 floats of FFT data for visualization. Visualization has to be enabled before use.
 		float *calcFFT();
 
@@ -380,7 +527,7 @@ namespace SoLoud
 		// Is this voice group empty?
 		bool isVoiceGroupEmpty(handle aVoiceGroupHandle);
 
-		// Perform 3d audio parameter update
+		// Perform 3d audio parameter update. Not reentrant; don't call from two threads at once, or during setVoiceCapacity.
 		void update3dAudio();
 
 		// Set the speed of sound constant for doppler
@@ -420,6 +567,16 @@ namespace SoLoud
 	public:
 		// Mix N samples * M channels. Called by other mix_ functions.
 		void mix_internal(unsigned int aSamples);
+		// Apply the audio thread scheduling settings to the calling thread. Called by the mixing threads as they start.
+		void applyAudioThreadScheduling_internal();
+		// Start the mix-ahead thread
+		result startMixAhead_internal();
+		// Stop the mix-ahead thread
+		void stopMixAhead_internal();
+		// Mix-ahead thread loop; mixes blocks into the ring until stopped
+		void mixAhead_internal();
+		// Read samples mixed ahead into the back-end's buffer, in aFormat (see SAMPLE_FORMATS). Fills with silence on underrun.
+		void readMixAhead_internal(void *aBuffer, unsigned int aSamples, unsigned int aFormat);
 
 		// Handle rest of initialization (called from backend)
 		void postinit_internal(unsigned int aSamplerate, unsigned int aBufferSize, unsigned int aFlags, unsigned int aChannels);
@@ -428,8 +585,15 @@ namespace SoLoud
 		void calcActiveVoices_internal();
 		// Map resample buffers to active voices
 		void mapResampleBuffers_internal();
-		// Perform mixing for a specific bus
-		void mixBus_internal(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aBus, float aSamplerate, unsigned int aChannels);
+		// Group the active voices by the bus they play on
+		void groupActiveVoices_internal();
+		// Update the governor level from the time the last mix took
+		void updateGovernor_internal(unsigned int aSamples, unsigned long long aMicros);
+		// Seek a virtual voice to its stream position before it is mixed again. aLead is how far the
+		// stream position runs ahead of the block being mixed.
+		void resyncVoice_internal(unsigned int aVoice, time aLead);
+		// Perform mixing for a specific bus. Busses that render their voices specially pass a panner.
+		void mixBus_internal(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aBus, float aSamplerate, unsigned int aChannels, AudioPanner *aPanner = 0);
 		// Find a free voice, stopping the oldest if no free voice is found.
 		int findFreeVoice_internal();
 		// Converts handle to voice, if the handle is valid. Returns -1 if not.
@@ -438,6 +602,8 @@ namespace SoLoud
 		handle getHandleFromVoice_internal(unsigned int aVoice) const;
 		// Stop voice (not handle).
 		void stopVoice_internal(unsigned int aVoice);
+		// Push a stopped instance to the retire list; safe from the audio thread.
+		void retireInstance_internal(AudioSourceInstance *aInstance);
 		// Set voice (not handle) pan.
 		void setVoicePan_internal(unsigned int aVoice, float aPan);
 		// Set voice (not handle) relative play speed.
@@ -448,16 +614,38 @@ namespace SoLoud
 		void setVoicePause_internal(unsigned int aVoice, int aPause);
 		// Update overall volume from set and 3d volumes
 		void updateVoiceVolume_internal(unsigned int aVoice);
+		// Update the inaudible flag from the overall volume
+		void updateVoiceAudibility_internal(unsigned int aVoice);
 		// Update overall relative play speed from set and 3d speeds
 		void updateVoiceRelativePlaySpeed_internal(unsigned int aVoice);
+		// Bring voice (not handle) stream time and position up to mStreamTime
+		void syncVoiceTime_internal(unsigned int aVoice);
+		// Have the mixer run voice (not handle) faders and schedulers until they're done
+		void listFaderVoice_internal(unsigned int aVoice);
 		// Perform 3d audio calculation for array of voices
 		void update3dVoices_internal(unsigned int *aVoiceList, unsigned int aVoiceCount);
+		// Get the listener's axes (left, up, forward) in world space as the rows of a 3x3 matrix
+		void get3dListenerMatrix_internal(float *aMatrix);
+		// Get world space unit vectors of the speakers for the current listener orientation; zero for null speakers
+		void get3dSpeakerDirections_internal(float *aDirection);
 		// Clip the samples in the buffer
 		void clip_internal(AlignedFloatBuffer &aBuffer, AlignedFloatBuffer &aDestBuffer, unsigned int aSamples, float aVolume0, float aVolume1);
 		// Remove all non-active voices from group
 		void trimVoiceGroup_internal(handle aVoiceGroupHandle);
 		// Get pointer to the zero-terminated array of voice handles in a voice group
 		handle * voiceGroupHandleToArray_internal(handle aVoiceGroupHandle) const;
+		// Create an instance of aSound along with its filter instances. Call outside the audio thread mutex.
+		AudioSourceInstance *createInstance_internal(AudioSource &aSound);
+		// Start a pre-created instance in a free voice. Returns the voice, or -1 if none is available.
+		int startVoice_internal(AudioSource &aSound, AudioSourceInstance *aInstance, float aVolume, float aPan, bool aPaused, unsigned int aBus);
+		// Calculate 3d volumes for a freshly started voice and apply them without ramping.
+		void init3dVoice_internal(unsigned int aVoice);
+		// Start scheduled plays that fall within the next aSamples samples.
+		void processScheduledEvents_internal(unsigned int aSamples);
+		// Schedule an event; fills in the id. Returns the id, or 0 on failure.
+		unsigned int pushScheduledEvent_internal(ScheduledEvent &aEvent, time aStartTime, AudioSource &aSound);
+		// Cancel scheduled plays of a sound source. Zero cancels all.
+		void cancelScheduledSource_internal(unsigned int aAudioSourceID);
 
 		// Lock audio thread mutex.
 		void lockAudioMutex_internal();
@@ -466,6 +654,58 @@ namespace SoLoud
 
 		// Max. number of active voices. Busses and tickable inaudibles also count against this.
 		unsigned int mMaxActiveVoices;
+		// Voices quieter than this are inaudible
+		float mAudibilityThreshold;
+		// Share of the block duration mixing may take
+		float mGovernorBudget;
+		// Smoothed mixing time as a share of the block duration
+		float mGovernorLoad;
+		// Current governor level; see Soloud::GOVERNOR_LEVELS
+		unsigned int mGovernorLevel;
+		// Blocks to wait before raising the level again, so the last change can take effect
+		unsigned int mGovernorCooldown;
+		// Blocks in a row with plenty of headroom
+		unsigned int mGovernorCalm;
+		// Voices mixed at lowered quality in the last block
+		unsigned int mGovernorDegradedVoices;
+
+		// Requested audio thread scheduling policy, priority and cores; see setAudioThreadScheduling
+		unsigned int mAudioThreadPolicy;
+		int mAudioThreadPriority;
+		unsigned long long mAudioThreadCoreMask;
+		// Scheduling policy and cores the last mixing thread actually got
+		unsigned int mAppliedAudioThreadPolicy;
+		unsigned long long mAppliedAudioThreadCoreMask;
+		// The audio mutex uses priority inheritance
+		bool mAudioMutexInherits;
+
+		// Blocks mixed ahead; 0 mixes in the back-end
+		unsigned int mMixAheadBlocks;
+		// Samples per mix-ahead block; 0 uses the granularity
+		unsigned int mMixAheadBlockSize;
+		// Samples per block in the mix-ahead ring
+		unsigned int mMixAheadRingBlockSize;
+		// Mix-ahead ring; each block holds mMixAheadRingBlockSize samples per channel, one channel after another
+		AlignedFloatBuffer mMixAheadRing;
+		// Blocks written by the mix-ahead thread and read by the back-end so far; the difference is the fill level
+		volatile unsigned int mMixAheadWritten;
+		volatile unsigned int mMixAheadRead;
+		// Ring block the mix-ahead thread writes next
+		unsigned int mMixAheadWriteBlock;
+		// Ring block and sample within it the back-end reads next
+		unsigned int mMixAheadReadBlock;
+		unsigned int mMixAheadReadOffset;
+		// Number of back-end reads that ran out of mixed samples
+		unsigned int mMixAheadUnderruns;
+		// Mix-ahead thread, or NULL
+		Thread::ThreadHandleData *mMixAheadThread;
+		// Cleared to stop the mix-ahead thread
+		volatile int mMixAheadRunning;
+		// Mutex and condition the mix-ahead thread waits on while the ring is full
+		void *mMixAheadMutex;
+		void *mMixAheadCondition;
+		// Stopped instances waiting for destroyRetiredVoices, linked through AudioSourceInstance::mRetireNext
+		void * volatile mRetired;
 		// Highest voice in use so far
 		unsigned int mHighestVoice;
 		// Scratch buffer, used for resampling.
@@ -480,8 +720,12 @@ namespace SoLoud
 		AlignedFloatBuffer *mResampleData;
 		// Owners of the resample data
 		AudioSourceInstance **mResampleDataOwner;
+		// Resample data still in use by an active voice; temporary for mapResampleBuffers_internal
+		unsigned char *mResampleDataLive;
+		// Number of voice slots in mVoice, m3dData and mActiveVoice
+		unsigned int mVoiceCapacity;
 		// Audio voices.
-		AudioSourceInstance *mVoice[VOICE_COUNT];
+		AudioSourceInstance **mVoice;
 		// Output sample rate (not float)
 		unsigned int mSamplerate;
 		// Output channel count
@@ -498,6 +742,14 @@ namespace SoLoud
 		float mGlobalVolume;
 		// Post-clip scaler. Applied after clipping.
 		float mPostClipScaler;
+		// Instruction set in use; see Soloud::SIMD_LEVELS
+		unsigned int mSimdLevel;
+		// Mixer kernels for mSimdLevel
+		const SimdKernels *mSimd;
+		// Random state for output dither
+		unsigned int mDitherSeed;
+		// Samples read from each voice (and run through its filters) at a time
+		unsigned int mGranularity;
 		// Current play index. Used to create audio handles.
 		unsigned int mPlayIndex;
 		// Current sound source index. Used to create sound source IDs.
@@ -537,18 +789,44 @@ namespace SoLoud
 		float m3dSpeakerPosition[3 * MAX_CHANNELS];
 
 		// Data related to 3d processing, separate from AudioSource so we can do 3d calculations without audio mutex.
-		AudioSourceInstance3dData m3dData[VOICE_COUNT];
+		AudioSourceInstance3dData *m3dData;
+		// Voices that need 3d processing; temporary for update3dAudio, which is why it isn't reentrant
+		unsigned int *m3dVoiceList;
 
 		// For each voice group, first int is number of ints alocated.
 		unsigned int **mVoiceGroup;
 		unsigned int mVoiceGroupCount;
 
 		// List of currently active voices
-		unsigned int mActiveVoice[VOICE_COUNT];
+		unsigned int *mActiveVoice;
 		// Number of currently active voices
 		unsigned int mActiveVoiceCount;
 		// Active voices list needs to be recalculated
 		bool mActiveVoiceDirty;
+		// Active voices of bus key k are mActiveVoice[mBusVoiceStart[k]] up to mActiveVoice[mBusVoiceStart[k + 1]].
+		// Key 0 is the main mix, key n the bus playing in voice slot n - 1.
+		unsigned int *mBusVoiceStart;
+		// Number of bus keys in mBusVoiceStart
+		unsigned int mBusVoiceKeys;
+		// Active voices list being grouped; temporary for groupActiveVoices_internal
+		unsigned int *mActiveVoiceSort;
+		// mStreamTime each voice's stream time and position were last brought up to, by voice slot.
+		// Unpaused voices run on from there untouched, and are caught up when they're looked at.
+		time *mVoiceSyncTime;
+		// Voices with faders or schedulers running, or virtual voices that may play out; the only ones
+		// the mixer updates every mix
+		unsigned int *mFaderVoice;
+		// Number of voices in mFaderVoice
+		unsigned int mFaderVoiceCount;
+		// Whether each voice slot is in mFaderVoice
+		unsigned char *mFaderVoiceListed;
+
+		// Pending scheduled plays
+		Scheduler mScheduler;
+		// Scheduler clock; samples mixed so far.
+		unsigned long long mScheduleSample;
+		// Next scheduled event id
+		unsigned int mScheduleId;
 	};
 };
 
@@ -0,0 +1,68 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+
+#ifndef SOLOUD_AMBISONICBUS_H
+#define SOLOUD_AMBISONICBUS_H
+
+#include "soloud.h"
+#include "soloud_bus.h"
+
+namespace SoLoud
+{
+	class AmbisonicBus;
+
+	class AmbisonicBusInstance : public BusInstance, public AudioPanner
+	{
+	protected:
+		// Ambisonic order, fixed when the bus starts playing
+		unsigned int mOrder;
+		// B-format mix of the voices on this bus
+		AlignedFloatBuffer mBFormat;
+		// Decode matrix used for the previous block, [output channel][B-format channel]
+		float mDecoder[MAX_CHANNELS * AMBISONIC_MAX_CHANNELS];
+		// Calculate the decode matrix for the current speaker layout and listener orientation
+		void calcDecoder_internal(float *aDecoder);
+	public:
+		AmbisonicBusInstance(AmbisonicBus *aParent);
+		virtual unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize);
+		// Encode a voice into the bus' B-format mix
+		virtual void pan(Soloud *aSoloud, AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels);
+	};
+
+	class AmbisonicBus : public Bus
+	{
+	public:
+		AmbisonicBus();
+		virtual BusInstance *createInstance();
+		// Set ambisonic order, 1 to AMBISONIC_MAX_ORDER (default 1). Takes effect the next time the bus is played.
+		result setOrder(unsigned int aOrder);
+		// Get ambisonic order
+		unsigned int getOrder();
+	public:
+		unsigned int mOrder;
+	};
+};
+
+#endif
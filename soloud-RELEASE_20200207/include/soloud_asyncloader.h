@@ -0,0 +1,107 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#ifndef SOLOUD_ASYNCLOADER_H
+#define SOLOUD_ASYNCLOADER_H
+
+#include "soloud.h"
+#include "soloud_thread.h"
+
+namespace SoLoud
+{
+	class Wav;
+	class WavStream;
+	class AsyncLoader;
+
+	// Called from a worker thread when a load finishes.
+	typedef void (*asyncLoadCallback)(unsigned int aTicket, AudioSource *aSource, result aResult, void *aUserData);
+
+	class AsyncLoadJob : public Thread::PoolTask
+	{
+	public:
+		enum TYPE
+		{
+			WAV = 0,
+			WAVSTREAM
+		};
+		AsyncLoader *mParent;
+		AudioSource *mSource;
+		int mType;
+		char *mFilename;
+		asyncLoadCallback mCallback;
+		void *mUserData;
+		unsigned int mTicket;
+		result mResult;
+		bool mDone;
+
+		AsyncLoadJob();
+		virtual ~AsyncLoadJob();
+		virtual void work();
+	};
+
+	class AsyncLoader
+	{
+	public:
+		// Ctor
+		AsyncLoader();
+		// Dtor. Waits for all pending loads to finish.
+		~AsyncLoader();
+		// Start the worker threads. Thread count 0 means one per core.
+		result init(unsigned int aThreadCount = 0);
+		// Queue a Wav::load. Returns ticket, or 0 on failure. The Wav must not be touched until the load is done.
+		unsigned int loadWav(Wav &aWav, const char *aFilename, asyncLoadCallback aCallback = 0, void *aUserData = 0);
+		// Queue a WavStream::load. Returns ticket, or 0 on failure.
+		unsigned int loadWavStream(WavStream &aWavStream, const char *aFilename, asyncLoadCallback aCallback = 0, void *aUserData = 0);
+		// Has the load finished? Unknown tickets count as finished.
+		bool isDone(unsigned int aTicket);
+		// Get load result. Returns UNKNOWN_ERROR if the load hasn't finished yet, INVALID_PARAMETER for unknown tickets.
+		result getResult(unsigned int aTicket);
+		// Block until the load finishes, and return its result.
+		result wait(unsigned int aTicket);
+		// Block until all queued loads have finished.
+		void waitAll();
+		// Number of queued loads that haven't finished yet.
+		unsigned int getPendingCount();
+		// Wait for all loads and forget them. Invalidates all tickets.
+		void reset();
+
+		// Internal: mark job as done and wake up waiters.
+		void jobDone_internal(AsyncLoadJob *aJob);
+	public:
+		Thread::Pool mPool;
+		// Protects job list and pending count
+		void *mMutex;
+		// Signaled when a job finishes
+		void *mDoneCondition;
+		// Jobs, indexed by ticket - 1. Kept for the lifetime of the loader so tickets stay valid.
+		AsyncLoadJob **mJob;
+		unsigned int mJobCount;
+		unsigned int mJobCapacity;
+		unsigned int mPending;
+	private:
+		unsigned int queue_internal(AudioSource &aSource, int aType, const char *aFilename, asyncLoadCallback aCallback, void *aUserData);
+	};
+};
+
+#endif
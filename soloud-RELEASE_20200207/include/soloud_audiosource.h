@@ -48,6 +48,13 @@ namespace SoLoud
 		virtual float attenuate(float aDistance, float aMinDistance, float aMaxDistance, float aRolloffFactor) = 0;
 	};
 
+	class AudioPanner
+	{
+	public:
+		// Mix a voice's samples from aScratch into the aChannels channels of aBuffer.
+		virtual void pan(Soloud *aSoloud, AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels) = 0;
+	};
+
 	class AudioSourceInstance3dData
 	{
 	public:
@@ -92,6 +99,8 @@ namespace SoLoud
 		float m3dVolume;
 		// Channel volume
 		float mChannelVolume[MAX_CHANNELS];
+		// Direction to the sound in world space
+		float m3dDirection[3];
 		// Copy of flags
 		unsigned int mFlags;
 		// Latest handle for this voice
@@ -119,7 +128,11 @@ namespace SoLoud
 			// If inaudible, should be killed (default = don't kill kill)
 			INAUDIBLE_KILL = 64,
 			// If inaudible, should still be ticked (default = pause)
-			INAUDIBLE_TICK = 128
+			INAUDIBLE_TICK = 128,
+			// Inaudible and ticking, but not decoded; seeks to its stream position when audible again
+			VIRTUAL = 256,
+			// This instance is a bus; stopping it stops the voices playing on it
+			BUS = 512
 		};
 		// Ctor
 		AudioSourceInstance();
@@ -167,6 +180,10 @@ namespace SoLoud
 		int mActiveFader;
 		// Current channel volumes, used to ramp the volume changes to avoid clicks
 		float mCurrentChannelVolume[MAX_CHANNELS];
+		// Direction to the sound in world space, from 3d processing. Zero for non-3d sounds.
+		float m3dDirection[3];
+		// Current B-format gains when playing on an ambisonic bus, used to ramp the changes
+		float mCurrentAmbisonicGain[AMBISONIC_MAX_CHANNELS];
 		// ID of the sound source that generated this instance
 		unsigned int mAudioSourceID;
 		// Handle of the bus this audio instance is playing on. 0 for root.
@@ -181,10 +198,18 @@ namespace SoLoud
 		unsigned int mSrcOffset;
 		// Samples left over from earlier pass
 		unsigned int mLeftoverSamples;
+		// Current block, when the mixer reads it in place through getDirectData; NULL when it's in mResampleData[0]
+		const float *mDirectData;
+		// Distance between the channels of mDirectData
+		unsigned int mDirectPitch;
 		// Number of samples to delay streaming
 		unsigned int mDelaySamples;
 		// When looping, start playing from this time
 		time mLoopPoint;
+		// Volume below which this instance is inaudible; negative uses the engine's threshold
+		float mAudibilityThreshold;
+		// Next instance in the retire list, once stopped; see Soloud::destroyRetiredVoices
+		AudioSourceInstance *mRetireNext;
 
 		// Get N samples from the stream to the buffer. Report samples written.
 		virtual unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize) = 0;
@@ -194,8 +219,16 @@ namespace SoLoud
 		virtual result seek(time aSeconds, float *mScratch, unsigned int mScratchSize);
 		// Rewind stream. Base implementation returns NOT_IMPLEMENTED, meaning it can't rewind.
 		virtual result rewind();
+		// Get stream length in seconds. Ticking voices of streams that know their length and seek
+		// quickly only advance their position while inaudible. Base implementation returns 0, meaning unknown.
+		virtual time getLength();
 		// Get information. Returns 0 by default.
 		virtual float getInfo(unsigned int aInfoKey);
+		// For sources with their samples in memory: planar sample data the mixer may read in place of calling getAudio,
+		// with the samples per channel and the position getAudio would read next. Base implementation returns NULL, meaning none.
+		virtual const float *getDirectData(unsigned int *aSampleCount, unsigned int *aPosition);
+		// Move past samples the mixer read through getDirectData, as getAudio would have.
+		virtual void skipDirectData(unsigned int aSamples);
 	};
 
 	class Soloud;
@@ -267,6 +300,8 @@ namespace SoLoud
 		int mColliderData;
 		// When looping, start playing from this time
 		time mLoopPoint;
+		// Volume below which instances are inaudible; negative uses the engine's threshold
+		float mAudibilityThreshold;
 
 		// CTor
 		AudioSource();
@@ -295,6 +330,8 @@ namespace SoLoud
 
 		// Set behavior for inaudible sounds
 		void setInaudibleBehavior(bool aMustTick, bool aKill);
+		// Set the volume below which instances are inaudible. Negative (default) uses the engine's threshold for 3d instances, and none for 2d ones.
+		void setAudibilityThreshold(float aThreshold);
 
 		// Set time to jump to when looping
 		void setLoopPoint(time aLoopPoint);
@@ -33,9 +33,12 @@ namespace SoLoud
 
 	class BusInstance : public AudioSourceInstance
 	{
+	protected:
 		Bus *mParent;
 		unsigned int mScratchSize;
 		AlignedFloatBuffer mScratch;
+		// Gather visualization data from the mixed output, if enabled
+		void updateVisualization_internal(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize);
 	public:
 		// Approximate volume for channels.
 		float mVisualizationChannelVolume[MAX_CHANNELS];
@@ -63,6 +66,8 @@ namespace SoLoud
 		handle play3d(AudioSource &aSound, float aPosX, float aPosY, float aPosZ, float aVelX = 0.0f, float aVelY = 0.0f, float aVelZ = 0.0f, float aVolume = 1.0f, bool aPaused = 0);
 		// Start playing a 3d audio source through the bus, delayed in relation to other sounds called via this function.
 		handle play3dClocked(time aSoundTime, AudioSource &aSound, float aPosX, float aPosY, float aPosZ, float aVelX = 0.0f, float aVelY = 0.0f, float aVelZ = 0.0f, float aVolume = 1.0f);
+		// Schedule a sound to start through the bus at an exact sample in the future. Returns event id, or 0 on failure.
+		unsigned int playScheduled(time aStartTime, AudioSource &aSound, float aVolume = 1.0f, float aPan = 0.0f);
 		// Set number of channels for the bus (default 2)
 		result setChannels(unsigned int aChannels);
 		// Enable or disable visualization data gathering
@@ -0,0 +1,60 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#ifndef SOLOUD_CONVERT_H
+#define SOLOUD_CONVERT_H
+
+#include "soloud.h"
+
+namespace SoLoud
+{
+	enum SAMPLE_FORMATS
+	{
+		// 32-bit float, -1..1
+		SAMPLE_FLOAT32 = 0,
+		// 16-bit signed integer
+		SAMPLE_S16,
+		// 24-bit signed integer, packed in 3 bytes, little endian
+		SAMPLE_S24,
+		// 32-bit signed integer
+		SAMPLE_S32,
+		SAMPLE_FORMAT_MAX
+	};
+
+	// Bytes per sample of a SAMPLE_FORMATS format
+	unsigned int sample_format_size(unsigned int aFormat);
+
+	// Convert aCount samples between formats. Float to integer rounds to nearest and saturates.
+	// Pass a seed in aDitherSeed to add TPDF dither to integer output; NULL for no dither.
+	void convert_samples(const void *aSrc, unsigned int aSrcFormat, void *aDst, unsigned int aDstFormat, unsigned int aCount, unsigned int *aDitherSeed = 0, unsigned int aMaxSimdLevel = Soloud::SIMD_LEVEL_MAX);
+
+	// Interlace planar float samples (channel n starts at aSrc + n * aSrcPitch) and convert to aFormat. From 11112222 to 12121212
+	void interlace_samples(const float *aSrc, unsigned int aSrcPitch, void *aDst, unsigned int aFormat, unsigned int aSamples, unsigned int aChannels, unsigned int *aDitherSeed = 0, unsigned int aMaxSimdLevel = Soloud::SIMD_LEVEL_MAX);
+
+	// Convert interlaced aFormat samples with aSrcChannels channels to planar float, keeping the first aChannels channels
+	// (channel n goes to aDst + n * aDstPitch). From 12121212 to 11112222
+	void deinterlace_samples(const void *aSrc, unsigned int aFormat, unsigned int aSrcChannels, float *aDst, unsigned int aDstPitch, unsigned int aSamples, unsigned int aChannels, unsigned int aMaxSimdLevel = Soloud::SIMD_LEVEL_MAX);
+};
+
+#endif
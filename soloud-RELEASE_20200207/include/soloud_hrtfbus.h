@@ -0,0 +1,178 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+
+#ifndef SOLOUD_HRTFBUS_H
+#define SOLOUD_HRTFBUS_H
+
+#include "soloud.h"
+#include "soloud_bus.h"
+
+// Longest supported head-related impulse response, in samples
+#define SOLOUD_HRTF_MAX_LENGTH 512
+
+// Most voices an HRTF bus can convolve individually
+#define SOLOUD_HRTF_MAX_VOICES 16
+
+namespace SoLoud
+{
+	class HrtfBus;
+
+	// Head-related impulse responses for a set of directions around the listener
+	class Hrtf
+	{
+	public:
+		Hrtf();
+		~Hrtf();
+		// Load from a stereo wave file holding aDirectionCount responses one after another. aDirections has x, y, z for each, in listener space.
+		result load(const char *aFilename, const float *aDirections, unsigned int aDirectionCount);
+		// Load from memory. For each direction, aLength left ear samples are followed by aLength right ear samples.
+		result loadRaw(const float *aData, unsigned int aLength, const float *aDirections, unsigned int aDirectionCount);
+		// Get the length of the responses, in samples
+		unsigned int getLength();
+		// Get the number of directions
+		unsigned int getDirectionCount();
+	public:
+		// Responses; left then right ear for each direction
+		float *mData;
+		// Unit vector for each direction, in listener space
+		float *mDirection;
+		unsigned int mLength;
+		unsigned int mDirectionCount;
+	};
+
+	class HrtfBusInstance : public BusInstance, public AudioPanner
+	{
+	protected:
+		// A voice that gets convolved with its own head-related impulse response
+		struct VoiceSlot
+		{
+			// Voice and its play index, or NULL if the slot is free. Only compared against the voices
+			// being panned; the voice may be stopped and gone by the time the slot is rendered.
+			AudioSourceInstance *mVoice;
+			unsigned int mPlayIndex;
+			// Voice is being faded back to the shared sound field
+			bool mRelease;
+			// Voice was mixed during the current block
+			bool mSeen;
+			// Voice ends with the current block; the slot is freed once it's rendered
+			bool mEnding;
+			// Voice volume and world space direction, as of the current block
+			float mVolume;
+			float mSource[3];
+			// Filter has been set up for this voice
+			bool mValid;
+			// Current voice gain, used to ramp the changes
+			float mGain;
+			// Listener space direction the filter was made for
+			float mDirection[3];
+			// Mono input for the current block
+			float *mInput;
+			// Filter spectrum, mFFTSize complex values
+			float *mFilter;
+			// Convolution output still to be played
+			float *mTail;
+			unsigned int mTailLength;
+		};
+
+		// FFT size, in complex values
+		unsigned int mFFTSize;
+		// Longest block the convolution can take
+		unsigned int mBlockSize;
+		// Response length, in samples
+		unsigned int mLength;
+		// Number of directions in the HRTF
+		unsigned int mDirectionCount;
+		// Number of voice slots
+		unsigned int mMaxVoices;
+		// Unit vectors of the HRTF directions
+		AlignedFloatBuffer mDirection;
+		// Spectrum of each direction's response pair
+		AlignedFloatBuffer mSpectrum;
+		// Filters that turn first order B-format in listener space into the two ears
+		AlignedFloatBuffer mFieldFilter;
+		// World space B-format mix of the voices without a slot
+		AlignedFloatBuffer mField;
+		// The same, rotated into listener space
+		AlignedFloatBuffer mLocalField;
+		// Convolution output of the sound field still to be played
+		AlignedFloatBuffer mFieldTail;
+		unsigned int mFieldTailLength;
+		// Something was encoded into the sound field during the current block
+		bool mFieldActive;
+		// Sound field rotation used for the previous block
+		float mRotation[9];
+		// Listener matrix for the current block
+		float mListener[9];
+		// Per-slot buffers
+		AlignedFloatBuffer mSlotData;
+		VoiceSlot mSlot[SOLOUD_HRTF_MAX_VOICES];
+		// FFT work buffers
+		AlignedFloatBuffer mWork;
+		// A 3d voice mixed into the sound field that could use a slot
+		struct Candidate
+		{
+			// Only compared, as with VoiceSlot::mVoice
+			AudioSourceInstance *mVoice;
+			unsigned int mPlayIndex;
+			float mVolume;
+			float mSource[3];
+		};
+		// Loudest 3d voices mixed into the sound field this block and still playing, loudest first
+		Candidate mCandidate[SOLOUD_HRTF_MAX_VOICES];
+		unsigned int mCandidateCount;
+
+		// Interpolate the filter spectrum for a listener space direction
+		void interpolate_internal(float *aSpectrum, const float *aDirection);
+		// Convolve the sound field and add it to the output
+		void renderField_internal(float *aBuffer, unsigned int aSamples, unsigned int aBufferSize);
+		// Convolve a slot's voice and add it to the output
+		void renderSlot_internal(VoiceSlot &aSlot, float *aBuffer, unsigned int aSamples, unsigned int aBufferSize);
+		// Give free slots to the loudest sound field voices, and release quiet slot voices for louder ones
+		void assignSlots_internal();
+	public:
+		HrtfBusInstance(HrtfBus *aParent);
+		virtual unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize);
+		// Route a voice to its slot or the shared sound field
+		virtual void pan(Soloud *aSoloud, AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels);
+	};
+
+	class HrtfBus : public Bus
+	{
+	public:
+		HrtfBus();
+		virtual BusInstance *createInstance();
+		// Set the HRTF to render with. Takes effect the next time the bus is played.
+		void setHrtf(Hrtf *aHrtf);
+		// Set the number of voices convolved individually, up to SOLOUD_HRTF_MAX_VOICES (default 8). Takes effect the next time the bus is played.
+		result setMaxVoices(unsigned int aVoices);
+		// Get the number of voices convolved individually
+		unsigned int getMaxVoices();
+	public:
+		Hrtf *mHrtf;
+		unsigned int mMaxVoices;
+	};
+};
+
+#endif
@@ -91,6 +91,12 @@ namespace SoLoud
 
 	// Convert to 16-bit and interlace samples in a buffer. From 11112222 to 12121212
 	void interlace_samples_s16(const float *aSourceBuffer, short *aDestBuffer, unsigned int aSamples, unsigned int aChannels);
+	// Calculate ambisonic (ACN/SN3D) encoding gains for a world space unit vector. Null vector encodes to W only.
+	void calc_ambisonic_gains(float *aGain, const float *aDirection, unsigned int aChannels);
+	// Average the channels of deinterleaved samples into the first channel
+	void fold_to_mono(float *aBuffer, unsigned int aSamples, unsigned int aBufferSize, unsigned int aChannels);
+	// Mix mono samples into aChannels B-format channels in the voice's direction, ramping the voice's ambisonic gains towards aVolume
+	void encode_ambisonic(const SimdKernels *aSimd, AudioSourceInstance *aVoice, const float *aSource, float *aBuffer, unsigned int aSamples, unsigned int aBufferSize, unsigned int aChannels, float aVolume);
 };
 
 #define FOR_ALL_VOICES_PRE \
@@ -118,8 +124,8 @@ namespace SoLoud
 		if (h_ == NULL) h_ = th_; \
 				while (*h_) \
 						{ \
-			int ch = (*h_ & 0xfff) - 1; \
-			if (ch != -1 && m3dData[ch].mHandle == *h_)  \
+			int ch = (*h_ & VOICE_HANDLE_SLOT_MASK) - 1; \
+			if ((unsigned int)ch < mVoiceCapacity && m3dData[ch].mHandle == *h_)  \
 						{
 
 #define FOR_ALL_VOICES_POST_3D \
@@ -152,8 +158,8 @@ namespace SoLoud
 		if (h_ == NULL) h_ = th_; \
 				while (*h_) \
 						{ \
-			int ch = (*h_ & 0xfff) - 1; \
-			if (ch != -1 && mSoloud->m3dData[ch].mHandle == *h_)  \
+			int ch = (*h_ & VOICE_HANDLE_SLOT_MASK) - 1; \
+			if ((unsigned int)ch < mSoloud->mVoiceCapacity && mSoloud->m3dData[ch].mHandle == *h_)  \
 						{
 
 #define FOR_ALL_VOICES_POST_3D_EXT \
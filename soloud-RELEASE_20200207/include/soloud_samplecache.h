@@ -0,0 +1,113 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#ifndef SOLOUD_SAMPLECACHE_H
+#define SOLOUD_SAMPLECACHE_H
+
+#include "soloud.h"
+
+namespace SoLoud
+{
+	class Wav;
+	class SampleCache;
+
+	// Decoded sample data shared by all Wav objects loaded through the cache.
+	class SampleCacheEntry
+	{
+	public:
+		// Path for file entries, NULL for memory entries
+		char *mPath;
+		// Content hash for memory entries
+		unsigned long long mHash;
+		// Source data length for memory entries
+		unsigned int mSourceLength;
+		// Wav::mLoadSamplerate the data was loaded with; loads with another setting don't share it
+		float mLoadSamplerate;
+		// Decoded, deinterleaved samples
+		const float *mData;
+		unsigned int mSampleCount;
+		unsigned int mChannels;
+		float mBaseSamplerate;
+		// Number of Wav objects using this entry, plus one for the cache while it lists the entry.
+		// Changed with Thread::atomicAdd; whoever drops it to 0 frees the entry.
+		volatile unsigned int mRefCount;
+		// LRU list links; head is the most recently used
+		SampleCacheEntry *mPrev;
+		SampleCacheEntry *mNext;
+
+		SampleCacheEntry();
+		~SampleCacheEntry();
+		// Size of the decoded data, in bytes
+		unsigned int getSize() const;
+	};
+
+	class SampleCache
+	{
+	public:
+		// Ctor
+		SampleCache();
+		// Dtor. Entries still in use by Wav objects are freed when released.
+		~SampleCache();
+		// Set memory budget in bytes; unreferenced entries are evicted to stay below it. 0 means unlimited.
+		void setMemoryBudget(unsigned int aBytes);
+		// Get memory budget in bytes
+		unsigned int getMemoryBudget();
+		// Load a file into the Wav, sharing decoded data with other Wavs loaded from the same path.
+		result load(Wav &aWav, const char *aFilename);
+		// Load from memory into the Wav, sharing decoded data with other Wavs loaded from the same content.
+		result loadMem(Wav &aWav, const unsigned char *aMem, unsigned int aLength);
+		// Evict all entries not used by any Wav.
+		void purge();
+
+		// Number of loads served from the cache
+		unsigned int getHitCount();
+		// Number of loads that had to decode
+		unsigned int getMissCount();
+		// Number of entries evicted
+		unsigned int getEvictionCount();
+		// Bytes of decoded data currently held
+		unsigned int getMemoryUsage();
+		// Number of cached entries
+		unsigned int getEntryCount();
+
+	public:
+		void *mMutex;
+		SampleCacheEntry *mHead;
+		SampleCacheEntry *mTail;
+		unsigned int mEntryCount;
+		unsigned int mBudget;
+		unsigned int mMemoryUsage;
+		unsigned int mHits;
+		unsigned int mMisses;
+		unsigned int mEvictions;
+	private:
+		SampleCacheEntry *find_internal(const char *aPath, unsigned long long aHash, unsigned int aLength, float aLoadSamplerate);
+		void touch_internal(SampleCacheEntry *aEntry);
+		void unlink_internal(SampleCacheEntry *aEntry);
+		void trim_internal();
+		result attach_internal(Wav &aWav, SampleCacheEntry *aKey);
+	};
+};
+
+#endif
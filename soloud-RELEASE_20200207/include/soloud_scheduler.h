@@ -0,0 +1,96 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#ifndef SOLOUD_SCHEDULER_H
+#define SOLOUD_SCHEDULER_H
+
+#include "soloud.h"
+
+namespace SoLoud
+{
+	class AudioSource;
+	class AudioSourceInstance;
+
+	// Play event waiting for its start time. Does not occupy a voice until it fires.
+	class ScheduledEvent
+	{
+	public:
+		// Absolute start time, in output samples
+		unsigned long long mStartSample;
+		// Event id, returned to the caller for cancelling
+		unsigned int mId;
+		// Source the instance was created from
+		AudioSource *mSource;
+		// Instance (with filters) created at schedule time
+		AudioSourceInstance *mInstance;
+		// Volume; negative means source default
+		float mVolume;
+		// Pan
+		float mPan;
+		// Bus handle
+		unsigned int mBus;
+		// Is this a 3d play
+		bool m3d;
+		// 3d position
+		float m3dPosition[3];
+		// 3d velocity
+		float m3dVelocity[3];
+	};
+
+	// Binary min-heap of pending play events, ordered by start sample (ties by id).
+	class Scheduler
+	{
+	public:
+		// Event storage, heap ordered
+		ScheduledEvent *mEvent;
+		// Number of events in the heap
+		unsigned int mCount;
+		// Allocated event slots
+		unsigned int mCapacity;
+
+		// Ctor
+		Scheduler();
+		// Dtor. Pending instances are not freed; the owner must drain the heap first.
+		~Scheduler();
+		// Add event. Returns OUT_OF_MEMORY if the heap can't grow.
+		result push(const ScheduledEvent &aEvent);
+		// Earliest event, or NULL if the heap is empty.
+		ScheduledEvent *top();
+		// Remove the earliest event.
+		void pop();
+		// Remove event at heap index, copying it to aEvent.
+		void removeAt(unsigned int aIndex, ScheduledEvent &aEvent);
+		// Find heap index of event by id. Returns -1 if not found.
+		int find(unsigned int aId) const;
+		// Restore heap order after mEvent/mCount were edited directly.
+		void rebuild();
+	private:
+		bool less(unsigned int aA, unsigned int aB) const;
+		void swap(unsigned int aA, unsigned int aB);
+		void siftUp(unsigned int aIndex);
+		void siftDown(unsigned int aIndex);
+	};
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#ifndef SOLOUD_SIMD_H
+#define SOLOUD_SIMD_H
+
+#include "soloud.h"
+
+#ifdef SOLOUD_SSE_INTRINSICS
+#include <emmintrin.h>
+
+// The wider kernels are compiled with per-function target attributes, so the
+// rest of the library (and the binary) still runs on SSE2-only machines.
+#if !defined(DISABLE_AVX) && ((defined(_MSC_VER) && _MSC_VER >= 1900) || defined(__GNUC__))
+#define SOLOUD_AVX_INTRINSICS
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define SOLOUD_TARGET_SSE2 __attribute__((target("sse2")))
+#define SOLOUD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SOLOUD_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SOLOUD_TARGET_SSE2
+#define SOLOUD_TARGET_AVX2
+#define SOLOUD_TARGET_AVX512
+#endif
+#endif
+
+// Fixed point format of the resampler source position
+#define FIXPOINT_FRAC_BITS 20
+#define FIXPOINT_FRAC_MUL (1 << FIXPOINT_FRAC_BITS)
+#define FIXPOINT_FRAC_MASK ((1 << FIXPOINT_FRAC_BITS) - 1)
+
+namespace SoLoud
+{
+	// Mixer inner loops for one instruction set. All buffers are deinterleaved;
+	// none of the pointers need to be more than float aligned.
+	struct SimdKernels
+	{
+		// Hard clip aSamples samples to -1..1 with a linear volume ramp, then scale.
+		void (*clipHard)(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale);
+		// Same with the round-off clipper.
+		void (*clipRoundoff)(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale);
+		// Linear resample of one channel from a block of aSrcSampleCount samples. aSrc1 is the previous block, for the first sample's left neighbour.
+		void (*resample)(const float *aSrc, const float *aSrc1, unsigned int aSrcSampleCount, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed);
+		// Same with point sampling; cheaper, but aliases
+		void (*resamplePoint)(const float *aSrc, const float *aSrc1, unsigned int aSrcSampleCount, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed);
+		// aDst[i] += aSrc[i] * (aPan + (i + 1) * aPanDelta)
+		void (*mixRamp)(const float *aSrc, float *aDst, unsigned int aSamples, float aPan, float aPanDelta);
+		// aDst[i] += aSrc0[i] * aSrc1[i] for aCount interleaved (re, im) complex values
+		void (*complexMulAdd)(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aCount);
+	};
+
+	// Highest Soloud::SIMD_LEVELS level supported by both the build and the CPU. Detected once.
+	unsigned int detectSimdLevel();
+
+	// Kernel table for a level. Levels not compiled in fall back to the next lower one.
+	const SimdKernels *getSimdKernels(unsigned int aLevel);
+
+	// Resample aSamples samples of a voice from aSrcOffset in its planar source block (aPrev holding each
+	// channel's left neighbour of the block), and add them to the planar output with the volume ramp
+	// aPan[k] + (i + 1) * aPanDelta[k] per output channel, all in one pass.
+	typedef void (*MixVoiceKernel)(const float *aSrc, unsigned int aSrcPitch, const float *aPrev, float *aDst, unsigned int aDstPitch, unsigned int aSamples, int aSrcOffset, int aStepFixed, const float *aPan, const float *aPanDelta);
+
+	// Fused kernel for a level and channel layout: 1, 2, 4, 6 or 8 channels mixed down to mono, mono
+	// spread out to 2, 4, 6 or 8 channels, or 2, 4, 6 or 8 channels to as many. NULL for other layouts.
+	MixVoiceKernel getMixVoiceKernel(unsigned int aLevel, unsigned int aSrcChannels, unsigned int aDstChannels, bool aPoint);
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#ifndef SOLOUD_SOUNDBANK_H
+#define SOLOUD_SOUNDBANK_H
+
+#include "soloud.h"
+
+// "SLBK", little endian
+#define SOLOUD_SOUNDBANK_MAGIC 0x4b424c53
+#define SOLOUD_SOUNDBANK_VERSION 1
+// Sample data offsets are aligned to this many bytes
+#define SOLOUD_SOUNDBANK_ALIGN 16
+
+namespace SoLoud
+{
+	class Wav;
+
+	// Bank file header. All fields are little endian.
+	struct SoundBankHeader
+	{
+		unsigned int mMagic;
+		unsigned int mVersion;
+		// Number of sounds
+		unsigned int mCount;
+		// Offset of the SoundBankEntry array, from start of file
+		unsigned int mIndexOffset;
+		// Total file size, for sanity checking
+		unsigned int mFileSize;
+		unsigned int mReserved[3];
+	};
+
+	// Bank index entry. Samples are stored as float, deinterleaved (all of channel 0, then channel 1, ...).
+	struct SoundBankEntry
+	{
+		enum FLAGS
+		{
+			LOOPING = 1
+		};
+		// Offset of zero-terminated name, from start of file
+		unsigned int mNameOffset;
+		// Offset of sample data, from start of file
+		unsigned int mDataOffset;
+		// Samples per channel
+		unsigned int mSampleCount;
+		unsigned int mChannels;
+		float mSamplerate;
+		// Loop point, in samples
+		unsigned int mLoopPoint;
+		unsigned int mFlags;
+		unsigned int mReserved;
+	};
+
+	// Pre-decoded sound bank. Wavs loaded from the bank use the bank's memory directly.
+	class SoundBank
+	{
+	public:
+		// Ctor
+		SoundBank();
+		// Dtor. Closes the bank; Wavs loaded from it must not be played after that.
+		~SoundBank();
+		// Map a bank file into memory.
+		result open(const char *aFilename);
+		// Use a bank image in memory. The memory must stay valid (and at least 4-byte aligned) while the bank is open.
+		result openMem(const unsigned char *aMem, unsigned int aLength);
+		// Close the bank.
+		void close();
+		// Number of sounds in the bank
+		unsigned int getSoundCount();
+		// Name of a sound, or NULL if out of range
+		const char *getSoundName(unsigned int aIndex);
+		// Find a sound by name. Returns -1 if not found.
+		int findSound(const char *aName);
+		// Point the Wav at a sound in the bank, without copying.
+		result loadWav(Wav &aWav, unsigned int aIndex);
+		// Point the Wav at a named sound in the bank, without copying.
+		result loadWav(Wav &aWav, const char *aName);
+	public:
+		const unsigned char *mData;
+		unsigned int mLength;
+		const SoundBankHeader *mHeader;
+		const SoundBankEntry *mEntry;
+		// Platform mapping handles; NULL for memory banks
+		void *mMapHandle;
+		void *mFileHandle;
+	private:
+		result validate_internal();
+	};
+};
+
+#endif
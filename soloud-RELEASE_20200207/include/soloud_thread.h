@@ -37,23 +37,99 @@ namespace SoLoud
         typedef ThreadHandleData* ThreadHandle;
 
 		void * createMutex();
+		// Create a mutex that lends its owner the priority of the threads waiting for it. Returns NULL where not supported.
+		void * createPriorityInheritanceMutex();
 		void destroyMutex(void *aHandle);
 		void lockMutex(void *aHandle);
 		void unlockMutex(void *aHandle);
 
+		void * createCondition();
+		void destroyCondition(void *aHandle);
+		// Atomically release the mutex and wait for a signal; the mutex is locked again on return. May wake spuriously.
+		void waitCondition(void *aCondition, void *aMutex);
+		// Wake up one waiting thread.
+		void signalCondition(void *aCondition);
+		// Wake up all waiting threads.
+		void broadcastCondition(void *aCondition);
+
 		ThreadHandle createThread(threadFunction aThreadFunction, void *aParameter);
 
+		// Set the calling thread's scheduling policy (see Soloud::THREAD_SCHEDULING) and priority; 0 picks a
+		// mid-range real-time priority. Returns the policy in effect afterwards, which is SCHEDULE_NORMAL if refused.
+		unsigned int setThreadScheduling(unsigned int aPolicy, int aPriority);
+		// Pin the calling thread to the cores set in aCoreMask, bit n for core n. Returns the mask in effect afterwards, 0 if not pinned.
+		unsigned long long setThreadAffinity(unsigned long long aCoreMask);
+
 		void sleep(int aMSec);
         void wait(ThreadHandle aThreadHandle);
         void release(ThreadHandle aThreadHandle);
 		int getTimeMillis();
-
-#define MAX_THREADPOOL_TASKS 1024
+		// Monotonic time in microseconds, for measuring short intervals.
+		unsigned long long getTimeMicros();
+		// Number of logical processors, at least 1.
+		int getCoreCount();
+		// Read a value another thread wrote with atomicStore. Everything written before that store is visible after this load.
+		unsigned int atomicLoad(volatile unsigned int *aValue);
+		// Write a value for another thread to read with atomicLoad.
+		void atomicStore(volatile unsigned int *aValue, unsigned int aNewValue);
+
+		// Add aDelta to a value shared between threads and return the new value. Also a full memory barrier.
+		unsigned int atomicAdd(volatile unsigned int *aValue, int aDelta);
+		// Replace a pointer shared between threads with aNewValue if it still is aExpected. Returns the pointer it was. Also a full memory barrier.
+		void * atomicCompareExchangePointer(void * volatile *aValue, void *aExpected, void *aNewValue);
+		// Replace a pointer shared between threads and return the pointer it was. Also a full memory barrier.
+		void * atomicExchangePointer(void * volatile *aValue, void *aNewValue);
+
+		class PoolTaskGroup;
+		class Pool;
 
 		class PoolTask
 		{
 		public:
+			// Ctor
+			PoolTask();
 			virtual void work() = 0;
+		public:
+			PoolTaskGroup *mGroup; // group the task was added to, or null
+		};
+
+		// Counts unfinished tasks, so that they can be waited for together; see Pool::waitGroup
+		class PoolTaskGroup
+		{
+		public:
+			PoolTaskGroup();
+			// Dtor. The group's tasks must have finished.
+			~PoolTaskGroup();
+			// Number of tasks added to the group that haven't finished yet
+			unsigned int getPendingCount();
+			// Called when one of the group's tasks finishes
+			void taskDone_internal();
+		public:
+			void *mMutex; // protects mPending
+			void *mCondition; // signaled when the last task finishes
+			unsigned int mPending; // tasks added but not finished
+		};
+
+		// One worker's tasks. The worker takes its newest task; idle workers steal the oldest.
+		class PoolQueue
+		{
+		public:
+			PoolQueue();
+			~PoolQueue();
+			// Add task at the back, growing the queue if needed
+			void push(PoolTask *aTask);
+			// Take the newest task, or null
+			PoolTask *pop();
+			// Take the oldest task, or null
+			PoolTask *steal();
+		public:
+			void *mMutex; // protects the queue
+			PoolTask **mTask; // ring of tasks
+			unsigned int mCapacity; // size of mTask
+			unsigned int mHead; // index of the oldest task
+			unsigned int mCount; // number of tasks
+			Pool *mPool; // pool the queue's worker belongs to
+			int mWorker; // index of the queue's worker
 		};
 
 		class Pool
@@ -66,16 +142,25 @@ namespace SoLoud
 			// Dtor. Waits for the threads to finish. Work may be unfinished.
 			~Pool();
 			// Add work to work list. Object is not automatically deleted when work is done.
-			void addWork(PoolTask *aTask);
-			// Called from worker thread to get a new task. Returns null if no work available.
+			// If aGroup is given, the task counts as pending in it until its work is done.
+			void addWork(PoolTask *aTask, PoolTaskGroup *aGroup = 0);
+			// Run queued tasks on the calling thread until all tasks in aGroup have finished. Safe to call from a task.
+			void waitGroup(PoolTaskGroup *aGroup);
+			// Get a task from any worker's queue. Returns null if no work available.
 			PoolTask *getWork();
+			// Called from worker thread aWorker to wait for a new task. Returns null when the pool is shutting down.
+			PoolTask *waitWork(int aWorker);
+			// Run a task and mark it done in its group
+			void runTask_internal(PoolTask *aTask);
 		public:
 			int mThreadCount; // number of threads
 			ThreadHandle *mThread; // array of thread handles
-			void *mWorkMutex; // mutex to protect task array/maxtask
-			PoolTask *mTaskArray[MAX_THREADPOOL_TASKS]; // pointers to tasks
-			int mMaxTask; // how many tasks are pending
-			int mRobin; // cyclic counter, used to pick jobs for threads
+			PoolQueue *mQueue; // task queue for each thread
+			volatile unsigned int mQueued; // tasks in all queues
+			volatile unsigned int mSleeping; // workers waiting for work
+			volatile unsigned int mRobin; // cyclic counter, used to spread new tasks over the queues
+			void *mSleepMutex; // mutex idle workers wait with
+			void *mSleepCondition; // signaled when work is added or the pool shuts down
 			volatile int mRunning; // running flag, used to flag threads to stop
 		};
 	}
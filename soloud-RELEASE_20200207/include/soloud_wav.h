@@ -28,12 +28,17 @@ freely, subject to the following restrictions:
 #include "soloud.h"
 
 struct stb_vorbis;
+#ifndef dr_mp3_h
+struct drmp3_seek_point;
+#endif
 
 namespace SoLoud
 {
 	class Wav;
 	class File;
 	class MemoryFile;
+	class SampleCacheEntry;
+	class WavProgressiveDecoder;
 
 	class WavInstance : public AudioSourceInstance
 	{
@@ -43,7 +48,11 @@ namespace SoLoud
 		WavInstance(Wav *aParent);
 		virtual unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize);
 		virtual result rewind();
+		virtual result seek(time aSeconds, float *aScratch, unsigned int aScratchSize);
+		virtual time getLength();
 		virtual bool hasEnded();
+		virtual const float *getDirectData(unsigned int *aSampleCount, unsigned int *aPosition);
+		virtual void skipDirectData(unsigned int aSamples);
 	};
 
 	class Wav : public AudioSource
@@ -53,9 +62,33 @@ namespace SoLoud
 		result loadmp3(MemoryFile *aReader);
 		result loadflac(MemoryFile *aReader);
 		result testAndLoadFile(MemoryFile *aReader);
+		// Number of slices to decode a compressed file of mSampleCount samples in
+		unsigned int countDecodeSlices();
+		// Decode a compressed file into aData, the new mData, one slice per thread
+		void decodeSlices(MemoryFile *aReader, float *aData, int aFormat, unsigned int aSlices, drmp3_seek_point *aMp3SeekPoint, unsigned int aMp3SeekPointCount);
+		// Convert mData to mLoadSamplerate, if set
+		void resampleData();
+		// Decode the first mProgressiveLead seconds of a file, and the rest on a thread of its own
+		result loadProgressive(MemoryFile *aReader, int aFormat);
 	public:
-		float *mData;
+		// Deinterleaved samples. Read only, as they may be shared or mapped from a file.
+		const float *mData;
 		unsigned int mSampleCount;
+		// Threads used to decode compressed files; 0 uses one per core
+		unsigned int mDecodeThreadCount;
+		// Sample rate files are converted to when loaded; 0 keeps the file's rate
+		float mLoadSamplerate;
+		// Seconds of a file decoded before load returns, the rest following in the background; 0 decodes all of it
+		float mProgressiveLead;
+		// Samples per channel of mData decoded so far. Only less than mSampleCount while a progressive load
+		// runs; written with Thread::atomicStore.
+		volatile unsigned int mDecodedSampleCount;
+		// Decoder of a progressive load, until it's finished or cancelled
+		WavProgressiveDecoder *mProgressiveDecoder;
+		// Shared sample data, if loaded through a SampleCache. mData is not owned in that case.
+		SampleCacheEntry *mCacheEntry;
+		// Sample data belongs to someone else (such as a SoundBank) and is not freed.
+		bool mExternalData;
 
 		Wav();
 		virtual ~Wav();
@@ -65,9 +98,27 @@ namespace SoLoud
 		result loadRawWave8(unsigned char *aMem, unsigned int aLength, float aSamplerate = 44100.0f, unsigned int aChannels = 1);
 		result loadRawWave16(short *aMem, unsigned int aLength, float aSamplerate = 44100.0f, unsigned int aChannels = 1);
 		result loadRawWave(float *aMem, unsigned int aLength, float aSamplerate = 44100.0f, unsigned int aChannels = 1, bool aCopy = false, bool aTakeOwnership = true);
+		// Set the number of threads that decode long Ogg, MP3 and FLAC files. 0 uses one per core, 1 decodes on the loading thread only.
+		void setDecodeThreadCount(unsigned int aThreads);
+		// Convert files to this sample rate when loading them, so that they can be mixed without resampling. 0 keeps the file's rate.
+		result setLoadSamplerate(float aSamplerate);
+		// Return from loading once the first aLeadTime seconds are decoded, and decode the rest in the background. 0 decodes files completely in load.
+		// Loading fails with INVALID_PARAMETER if a load sample rate is set as well.
+		result setProgressiveLoad(float aLeadTime);
+		// Length of the part decoded so far, in seconds. Same as getLength() unless a progressive load is running.
+		time getDecodedLength();
 
 		virtual AudioSourceInstance *createInstance();
 		time getLength();
+
+		// Free or release the sample data.
+		void freeData_internal();
+		// Wait for a progressive load to finish decoding, or with aCancel, stop it where it is.
+		void endProgressiveLoad_internal(bool aCancel);
+		// Switch to shared sample data. The reference is taken over by the Wav.
+		void useCacheEntry_internal(SampleCacheEntry *aEntry);
+		// Switch to sample data owned by someone else.
+		void useExternalData_internal(const float *aData, unsigned int aSampleCount, unsigned int aChannels, float aSamplerate);
 	};
 };
 
@@ -38,24 +38,34 @@ struct drmp3;
 #ifndef dr_wav_h
 struct drwav;
 #endif
+#ifndef dr_mp3_h
+struct drmp3_seek_point;
+#endif
+
+// Number of finished instances' decoders a WavStream keeps for reuse
+#define WAVSTREAM_MAX_PARKED_DECODERS 4
 
 namespace SoLoud
 {
 	class WavStream;
 	class File;
 
+	union WavStreamCodec
+	{
+		stb_vorbis *mOgg;
+		drflac *mFlac;
+		drmp3 *mMp3;
+		drwav *mWav;
+	};
+
 	class WavStreamInstance : public AudioSourceInstance
 	{
 		WavStream *mParent;
 		unsigned int mOffset;
 		File *mFile;
-		union codec
-		{
-			stb_vorbis *mOgg;
-			drflac *mFlac;
-			drmp3 *mMp3;
-			drwav *mWav;
-		} mCodec;
+		WavStreamCodec mCodec;
+		// Parent's load the decoder was opened for; see WavStream::mDecoderGeneration
+		unsigned int mDecoderGeneration;
 		unsigned int mOggFrameSize;
 		unsigned int mOggFrameOffset;
 		float **mOggOutputs;
@@ -63,6 +73,8 @@ namespace SoLoud
 		WavStreamInstance(WavStream *aParent);
 		virtual unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize);
 		virtual result rewind();
+		virtual result seek(time aSeconds, float *mScratch, unsigned int mScratchSize);
+		virtual time getLength();
 		virtual bool hasEnded();
 		virtual ~WavStreamInstance();
 	};
@@ -87,6 +99,17 @@ namespace SoLoud
 		File *mMemFile;
 		File *mStreamFile;
 		unsigned int mSampleCount;
+		// MP3 seek table, shared by all instances so that they don't have to scan the file to seek
+		drmp3_seek_point *mMp3SeekPoint;
+		unsigned int mMp3SeekPointCount;
+		// Open files and decoders left by finished instances, already past the header parsing
+		File *mParkedFile[WAVSTREAM_MAX_PARKED_DECODERS];
+		WavStreamCodec mParkedCodec[WAVSTREAM_MAX_PARKED_DECODERS];
+		unsigned int mParkedCount;
+		// Protects the parked decoders; instances may finish on the audio thread
+		void *mParkMutex;
+		// Bumped on every load, so that decoders of the previous file don't get parked
+		unsigned int mDecoderGeneration;
 
 		WavStream();
 		virtual ~WavStream();
@@ -100,6 +123,14 @@ namespace SoLoud
 
 	public:
 		result parse(File *aFile);
+		// Keep a finished instance's file and decoder for the next instance. Returns false if not kept.
+		bool parkDecoder_internal(unsigned int aGeneration, File *aFile, WavStreamCodec aCodec);
+		// Take a parked file and decoder. Returns false if there are none.
+		bool unparkDecoder_internal(File **aFile, WavStreamCodec *aCodec);
+		// Close a decoder and its file
+		void closeDecoder_internal(File *aFile, WavStreamCodec aCodec);
+		// Close the parked decoders, free the seek table and stop parking the decoders of current instances. Called before loading.
+		void resetDecoders_internal();
 	};
 };
 
@@ -385,7 +385,26 @@ sources = [
 "src/filter/soloud_freeverbfilter.cpp",
 "include/soloud_freeverbfilter.h",
 "include/soloud_misc.h",
-"include/soloud_noise.h"
+"include/soloud_noise.h",
+"include/soloud_scheduler.h",
+"src/core/soloud_core_scheduler.cpp",
+"src/core/soloud_scheduler.cpp",
+"include/soloud_asyncloader.h",
+"src/audiosource/wav/soloud_asyncloader.cpp",
+"include/soloud_samplecache.h",
+"src/audiosource/wav/soloud_samplecache.cpp",
+"include/soloud_soundbank.h",
+"src/audiosource/wav/soloud_soundbank.cpp",
+"src/tools/bankbuilder/main.cpp",
+"include/soloud_simd.h",
+"src/core/soloud_simd.cpp",
+"include/soloud_convert.h",
+"src/core/soloud_convert.cpp",
+"src/tools/mixbench/main.cpp",
+"include/soloud_ambisonicbus.h",
+"src/core/soloud_ambisonicbus.cpp",
+"include/soloud_hrtfbus.h",
+"src/core/soloud_hrtfbus.cpp"
 ]
 
 notfound = []
@@ -0,0 +1,220 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include <string.h>
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_wavstream.h"
+#include "soloud_asyncloader.h"
+
+namespace SoLoud
+{
+	AsyncLoadJob::AsyncLoadJob()
+	{
+		mParent = 0;
+		mSource = 0;
+		mType = WAV;
+		mFilename = 0;
+		mCallback = 0;
+		mUserData = 0;
+		mTicket = 0;
+		mResult = UNKNOWN_ERROR;
+		mDone = false;
+	}
+
+	AsyncLoadJob::~AsyncLoadJob()
+	{
+		delete[] mFilename;
+	}
+
+	void AsyncLoadJob::work()
+	{
+		result res;
+		if (mType == WAVSTREAM)
+		{
+			res = ((WavStream*)mSource)->load(mFilename);
+		}
+		else
+		{
+			res = ((Wav*)mSource)->load(mFilename);
+		}
+		mResult = res;
+		if (mCallback)
+		{
+			mCallback(mTicket, mSource, res, mUserData);
+		}
+		mParent->jobDone_internal(this);
+	}
+
+	AsyncLoader::AsyncLoader()
+	{
+		mMutex = Thread::createMutex();
+		mDoneCondition = Thread::createCondition();
+		mJob = 0;
+		mJobCount = 0;
+		mJobCapacity = 0;
+		mPending = 0;
+	}
+
+	AsyncLoader::~AsyncLoader()
+	{
+		reset();
+		delete[] mJob;
+		Thread::destroyCondition(mDoneCondition);
+		Thread::destroyMutex(mMutex);
+	}
+
+	result AsyncLoader::init(unsigned int aThreadCount)
+	{
+		if (mPool.mThreadCount)
+			return INVALID_PARAMETER;
+		if (aThreadCount == 0)
+			aThreadCount = Thread::getCoreCount();
+		mPool.init(aThreadCount);
+		return SO_NO_ERROR;
+	}
+
+	unsigned int AsyncLoader::queue_internal(AudioSource &aSource, int aType, const char *aFilename, asyncLoadCallback aCallback, void *aUserData)
+	{
+		if (aFilename == NULL)
+			return 0;
+
+		AsyncLoadJob *job = new AsyncLoadJob;
+		int len = (int)strlen(aFilename);
+		job->mFilename = new char[len + 1];
+		memcpy(job->mFilename, aFilename, len + 1);
+		job->mParent = this;
+		job->mSource = &aSource;
+		job->mType = aType;
+		job->mCallback = aCallback;
+		job->mUserData = aUserData;
+
+		Thread::lockMutex(mMutex);
+		if (mJobCount == mJobCapacity)
+		{
+			unsigned int newcap = mJobCapacity ? mJobCapacity * 2 : 64;
+			AsyncLoadJob **n = new AsyncLoadJob*[newcap];
+			if (mJobCount)
+				memcpy(n, mJob, sizeof(AsyncLoadJob*) * mJobCount);
+			delete[] mJob;
+			mJob = n;
+			mJobCapacity = newcap;
+		}
+		mJob[mJobCount] = job;
+		mJobCount++;
+		job->mTicket = mJobCount;
+		mPending++;
+		Thread::unlockMutex(mMutex);
+
+		unsigned int ticket = job->mTicket;
+		// Without worker threads, the job runs right here.
+		mPool.addWork(job);
+		return ticket;
+	}
+
+	unsigned int AsyncLoader::loadWav(Wav &aWav, const char *aFilename, asyncLoadCallback aCallback, void *aUserData)
+	{
+		return queue_internal(aWav, AsyncLoadJob::WAV, aFilename, aCallback, aUserData);
+	}
+
+	unsigned int AsyncLoader::loadWavStream(WavStream &aWavStream, const char *aFilename, asyncLoadCallback aCallback, void *aUserData)
+	{
+		return queue_internal(aWavStream, AsyncLoadJob::WAVSTREAM, aFilename, aCallback, aUserData);
+	}
+
+	void AsyncLoader::jobDone_internal(AsyncLoadJob *aJob)
+	{
+		Thread::lockMutex(mMutex);
+		aJob->mDone = true;
+		mPending--;
+		// Wake the waiters before unlocking; a waiter may destroy the loader as soon as it sees this.
+		Thread::broadcastCondition(mDoneCondition);
+		Thread::unlockMutex(mMutex);
+	}
+
+	bool AsyncLoader::isDone(unsigned int aTicket)
+	{
+		bool done = true;
+		Thread::lockMutex(mMutex);
+		if (aTicket > 0 && aTicket <= mJobCount)
+			done = mJob[aTicket - 1]->mDone;
+		Thread::unlockMutex(mMutex);
+		return done;
+	}
+
+	result AsyncLoader::getResult(unsigned int aTicket)
+	{
+		result res = INVALID_PARAMETER;
+		Thread::lockMutex(mMutex);
+		if (aTicket > 0 && aTicket <= mJobCount)
+		{
+			AsyncLoadJob *job = mJob[aTicket - 1];
+			res = job->mDone ? job->mResult : (result)UNKNOWN_ERROR;
+		}
+		Thread::unlockMutex(mMutex);
+		return res;
+	}
+
+	result AsyncLoader::wait(unsigned int aTicket)
+	{
+		result res = INVALID_PARAMETER;
+		Thread::lockMutex(mMutex);
+		if (aTicket > 0 && aTicket <= mJobCount)
+		{
+			AsyncLoadJob *job = mJob[aTicket - 1];
+			while (!job->mDone)
+				Thread::waitCondition(mDoneCondition, mMutex);
+			res = job->mResult;
+		}
+		Thread::unlockMutex(mMutex);
+		return res;
+	}
+
+	void AsyncLoader::waitAll()
+	{
+		Thread::lockMutex(mMutex);
+		while (mPending)
+			Thread::waitCondition(mDoneCondition, mMutex);
+		Thread::unlockMutex(mMutex);
+	}
+
+	unsigned int AsyncLoader::getPendingCount()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int pending = mPending;
+		Thread::unlockMutex(mMutex);
+		return pending;
+	}
+
+	void AsyncLoader::reset()
+	{
+		waitAll();
+		Thread::lockMutex(mMutex);
+		unsigned int i;
+		for (i = 0; i < mJobCount; i++)
+			delete mJob[i];
+		mJobCount = 0;
+		Thread::unlockMutex(mMutex);
+	}
+};
@@ -0,0 +1,356 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include <string.h>
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_thread.h"
+#include "soloud_samplecache.h"
+
+namespace SoLoud
+{
+	// 64-bit FNV-1a
+	static unsigned long long hashData(const unsigned char *aData, unsigned int aLength)
+	{
+		unsigned long long h = 14695981039346656037ULL;
+		unsigned int i;
+		for (i = 0; i < aLength; i++)
+		{
+			h ^= aData[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+
+	SampleCacheEntry::SampleCacheEntry()
+	{
+		mPath = 0;
+		mHash = 0;
+		mSourceLength = 0;
+		mLoadSamplerate = 0;
+		mData = 0;
+		mSampleCount = 0;
+		mChannels = 1;
+		mBaseSamplerate = 44100.0f;
+		mRefCount = 0;
+		mPrev = 0;
+		mNext = 0;
+	}
+
+	SampleCacheEntry::~SampleCacheEntry()
+	{
+		delete[] mPath;
+		delete[] mData;
+	}
+
+	unsigned int SampleCacheEntry::getSize() const
+	{
+		return mSampleCount * mChannels * sizeof(float);
+	}
+
+	SampleCache::SampleCache()
+	{
+		mMutex = Thread::createMutex();
+		mHead = 0;
+		mTail = 0;
+		mEntryCount = 0;
+		mBudget = 0;
+		mMemoryUsage = 0;
+		mHits = 0;
+		mMisses = 0;
+		mEvictions = 0;
+	}
+
+	SampleCache::~SampleCache()
+	{
+		Thread::lockMutex(mMutex);
+		SampleCacheEntry *e = mHead;
+		while (e)
+		{
+			// Entries still in use are freed by the last Wav to let go of them
+			SampleCacheEntry *next = e->mNext;
+			if (Thread::atomicAdd(&e->mRefCount, -1) == 0)
+				delete e;
+			e = next;
+		}
+		mHead = mTail = 0;
+		Thread::unlockMutex(mMutex);
+		Thread::destroyMutex(mMutex);
+	}
+
+	void SampleCache::setMemoryBudget(unsigned int aBytes)
+	{
+		Thread::lockMutex(mMutex);
+		mBudget = aBytes;
+		trim_internal();
+		Thread::unlockMutex(mMutex);
+	}
+
+	unsigned int SampleCache::getMemoryBudget()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int budget = mBudget;
+		Thread::unlockMutex(mMutex);
+		return budget;
+	}
+
+	SampleCacheEntry *SampleCache::find_internal(const char *aPath, unsigned long long aHash, unsigned int aLength, float aLoadSamplerate)
+	{
+		SampleCacheEntry *e = mHead;
+		while (e)
+		{
+			// Data converted to another rate, or not at all, doesn't match
+			if (e->mLoadSamplerate == aLoadSamplerate)
+			{
+				if (aPath)
+				{
+					if (e->mPath && strcmp(e->mPath, aPath) == 0)
+						return e;
+				}
+				else
+				{
+					if (!e->mPath && e->mHash == aHash && e->mSourceLength == aLength)
+						return e;
+				}
+			}
+			e = e->mNext;
+		}
+		return 0;
+	}
+
+	void SampleCache::unlink_internal(SampleCacheEntry *aEntry)
+	{
+		if (aEntry->mPrev)
+			aEntry->mPrev->mNext = aEntry->mNext;
+		else
+			mHead = aEntry->mNext;
+		if (aEntry->mNext)
+			aEntry->mNext->mPrev = aEntry->mPrev;
+		else
+			mTail = aEntry->mPrev;
+		aEntry->mPrev = 0;
+		aEntry->mNext = 0;
+	}
+
+	void SampleCache::touch_internal(SampleCacheEntry *aEntry)
+	{
+		if (mHead == aEntry)
+			return;
+		if (aEntry->mPrev || aEntry->mNext || mTail == aEntry)
+			unlink_internal(aEntry);
+		aEntry->mNext = mHead;
+		if (mHead)
+			mHead->mPrev = aEntry;
+		mHead = aEntry;
+		if (!mTail)
+			mTail = aEntry;
+	}
+
+	void SampleCache::trim_internal()
+	{
+		if (mBudget == 0)
+			return;
+		// Walk from the least recently used end, skipping entries that are in use. Wavs only
+		// take references under the mutex, so one held by the cache alone stays that way.
+		SampleCacheEntry *e = mTail;
+		while (e && mMemoryUsage > mBudget)
+		{
+			SampleCacheEntry *prev = e->mPrev;
+			if (Thread::atomicLoad(&e->mRefCount) == 1)
+			{
+				unlink_internal(e);
+				mMemoryUsage -= e->getSize();
+				mEntryCount--;
+				mEvictions++;
+				delete e;
+			}
+			e = prev;
+		}
+	}
+
+	result SampleCache::attach_internal(Wav &aWav, SampleCacheEntry *aKey)
+	{
+		Thread::lockMutex(mMutex);
+		SampleCacheEntry *e = find_internal(aKey->mPath, aKey->mHash, aKey->mSourceLength, aKey->mLoadSamplerate);
+		if (e == NULL)
+		{
+			// The Wav decoded it; the cache takes over the data.
+			e = new SampleCacheEntry;
+			e->mRefCount = 1;
+			e->mPath = aKey->mPath;
+			aKey->mPath = 0;
+			e->mHash = aKey->mHash;
+			e->mSourceLength = aKey->mSourceLength;
+			e->mLoadSamplerate = aKey->mLoadSamplerate;
+			e->mData = aWav.mData;
+			e->mSampleCount = aWav.mSampleCount;
+			e->mChannels = aWav.mChannels;
+			e->mBaseSamplerate = aWav.mBaseSamplerate;
+			aWav.mData = 0;
+			mEntryCount++;
+			mMemoryUsage += e->getSize();
+		}
+		Thread::atomicAdd(&e->mRefCount, 1);
+		touch_internal(e);
+		Thread::unlockMutex(mMutex);
+
+		aWav.useCacheEntry_internal(e);
+
+		Thread::lockMutex(mMutex);
+		trim_internal();
+		Thread::unlockMutex(mMutex);
+		return SO_NO_ERROR;
+	}
+
+	result SampleCache::load(Wav &aWav, const char *aFilename)
+	{
+		if (aFilename == NULL)
+			return INVALID_PARAMETER;
+
+		Thread::lockMutex(mMutex);
+		SampleCacheEntry *e = find_internal(aFilename, 0, 0, aWav.mLoadSamplerate);
+		if (e)
+		{
+			Thread::atomicAdd(&e->mRefCount, 1);
+			touch_internal(e);
+			mHits++;
+			// Entries let go of since the last call may be over the budget
+			trim_internal();
+			Thread::unlockMutex(mMutex);
+			aWav.useCacheEntry_internal(e);
+			return SO_NO_ERROR;
+		}
+		mMisses++;
+		Thread::unlockMutex(mMutex);
+
+		// Decode outside the lock so other loads can proceed.
+		result res = aWav.load(aFilename);
+		if (res != SO_NO_ERROR)
+			return res;
+		// Entries are shared complete; a progressive load finishes here
+		aWav.endProgressiveLoad_internal(false);
+
+		SampleCacheEntry key;
+		int len = (int)strlen(aFilename);
+		key.mPath = new char[len + 1];
+		memcpy(key.mPath, aFilename, len + 1);
+		key.mLoadSamplerate = aWav.mLoadSamplerate;
+		return attach_internal(aWav, &key);
+	}
+
+	result SampleCache::loadMem(Wav &aWav, const unsigned char *aMem, unsigned int aLength)
+	{
+		if (aMem == NULL || aLength == 0)
+			return INVALID_PARAMETER;
+
+		unsigned long long hash = hashData(aMem, aLength);
+
+		Thread::lockMutex(mMutex);
+		SampleCacheEntry *e = find_internal(0, hash, aLength, aWav.mLoadSamplerate);
+		if (e)
+		{
+			Thread::atomicAdd(&e->mRefCount, 1);
+			touch_internal(e);
+			mHits++;
+			// Entries let go of since the last call may be over the budget
+			trim_internal();
+			Thread::unlockMutex(mMutex);
+			aWav.useCacheEntry_internal(e);
+			return SO_NO_ERROR;
+		}
+		mMisses++;
+		Thread::unlockMutex(mMutex);
+
+		result res = aWav.loadMem(aMem, aLength, false, false);
+		if (res != SO_NO_ERROR)
+			return res;
+		aWav.endProgressiveLoad_internal(false);
+
+		SampleCacheEntry key;
+		key.mHash = hash;
+		key.mSourceLength = aLength;
+		key.mLoadSamplerate = aWav.mLoadSamplerate;
+		return attach_internal(aWav, &key);
+	}
+
+	void SampleCache::purge()
+	{
+		Thread::lockMutex(mMutex);
+		SampleCacheEntry *e = mHead;
+		while (e)
+		{
+			SampleCacheEntry *next = e->mNext;
+			if (Thread::atomicLoad(&e->mRefCount) == 1)
+			{
+				unlink_internal(e);
+				mMemoryUsage -= e->getSize();
+				mEntryCount--;
+				mEvictions++;
+				delete e;
+			}
+			e = next;
+		}
+		Thread::unlockMutex(mMutex);
+	}
+
+	unsigned int SampleCache::getHitCount()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int count = mHits;
+		Thread::unlockMutex(mMutex);
+		return count;
+	}
+
+	unsigned int SampleCache::getMissCount()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int count = mMisses;
+		Thread::unlockMutex(mMutex);
+		return count;
+	}
+
+	unsigned int SampleCache::getEvictionCount()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int count = mEvictions;
+		Thread::unlockMutex(mMutex);
+		return count;
+	}
+
+	unsigned int SampleCache::getMemoryUsage()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int count = mMemoryUsage;
+		Thread::unlockMutex(mMutex);
+		return count;
+	}
+
+	unsigned int SampleCache::getEntryCount()
+	{
+		Thread::lockMutex(mMutex);
+		unsigned int count = mEntryCount;
+		Thread::unlockMutex(mMutex);
+		return count;
+	}
+};
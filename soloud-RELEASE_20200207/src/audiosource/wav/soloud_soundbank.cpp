@@ -0,0 +1,237 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#if defined(_WIN32)||defined(_WIN64)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <string.h>
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_soundbank.h"
+
+namespace SoLoud
+{
+	SoundBank::SoundBank()
+	{
+		mData = 0;
+		mLength = 0;
+		mHeader = 0;
+		mEntry = 0;
+		mMapHandle = 0;
+		mFileHandle = 0;
+	}
+
+	SoundBank::~SoundBank()
+	{
+		close();
+	}
+
+	result SoundBank::validate_internal()
+	{
+		if (mLength < sizeof(SoundBankHeader))
+			return FILE_LOAD_FAILED;
+		mHeader = (const SoundBankHeader *)mData;
+		if (mHeader->mMagic != SOLOUD_SOUNDBANK_MAGIC ||
+			mHeader->mVersion != SOLOUD_SOUNDBANK_VERSION ||
+			mHeader->mFileSize != mLength ||
+			mHeader->mIndexOffset % 4 != 0 ||
+			mHeader->mIndexOffset > mLength ||
+			mHeader->mCount > (mLength - mHeader->mIndexOffset) / sizeof(SoundBankEntry))
+		{
+			mHeader = 0;
+			return FILE_LOAD_FAILED;
+		}
+		mEntry = (const SoundBankEntry *)(mData + mHeader->mIndexOffset);
+
+		// Only the index is checked here; the sample data is never touched until played.
+		unsigned int i;
+		for (i = 0; i < mHeader->mCount; i++)
+		{
+			const SoundBankEntry &e = mEntry[i];
+			unsigned long long bytes = (unsigned long long)e.mSampleCount * e.mChannels * sizeof(float);
+			if (e.mNameOffset >= mLength ||
+				e.mDataOffset % 4 != 0 ||
+				e.mChannels < 1 || e.mChannels > MAX_CHANNELS ||
+				e.mSamplerate <= 0 ||
+				(unsigned long long)e.mDataOffset + bytes > mLength ||
+				memchr(mData + e.mNameOffset, 0, mLength - e.mNameOffset) == NULL)
+			{
+				mHeader = 0;
+				mEntry = 0;
+				return FILE_LOAD_FAILED;
+			}
+		}
+		return SO_NO_ERROR;
+	}
+
+	result SoundBank::open(const char *aFilename)
+	{
+		if (aFilename == NULL)
+			return INVALID_PARAMETER;
+		close();
+
+#if defined(_WIN32)||defined(_WIN64)
+		HANDLE f = CreateFileA(aFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (f == INVALID_HANDLE_VALUE)
+			return FILE_NOT_FOUND;
+		DWORD size = GetFileSize(f, NULL);
+		if (size == INVALID_FILE_SIZE || size == 0)
+		{
+			CloseHandle(f);
+			return FILE_LOAD_FAILED;
+		}
+		HANDLE map = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (map == NULL)
+		{
+			CloseHandle(f);
+			return FILE_LOAD_FAILED;
+		}
+		void *ptr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+		if (ptr == NULL)
+		{
+			CloseHandle(map);
+			CloseHandle(f);
+			return FILE_LOAD_FAILED;
+		}
+		mFileHandle = (void*)f;
+		mMapHandle = (void*)map;
+		mData = (const unsigned char *)ptr;
+		mLength = size;
+#else
+		int fd = ::open(aFilename, O_RDONLY);
+		if (fd < 0)
+			return FILE_NOT_FOUND;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0 || (unsigned long long)st.st_size > 0xffffffffULL)
+		{
+			::close(fd);
+			return FILE_LOAD_FAILED;
+		}
+		void *ptr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		// The mapping stays valid after the descriptor is closed.
+		::close(fd);
+		if (ptr == MAP_FAILED)
+			return FILE_LOAD_FAILED;
+		mMapHandle = ptr;
+		mData = (const unsigned char *)ptr;
+		mLength = (unsigned int)st.st_size;
+#endif
+
+		result res = validate_internal();
+		if (res != SO_NO_ERROR)
+			close();
+		return res;
+	}
+
+	result SoundBank::openMem(const unsigned char *aMem, unsigned int aLength)
+	{
+		if (aMem == NULL || aLength == 0 || ((size_t)aMem & 3) != 0)
+			return INVALID_PARAMETER;
+		close();
+		mData = aMem;
+		mLength = aLength;
+		result res = validate_internal();
+		if (res != SO_NO_ERROR)
+			close();
+		return res;
+	}
+
+	void SoundBank::close()
+	{
+#if defined(_WIN32)||defined(_WIN64)
+		if (mMapHandle)
+		{
+			UnmapViewOfFile(mData);
+			CloseHandle((HANDLE)mMapHandle);
+			CloseHandle((HANDLE)mFileHandle);
+		}
+#else
+		if (mMapHandle)
+		{
+			munmap(mMapHandle, mLength);
+		}
+#endif
+		mMapHandle = 0;
+		mFileHandle = 0;
+		mData = 0;
+		mLength = 0;
+		mHeader = 0;
+		mEntry = 0;
+	}
+
+	unsigned int SoundBank::getSoundCount()
+	{
+		if (!mHeader)
+			return 0;
+		return mHeader->mCount;
+	}
+
+	const char *SoundBank::getSoundName(unsigned int aIndex)
+	{
+		if (aIndex >= getSoundCount())
+			return 0;
+		return (const char *)(mData + mEntry[aIndex].mNameOffset);
+	}
+
+	int SoundBank::findSound(const char *aName)
+	{
+		if (aName == NULL)
+			return -1;
+		unsigned int i;
+		for (i = 0; i < getSoundCount(); i++)
+		{
+			if (strcmp(aName, (const char *)(mData + mEntry[i].mNameOffset)) == 0)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	result SoundBank::loadWav(Wav &aWav, unsigned int aIndex)
+	{
+		if (aIndex >= getSoundCount())
+			return INVALID_PARAMETER;
+		const SoundBankEntry &e = mEntry[aIndex];
+		// The mapping is read only; validate_internal made sure the samples are aligned for floats
+		aWav.useExternalData_internal((const float *)(mData + e.mDataOffset), e.mSampleCount, e.mChannels, e.mSamplerate);
+		aWav.setLooping((e.mFlags & SoundBankEntry::LOOPING) != 0);
+		aWav.setLoopPoint(e.mLoopPoint / (time)e.mSamplerate);
+		return SO_NO_ERROR;
+	}
+
+	result SoundBank::loadWav(Wav &aWav, const char *aName)
+	{
+		int i = findSound(aName);
+		if (i < 0)
+			return INVALID_PARAMETER;
+		return loadWav(aWav, (unsigned int)i);
+	}
+};
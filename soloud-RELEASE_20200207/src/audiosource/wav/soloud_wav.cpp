@@ -25,16 +25,333 @@ freely, subject to the following restrictions:
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include "soloud.h"
-#include "soloud_wav.h"
-#include "soloud_file.h"
-#include "stb_vorbis.h"
 #include "dr_mp3.h"
 #include "dr_wav.h"
 #include "dr_flac.h"
+#include "soloud_wav.h"
+#include "soloud_file.h"
+#include "soloud_samplecache.h"
+#include "soloud_convert.h"
+#include "soloud_thread.h"
+#include "stb_vorbis.h"
+
+// Shortest slice worth a decoder of its own; opening it and seeking costs a few frames
+#define WAV_DECODE_SLICE_MIN_SAMPLES (1 << 18)
+// Most slices a file is decoded in
+#define WAV_DECODE_MAX_SLICES 64
+// Zero crossings of the load-time resampler's windowed sinc, on each side
+#define WAV_RESAMPLE_ZERO_CROSSINGS 16
+// Kernel table entries per zero crossing; the kernel is interpolated between them
+#define WAV_RESAMPLE_TABLE_RESOLUTION 256
+// Share of the lower Nyquist frequency the load-time resampler keeps, leaving room for the filter to roll off
+#define WAV_RESAMPLE_PASSBAND 0.95
+// Samples per channel a progressive load decodes between publishing its progress and checking for cancellation
+#define WAV_PROGRESSIVE_CHUNK_SAMPLES 4096
 
 namespace SoLoud
 {
+	enum WAV_DECODE_FORMAT
+	{
+		WAV_DECODE_OGG,
+		WAV_DECODE_MP3,
+		WAV_DECODE_FLAC,
+		WAV_DECODE_WAV
+	};
+
+	// Decodes one slice of a compressed file straight into its place in Wav::mData,
+	// with a decoder of its own
+	class WavDecodeTask : public Thread::PoolTask
+	{
+	public:
+		WavDecodeTask();
+		virtual void work();
+		const unsigned char *mFile;
+		unsigned int mFileLength;
+		int mFormat;
+		float *mData;
+		unsigned int mSampleCount;
+		unsigned int mChannels;
+		unsigned int mStart;
+		unsigned int mCount;
+		drmp3_seek_point *mMp3SeekPoint;
+		unsigned int mMp3SeekPointCount;
+		// Decoder couldn't be opened or didn't find the slice
+		bool mFailed;
+	};
+
+	WavDecodeTask::WavDecodeTask()
+	{
+		mFile = NULL;
+		mFileLength = 0;
+		mFormat = WAV_DECODE_OGG;
+		mData = NULL;
+		mSampleCount = 0;
+		mChannels = 0;
+		mStart = 0;
+		mCount = 0;
+		mMp3SeekPoint = NULL;
+		mMp3SeekPointCount = 0;
+		mFailed = false;
+	}
+
+	void WavDecodeTask::work()
+	{
+		mFailed = true;
+		unsigned int i;
+		float tmp[512 * MAX_CHANNELS];
+		if (mFormat == WAV_DECODE_OGG)
+		{
+			int e = 0;
+			stb_vorbis *vorbis = stb_vorbis_open_memory(mFile, mFileLength, &e, 0);
+			if (vorbis == NULL)
+				return;
+			if (mStart == 0 || stb_vorbis_seek(vorbis, mStart))
+			{
+				float *outputs[MAX_CHANNELS];
+				for (i = 0; i < mChannels; i++)
+					outputs[i] = mData + mStart + mSampleCount * i;
+				unsigned int samples = 0;
+				while (samples < mCount)
+				{
+					int n = stb_vorbis_get_samples_float(vorbis, mChannels, outputs, mCount - samples);
+					if (n <= 0)
+						break;
+					for (i = 0; i < mChannels; i++)
+						outputs[i] += n;
+					samples += n;
+				}
+				mFailed = false;
+			}
+			stb_vorbis_close(vorbis);
+		}
+		else if (mFormat == WAV_DECODE_MP3)
+		{
+			drmp3 decoder;
+			if (!drmp3_init_memory(&decoder, mFile, mFileLength, NULL, NULL))
+				return;
+			if (mMp3SeekPoint)
+				drmp3_bind_seek_table(&decoder, mMp3SeekPointCount, mMp3SeekPoint);
+			if (mStart == 0 || drmp3_seek_to_pcm_frame(&decoder, mStart))
+			{
+				for (i = 0; i < mCount; i += 512)
+				{
+					unsigned int blockSize = (mCount - i) > 512 ? 512 : mCount - i;
+					drmp3_read_pcm_frames_f32(&decoder, blockSize, tmp);
+					deinterlace_samples(tmp, SAMPLE_FLOAT32, mChannels, mData + mStart + i, mSampleCount, blockSize, mChannels);
+				}
+				mFailed = false;
+			}
+			drmp3_uninit(&decoder);
+		}
+		else
+		{
+			drflac *decoder = drflac_open_memory(mFile, mFileLength, NULL);
+			if (!decoder)
+				return;
+			if (mStart == 0 || drflac_seek_to_pcm_frame(decoder, mStart))
+			{
+				for (i = 0; i < mCount; i += 512)
+				{
+					unsigned int blockSize = (mCount - i) > 512 ? 512 : mCount - i;
+					drflac_read_pcm_frames_f32(decoder, blockSize, tmp);
+					deinterlace_samples(tmp, SAMPLE_FLOAT32, mChannels, mData + mStart + i, mSampleCount, blockSize, mChannels);
+				}
+				mFailed = false;
+			}
+			drflac_close(decoder);
+		}
+	}
+
+	// Workers shared by the slice decoding of all Wavs, so that loads running at the same time
+	// don't each start a thread per core. Made on first use and kept for the life of the process.
+	static void * volatile gDecodePool = NULL;
+
+	static Thread::Pool *getDecodePool()
+	{
+		Thread::Pool *pool = (Thread::Pool *)Thread::atomicCompareExchangePointer(&gDecodePool, NULL, NULL);
+		if (pool)
+			return pool;
+		pool = new Thread::Pool;
+		if (pool == NULL)
+			return NULL;
+		// The loading thread makes up the last core
+		int threads = Thread::getCoreCount() - 1;
+		pool->init(threads > 0 ? threads : 0);
+		Thread::Pool *first = (Thread::Pool *)Thread::atomicCompareExchangePointer(&gDecodePool, NULL, pool);
+		if (first)
+		{
+			// Another load got there first
+			delete pool;
+			return first;
+		}
+		return pool;
+	}
+
+	// Decodes a progressively loaded file front to back on a thread of its own, letting
+	// the instances know how far it got through Wav::mDecodedSampleCount
+	class WavProgressiveDecoder
+	{
+	public:
+		WavProgressiveDecoder();
+		~WavProgressiveDecoder();
+		// Open the decoder on mFile and read the stream's format. Returns false if it can't be decoded.
+		bool open(int aFormat);
+		// Decode up to aSamples more samples per channel into mData and publish them. Returns false once the whole stream is in.
+		bool decode(unsigned int aSamples);
+		// Copy of the file, as the decoder outlives the load call
+		MemoryFile mFile;
+		Wav *mParent;
+		int mFormat;
+		float *mData;
+		unsigned int mSampleCount;
+		unsigned int mChannels;
+		float mSamplerate;
+		// Samples per channel decoded so far
+		unsigned int mDecoded;
+		drwav mWav;
+		drmp3 mMp3;
+		drflac *mFlac;
+		stb_vorbis *mVorbis;
+		// mWav or mMp3 needs uninit
+		bool mOpen;
+		Thread::ThreadHandle mThread;
+		// Set to stop the thread where it is
+		volatile unsigned int mCancel;
+	};
+
+	WavProgressiveDecoder::WavProgressiveDecoder()
+	{
+		mParent = NULL;
+		mFormat = WAV_DECODE_WAV;
+		mData = NULL;
+		mSampleCount = 0;
+		mChannels = 0;
+		mSamplerate = 0;
+		mDecoded = 0;
+		mFlac = NULL;
+		mVorbis = NULL;
+		mOpen = false;
+		mThread = NULL;
+		mCancel = 0;
+	}
+
+	WavProgressiveDecoder::~WavProgressiveDecoder()
+	{
+		if (mOpen && mFormat == WAV_DECODE_WAV)
+			drwav_uninit(&mWav);
+		if (mOpen && mFormat == WAV_DECODE_MP3)
+			drmp3_uninit(&mMp3);
+		if (mFlac)
+			drflac_close(mFlac);
+		if (mVorbis)
+			stb_vorbis_close(mVorbis);
+	}
+
+	bool WavProgressiveDecoder::open(int aFormat)
+	{
+		mFormat = aFormat;
+		unsigned long long samples = 0;
+		if (aFormat == WAV_DECODE_OGG)
+		{
+			int e = 0;
+			mVorbis = stb_vorbis_open_memory(mFile.getMemPtr(), mFile.length(), &e, 0);
+			if (mVorbis == NULL)
+				return false;
+			stb_vorbis_info info = stb_vorbis_get_info(mVorbis);
+			samples = stb_vorbis_stream_length_in_samples(mVorbis);
+			mChannels = info.channels > MAX_CHANNELS ? MAX_CHANNELS : info.channels;
+			mSamplerate = (float)info.sample_rate;
+		}
+		else if (aFormat == WAV_DECODE_MP3)
+		{
+			if (!drmp3_init_memory(&mMp3, mFile.getMemPtr(), mFile.length(), NULL, NULL))
+				return false;
+			mOpen = true;
+			samples = drmp3_get_pcm_frame_count(&mMp3);
+			mChannels = mMp3.channels;
+			mSamplerate = (float)mMp3.sampleRate;
+		}
+		else if (aFormat == WAV_DECODE_FLAC)
+		{
+			mFlac = drflac_open_memory(mFile.getMemPtr(), mFile.length(), NULL);
+			if (mFlac == NULL)
+				return false;
+			samples = mFlac->totalPCMFrameCount;
+			mChannels = mFlac->channels;
+			mSamplerate = (float)mFlac->sampleRate;
+		}
+		else
+		{
+			if (!drwav_init_memory(&mWav, mFile.getMemPtr(), mFile.length(), NULL))
+				return false;
+			mOpen = true;
+			samples = mWav.totalPCMFrameCount;
+			mChannels = mWav.channels;
+			mSamplerate = (float)mWav.sampleRate;
+		}
+
+		// Interleaved frames are read through a buffer sized for MAX_CHANNELS
+		if (samples == 0 || mChannels < 1 || mChannels > MAX_CHANNELS || samples * mChannels > 0xffffffff)
+			return false;
+		mSampleCount = (unsigned int)samples;
+		return true;
+	}
+
+	bool WavProgressiveDecoder::decode(unsigned int aSamples)
+	{
+		unsigned int end = mSampleCount - mDecoded > aSamples ? mDecoded + aSamples : mSampleCount;
+		float tmp[512 * MAX_CHANNELS];
+		unsigned int i;
+		while (mDecoded < end)
+		{
+			unsigned int blockSize = (end - mDecoded) > 512 ? 512 : end - mDecoded;
+			unsigned int n = 0;
+			if (mFormat == WAV_DECODE_OGG)
+			{
+				float *outputs[MAX_CHANNELS];
+				for (i = 0; i < mChannels; i++)
+					outputs[i] = mData + mDecoded + mSampleCount * i;
+				int r = stb_vorbis_get_samples_float(mVorbis, mChannels, outputs, blockSize);
+				n = r > 0 ? (unsigned int)r : 0;
+			}
+			else
+			{
+				if (mFormat == WAV_DECODE_MP3)
+					n = (unsigned int)drmp3_read_pcm_frames_f32(&mMp3, blockSize, tmp);
+				else if (mFormat == WAV_DECODE_FLAC)
+					n = (unsigned int)drflac_read_pcm_frames_f32(mFlac, blockSize, tmp);
+				else
+					n = (unsigned int)drwav_read_pcm_frames_f32(&mWav, blockSize, tmp);
+				if (n > blockSize)
+					n = blockSize;
+				deinterlace_samples(tmp, SAMPLE_FLOAT32, mChannels, mData + mDecoded, mSampleCount, n, mChannels);
+			}
+
+			if (n == 0)
+			{
+				// Stream ended short of its stated length; the rest stays silent
+				for (i = 0; i < mChannels; i++)
+					memset(mData + mDecoded + mSampleCount * i, 0, sizeof(float) * (mSampleCount - mDecoded));
+				mDecoded = mSampleCount;
+				break;
+			}
+			mDecoded += n;
+		}
+
+		Thread::atomicStore(&mParent->mDecodedSampleCount, mDecoded);
+		return mDecoded < mSampleCount;
+	}
+
+	static void progressiveDecodeThread(void *aParam)
+	{
+		WavProgressiveDecoder *decoder = (WavProgressiveDecoder *)aParam;
+		while (!Thread::atomicLoad(&decoder->mCancel) && decoder->decode(WAV_PROGRESSIVE_CHUNK_SAMPLES))
+		{
+		}
+	}
+
 	WavInstance::WavInstance(Wav *aParent)
 	{
 		mParent = aParent;
@@ -51,13 +368,23 @@ namespace SoLoud
 		if (copylen > aSamplesToRead)
 			copylen = aSamplesToRead;
 
+		// A progressive load may not have got this far yet. The part that isn't there plays as
+		// silence and is picked up where it stopped, but copylen still counts it, so the voice
+		// doesn't take the gap for its end.
+		unsigned int decoded = Thread::atomicLoad(&mParent->mDecodedSampleCount);
+		unsigned int ready = decoded > mOffset ? decoded - mOffset : 0;
+		if (ready > copylen)
+			ready = copylen;
+
 		unsigned int i;
 		for (i = 0; i < mChannels; i++)
 		{
-			memcpy(aBuffer + i * aBufferSize, mParent->mData + mOffset + i * mParent->mSampleCount, sizeof(float) * copylen);
+			memcpy(aBuffer + i * aBufferSize, mParent->mData + mOffset + i * mParent->mSampleCount, sizeof(float) * ready);
+			if (ready < copylen)
+				memset(aBuffer + i * aBufferSize + ready, 0, sizeof(float) * (copylen - ready));
 		}
 
-		mOffset += copylen;
+		mOffset += ready;
 		return copylen;
 	}
 
@@ -68,6 +395,22 @@ namespace SoLoud
 		return 0;
 	}
 
+	result WavInstance::seek(time aSeconds, float * /*aScratch*/, unsigned int /*aScratchSize*/)
+	{
+		// All the data is in memory, so just move the offset to the nearest sample
+		double offset = floor(aSeconds * mBaseSamplerate + 0.5);
+		if (offset < 0)
+			offset = 0;
+		mOffset = offset < mParent->mSampleCount ? (unsigned int)offset : mParent->mSampleCount;
+		mStreamPosition = aSeconds;
+		return SO_NO_ERROR;
+	}
+
+	time WavInstance::getLength()
+	{
+		return mParent->getLength();
+	}
+
 	bool WavInstance::hasEnded()
 	{
 		if (!(mFlags & AudioSourceInstance::LOOPING) && mOffset >= mParent->mSampleCount)
@@ -77,16 +420,95 @@ namespace SoLoud
 		return 0;
 	}
 
+	const float *WavInstance::getDirectData(unsigned int *aSampleCount, unsigned int *aPosition)
+	{
+		*aSampleCount = mParent->mSampleCount;
+		*aPosition = mOffset;
+		// Mixed straight from mData only once all of it is there
+		if (Thread::atomicLoad(&mParent->mDecodedSampleCount) < mParent->mSampleCount)
+			return NULL;
+		return mParent->mData;
+	}
+
+	void WavInstance::skipDirectData(unsigned int aSamples)
+	{
+		mOffset += aSamples;
+	}
+
 	Wav::Wav()
 	{
 		mData = NULL;
 		mSampleCount = 0;
+		mCacheEntry = NULL;
+		mExternalData = false;
+		mDecodeThreadCount = 0;
+		mLoadSamplerate = 0;
+		mProgressiveLead = 0;
+		mDecodedSampleCount = 0;
+		mProgressiveDecoder = NULL;
 	}
 	
 	Wav::~Wav()
 	{
 		stop();
-		delete[] mData;
+		freeData_internal();
+	}
+
+	void Wav::freeData_internal()
+	{
+		endProgressiveLoad_internal(true);
+		mDecodedSampleCount = 0;
+		if (mCacheEntry)
+		{
+			SampleCacheEntry *e = mCacheEntry;
+			mCacheEntry = NULL;
+			// The cache holds a reference of its own while it lists the entry, so this
+			// only frees entries whose cache is gone
+			if (Thread::atomicAdd(&e->mRefCount, -1) == 0)
+				delete e;
+		}
+		else if (!mExternalData)
+		{
+			delete[] mData;
+		}
+		mExternalData = false;
+		mData = NULL;
+	}
+
+	void Wav::endProgressiveLoad_internal(bool aCancel)
+	{
+		if (mProgressiveDecoder == NULL)
+			return;
+		if (aCancel)
+			Thread::atomicStore(&mProgressiveDecoder->mCancel, 1);
+		Thread::wait(mProgressiveDecoder->mThread);
+		Thread::release(mProgressiveDecoder->mThread);
+		delete mProgressiveDecoder;
+		mProgressiveDecoder = NULL;
+	}
+
+	void Wav::useCacheEntry_internal(SampleCacheEntry *aEntry)
+	{
+		stop();
+		freeData_internal();
+		mCacheEntry = aEntry;
+		mData = aEntry->mData;
+		mSampleCount = aEntry->mSampleCount;
+		mChannels = aEntry->mChannels;
+		mBaseSamplerate = aEntry->mBaseSamplerate;
+		mDecodedSampleCount = mSampleCount;
+	}
+
+	void Wav::useExternalData_internal(const float *aData, unsigned int aSampleCount, unsigned int aChannels, float aSamplerate)
+	{
+		stop();
+		freeData_internal();
+		mExternalData = true;
+		mData = aData;
+		mSampleCount = aSampleCount;
+		mChannels = aChannels;
+		mBaseSamplerate = aSamplerate;
+		mDecodedSampleCount = mSampleCount;
 	}
 
 #define MAKEDWORD(a,b,c,d) (((d) << 24) | ((c) << 16) | ((b) << 8) | (a))
@@ -108,24 +530,19 @@ namespace SoLoud
 			return FILE_LOAD_FAILED;
 		}
 
-		mData = new float[(unsigned int)(samples * decoder.channels)];
+		float *data = new float[(unsigned int)(samples * decoder.channels)];
+		mData = data;
 		mBaseSamplerate = (float)decoder.sampleRate;
 		mSampleCount = (unsigned int)samples;
 		mChannels = decoder.channels;
 
-		unsigned int i, j, k;
+		unsigned int i;
 		for (i = 0; i < mSampleCount; i += 512)
 		{
 			float tmp[512 * MAX_CHANNELS];
 			unsigned int blockSize = (mSampleCount - i) > 512 ? 512 : mSampleCount - i;
 			drwav_read_pcm_frames_f32(&decoder, blockSize, tmp);
-			for (j = 0; j < blockSize; j++)
-			{
-				for (k = 0; k < decoder.channels; k++)
-				{
-					mData[k * mSampleCount + i + j] = tmp[j * decoder.channels + k];
-				}
-			}
+			deinterlace_samples(tmp, SAMPLE_FLOAT32, decoder.channels, data + i, mSampleCount, blockSize, decoder.channels);
 		}
 		drwav_uninit(&decoder);
 
@@ -146,6 +563,7 @@ namespace SoLoud
         stb_vorbis_info info = stb_vorbis_get_info(vorbis);
 		mBaseSamplerate = (float)info.sample_rate;
         int samples = stb_vorbis_stream_length_in_samples(vorbis);
+        stb_vorbis_close(vorbis);
 
 		if (info.channels > MAX_CHANNELS)
 		{
@@ -155,25 +573,11 @@ namespace SoLoud
 		{
 			mChannels = info.channels;
 		}
-		mData = new float[samples * mChannels];
+		float *data = new float[samples * mChannels];
+		mData = data;
 		mSampleCount = samples;
-		samples = 0;
-		while(1)
-		{
-			float **outputs;
-            int n = stb_vorbis_get_frame_float(vorbis, NULL, &outputs);
-			if (n == 0)
-            {
-				break;
-            }
-
-			unsigned int ch;
-			for (ch = 0; ch < mChannels; ch++)
-				memcpy(mData + samples + mSampleCount * ch, outputs[ch], sizeof(float) * n);
 
-			samples += n;
-		}
-        stb_vorbis_close(vorbis);
+		decodeSlices(aReader, data, WAV_DECODE_OGG, countDecodeSlices(), NULL, 0);
 
 		return 0;
 	}
@@ -195,28 +599,28 @@ namespace SoLoud
 			return FILE_LOAD_FAILED;
 		}
 
-		mData = new float[(unsigned int)(samples * decoder.channels)];
+		float *data = new float[(unsigned int)(samples * decoder.channels)];
+		mData = data;
 		mBaseSamplerate = (float)decoder.sampleRate;
 		mSampleCount = (unsigned int)samples;
 		mChannels = decoder.channels;
-		drmp3_seek_to_pcm_frame(&decoder, 0); 
 
-		unsigned int i, j, k;
-		for (i = 0; i<mSampleCount; i += 512)
+		// Without a seek table, each slice would have to find its start from the top of the file
+		unsigned int slices = countDecodeSlices();
+		drmp3_seek_point *seekpoint = NULL;
+		drmp3_uint32 seekpoints = 0;
+		if (slices > 1)
 		{
-			float tmp[512 * MAX_CHANNELS];
-			unsigned int blockSize = (mSampleCount - i) > 512 ? 512 : mSampleCount - i;
-			drmp3_read_pcm_frames_f32(&decoder, blockSize, tmp);
-			for (j = 0; j < blockSize; j++) 
-			{
-				for (k = 0; k < decoder.channels; k++) 
-				{
-					mData[k * mSampleCount + i + j] = tmp[j * decoder.channels + k];
-				}
-			}
+			seekpoints = (drmp3_uint32)(samples / decoder.sampleRate) + 1;
+			seekpoint = new drmp3_seek_point[seekpoints];
+			if (seekpoint == NULL || !drmp3_calculate_seek_points(&decoder, &seekpoints, seekpoint))
+				slices = 1;
 		}
 		drmp3_uninit(&decoder);
 
+		decodeSlices(aReader, data, WAV_DECODE_MP3, slices, slices > 1 ? seekpoint : NULL, seekpoints);
+		delete[] seekpoint;
+
 		return SO_NO_ERROR;
 	}
 
@@ -237,59 +641,254 @@ namespace SoLoud
 			return FILE_LOAD_FAILED;
 		}
 
-		mData = new float[(unsigned int)(samples * decoder->channels)];
+		float *data = new float[(unsigned int)(samples * decoder->channels)];
+		mData = data;
 		mBaseSamplerate = (float)decoder->sampleRate;
 		mSampleCount = (unsigned int)samples;
 		mChannels = decoder->channels;
-		drflac_seek_to_pcm_frame(decoder, 0);
+		drflac_close(decoder);
 
-		unsigned int i, j, k;
-		for (i = 0; i < mSampleCount; i += 512)
+		decodeSlices(aReader, data, WAV_DECODE_FLAC, countDecodeSlices(), NULL, 0);
+
+		return SO_NO_ERROR;
+	}
+
+	unsigned int Wav::countDecodeSlices()
+	{
+		unsigned int threads = mDecodeThreadCount;
+		if (threads == 0)
+			threads = (unsigned int)Thread::getCoreCount();
+		unsigned int slices = mSampleCount / WAV_DECODE_SLICE_MIN_SAMPLES;
+		if (slices > threads)
+			slices = threads;
+		if (slices > WAV_DECODE_MAX_SLICES)
+			slices = WAV_DECODE_MAX_SLICES;
+		if (slices < 1)
+			slices = 1;
+		return slices;
+	}
+
+	void Wav::decodeSlices(MemoryFile *aReader, float *aData, int aFormat, unsigned int aSlices, drmp3_seek_point *aMp3SeekPoint, unsigned int aMp3SeekPointCount)
+	{
+		WavDecodeTask task[WAV_DECODE_MAX_SLICES];
+		unsigned int i;
+		for (i = 0; i < aSlices; i++)
 		{
-			float tmp[512 * MAX_CHANNELS];
-			unsigned int blockSize = (mSampleCount - i) > 512 ? 512 : mSampleCount - i;
-			drflac_read_pcm_frames_f32(decoder, blockSize, tmp);
-			for (j = 0; j < blockSize; j++)
+			task[i].mFile = aReader->getMemPtr();
+			task[i].mFileLength = aReader->length();
+			task[i].mFormat = aFormat;
+			task[i].mData = aData;
+			task[i].mSampleCount = mSampleCount;
+			task[i].mChannels = mChannels;
+			// The stream is planar, so each slice writes its own part of every channel
+			task[i].mStart = (unsigned int)((unsigned long long)mSampleCount * i / aSlices);
+			task[i].mCount = (unsigned int)((unsigned long long)mSampleCount * (i + 1) / aSlices) - task[i].mStart;
+			task[i].mMp3SeekPoint = aMp3SeekPoint;
+			task[i].mMp3SeekPointCount = aMp3SeekPointCount;
+		}
+
+		if (aSlices == 1)
+		{
+			task[0].work();
+			return;
+		}
+
+		// The loading thread decodes too, while waiting
+		Thread::Pool *pool = getDecodePool();
+		if (pool)
+		{
+			Thread::PoolTaskGroup group;
+			for (i = 0; i < aSlices; i++)
+				pool->addWork(&task[i], &group);
+			pool->waitGroup(&group);
+		}
+		else
+		{
+			for (i = 0; i < aSlices; i++)
+				task[i].work();
+		}
+
+		// A decoder that couldn't seek to its slice leaves a gap; decode the whole file in one go instead
+		for (i = 0; i < aSlices; i++)
+		{
+			if (task[i].mFailed)
 			{
-				for (k = 0; k < decoder->channels; k++)
-				{
-					mData[k * mSampleCount + i + j] = tmp[j * decoder->channels + k];
-				}
+				task[0].mStart = 0;
+				task[0].mCount = mSampleCount;
+				task[0].work();
+				return;
 			}
 		}
-		drflac_close(decoder);
-
-		return SO_NO_ERROR;
 	}
 
     result Wav::testAndLoadFile(MemoryFile *aReader)
     {
-		delete[] mData;
-		mData = 0;
+		// The data can't be swapped for a converted copy while the decoder still writes to it,
+		// and converting afterwards would change it under the playing voices
+		if (mProgressiveLead > 0 && mLoadSamplerate > 0)
+			return INVALID_PARAMETER;
+		freeData_internal();
 		mSampleCount = 0;
 		mChannels = 1;
         int tag = aReader->read32();
+		result res = FILE_LOAD_FAILED;
 		if (tag == MAKEDWORD('O','g','g','S')) 
         {
-			return loadogg(aReader);
+			res = mProgressiveLead > 0 ? loadProgressive(aReader, WAV_DECODE_OGG) : loadogg(aReader);
 
 		} 
         else if (tag == MAKEDWORD('R','I','F','F')) 
         {
-			return loadwav(aReader);
+			res = mProgressiveLead > 0 ? loadProgressive(aReader, WAV_DECODE_WAV) : loadwav(aReader);
 		}
 		else if (tag == MAKEDWORD('f', 'L', 'a', 'C'))
 		{
-			return loadflac(aReader);
+			res = mProgressiveLead > 0 ? loadProgressive(aReader, WAV_DECODE_FLAC) : loadflac(aReader);
 		}
-		else if (loadmp3(aReader) == SO_NO_ERROR)
+		else
 		{
-			return SO_NO_ERROR;
+			res = mProgressiveLead > 0 ? loadProgressive(aReader, WAV_DECODE_MP3) : loadmp3(aReader);
 		}
 
-		return FILE_LOAD_FAILED;
+		if (res != SO_NO_ERROR)
+			return FILE_LOAD_FAILED;
+		if (mProgressiveDecoder == NULL)
+		{
+			resampleData();
+			Thread::atomicStore(&mDecodedSampleCount, mSampleCount);
+		}
+		return SO_NO_ERROR;
     }
 
+	result Wav::loadProgressive(MemoryFile *aReader, int aFormat)
+	{
+		WavProgressiveDecoder *decoder = new WavProgressiveDecoder;
+		if (decoder == NULL)
+			return OUT_OF_MEMORY;
+
+		// Take the file over if the reader owns it, as the caller's buffer is gone once load returns
+		if (aReader->mDataOwned)
+		{
+			decoder->mFile.openMem(aReader->mDataPtr, aReader->mDataLength, false, true);
+			aReader->mDataOwned = false;
+		}
+		else if (decoder->mFile.openMem(aReader->mDataPtr, aReader->mDataLength, true) != SO_NO_ERROR)
+		{
+			delete decoder;
+			return OUT_OF_MEMORY;
+		}
+
+		if (!decoder->open(aFormat))
+		{
+			delete decoder;
+			return FILE_LOAD_FAILED;
+		}
+
+		float *data = new float[decoder->mSampleCount * decoder->mChannels];
+		if (data == NULL)
+		{
+			delete decoder;
+			return OUT_OF_MEMORY;
+		}
+		mData = data;
+		mSampleCount = decoder->mSampleCount;
+		mChannels = decoder->mChannels;
+		mBaseSamplerate = decoder->mSamplerate;
+		decoder->mParent = this;
+		decoder->mData = data;
+
+		double lead = ceil(mProgressiveLead * mBaseSamplerate);
+		if (!decoder->decode(lead < mSampleCount ? (unsigned int)lead : mSampleCount))
+		{
+			// Short enough to be done already
+			delete decoder;
+			return SO_NO_ERROR;
+		}
+
+		decoder->mThread = Thread::createThread(progressiveDecodeThread, decoder);
+		if (decoder->mThread == NULL)
+		{
+			// No thread to be had; decode the rest here after all
+			decoder->decode(mSampleCount);
+			delete decoder;
+			return SO_NO_ERROR;
+		}
+		mProgressiveDecoder = decoder;
+		return SO_NO_ERROR;
+	}
+
+	void Wav::resampleData()
+	{
+		if (mLoadSamplerate <= 0 || mBaseSamplerate <= 0 || mLoadSamplerate == mBaseSamplerate || mData == NULL || mSampleCount == 0)
+			return;
+
+		// Source samples per converted sample
+		double ratio = (double)mBaseSamplerate / mLoadSamplerate;
+		double samplecount = floor(mSampleCount / ratio + 0.5);
+		if (samplecount < 1 || samplecount * mChannels > 0xffffffff)
+			return;
+		unsigned int count = (unsigned int)samplecount;
+		unsigned int tablesize = WAV_RESAMPLE_ZERO_CROSSINGS * WAV_RESAMPLE_TABLE_RESOLUTION;
+		float *data = new float[count * mChannels];
+		float *table = new float[tablesize + 2];
+		if (data == NULL || table == NULL)
+		{
+			// Keep the file's rate; the mixer resamples it as usual
+			delete[] data;
+			delete[] table;
+			return;
+		}
+
+		// Right half of a Blackman windowed sinc
+		unsigned int i, j;
+		for (i = 0; i <= tablesize; i++)
+		{
+			double x = (double)i / WAV_RESAMPLE_TABLE_RESOLUTION;
+			double sinc = i ? sin(M_PI * x) / (M_PI * x) : 1;
+			double window = 0.42 + 0.5 * cos(M_PI * x / WAV_RESAMPLE_ZERO_CROSSINGS) + 0.08 * cos(2 * M_PI * x / WAV_RESAMPLE_ZERO_CROSSINGS);
+			table[i] = (float)(sinc * window);
+		}
+		table[tablesize + 1] = 0;
+
+		// Going down in rate, the cutoff moves to the new Nyquist frequency and the kernel widens to match
+		double cutoff = (ratio > 1 ? 1 / ratio : 1) * WAV_RESAMPLE_PASSBAND;
+		double halfwidth = WAV_RESAMPLE_ZERO_CROSSINGS / cutoff;
+
+		for (j = 0; j < mChannels; j++)
+		{
+			const float *src = mData + mSampleCount * j;
+			float *dst = data + count * j;
+			for (i = 0; i < count; i++)
+			{
+				double pos = i * ratio;
+				int first = (int)ceil(pos - halfwidth);
+				int last = (int)floor(pos + halfwidth);
+				if (first < 0)
+					first = 0;
+				if (last >= (int)mSampleCount)
+					last = mSampleCount - 1;
+				float acc = 0;
+				int k;
+				for (k = first; k <= last; k++)
+				{
+					double x = fabs(pos - k) * cutoff * WAV_RESAMPLE_TABLE_RESOLUTION;
+					unsigned int idx = (unsigned int)x;
+					if (idx >= tablesize)
+						continue;
+					float f = (float)(x - idx);
+					acc += src[k] * (table[idx] + (table[idx + 1] - table[idx]) * f);
+				}
+				dst[i] = acc * (float)cutoff;
+			}
+		}
+		delete[] table;
+
+		delete[] mData;
+		mData = data;
+		mSampleCount = count;
+		mBaseSamplerate = mLoadSamplerate;
+	}
+
 	result Wav::load(const char *aFilename)
 	{
 		if (aFilename == 0)
@@ -346,14 +945,16 @@ namespace SoLoud
 		if (aMem == 0 || aLength == 0 || aSamplerate <= 0 || aChannels < 1)
 			return INVALID_PARAMETER;
 		stop();
-		delete[] mData;
-		mData = new float[aLength];	
+		freeData_internal();
+		float *data = new float[aLength];
+		mData = data;
 		mSampleCount = aLength / aChannels;
 		mChannels = aChannels;
 		mBaseSamplerate = aSamplerate;
 		unsigned int i;
 		for (i = 0; i < aLength; i++)
-			mData[i] = ((signed)aMem[i] - 128) / (float)0x80;
+			data[i] = ((signed)aMem[i] - 128) / (float)0x80;
+		mDecodedSampleCount = mSampleCount;
 		return SO_NO_ERROR;
 	}
 
@@ -362,14 +963,14 @@ namespace SoLoud
 		if (aMem == 0 || aLength == 0 || aSamplerate <= 0 || aChannels < 1)
 			return INVALID_PARAMETER;
 		stop();
-		delete[] mData;
-		mData = new float[aLength];
+		freeData_internal();
+		float *data = new float[aLength];
+		mData = data;
 		mSampleCount = aLength / aChannels;
 		mChannels = aChannels;
 		mBaseSamplerate = aSamplerate;
-		unsigned int i;
-		for (i = 0; i < aLength; i++)
-			mData[i] = ((signed short)aMem[i]) / (float)0x8000;
+		convert_samples(aMem, SAMPLE_S16, data, SAMPLE_FLOAT32, aLength);
+		mDecodedSampleCount = mSampleCount;
 		return SO_NO_ERROR;
 	}
 
@@ -378,11 +979,12 @@ namespace SoLoud
 		if (aMem == 0 || aLength == 0 || aSamplerate <= 0 || aChannels < 1)
 			return INVALID_PARAMETER;
 		stop();
-		delete[] mData;
+		freeData_internal();
 		if (aCopy == true || aTakeOwndership == false)
 		{
-			mData = new float[aLength];
-			memcpy(mData, aMem, sizeof(float) * aLength);
+			float *data = new float[aLength];
+			memcpy(data, aMem, sizeof(float) * aLength);
+			mData = data;
 		}
 		else
 		{
@@ -391,6 +993,35 @@ namespace SoLoud
 		mSampleCount = aLength / aChannels;
 		mChannels = aChannels;
 		mBaseSamplerate = aSamplerate;
+		mDecodedSampleCount = mSampleCount;
 		return SO_NO_ERROR;
 	}
+
+	void Wav::setDecodeThreadCount(unsigned int aThreads)
+	{
+		mDecodeThreadCount = aThreads;
+	}
+
+	result Wav::setLoadSamplerate(float aSamplerate)
+	{
+		if (aSamplerate < 0)
+			return INVALID_PARAMETER;
+		mLoadSamplerate = aSamplerate;
+		return SO_NO_ERROR;
+	}
+
+	result Wav::setProgressiveLoad(float aLeadTime)
+	{
+		if (aLeadTime < 0)
+			return INVALID_PARAMETER;
+		mProgressiveLead = aLeadTime;
+		return SO_NO_ERROR;
+	}
+
+	time Wav::getDecodedLength()
+	{
+		if (mBaseSamplerate == 0)
+			return 0;
+		return Thread::atomicLoad(&mDecodedSampleCount) / mBaseSamplerate;
+	}
 };
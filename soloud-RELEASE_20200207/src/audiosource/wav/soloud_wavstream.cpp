@@ -25,12 +25,15 @@ freely, subject to the following restrictions:
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include "soloud.h"
 #include "dr_flac.h"
 #include "dr_mp3.h"
 #include "dr_wav.h"
 #include "soloud_wavstream.h"
 #include "soloud_file.h"
+#include "soloud_convert.h"
+#include "soloud_thread.h"
 #include "stb_vorbis.h"
 
 namespace SoLoud
@@ -87,6 +90,18 @@ namespace SoLoud
 		mCodec.mOgg = 0;
 		mCodec.mFlac = 0;
 		mFile = 0;
+		mOggFrameSize = 0;
+		mOggFrameOffset = 0;
+		mOggOutputs = 0;
+		mDecoderGeneration = aParent->mDecoderGeneration;
+
+		// Reuse the decoder of an instance that has finished, if any, instead of parsing the headers again
+		if (aParent->unparkDecoder_internal(&mFile, &mCodec))
+		{
+			rewind();
+			return;
+		}
+
 		if (aParent->mMemFile)
 		{
 			MemoryFile *mf = new MemoryFile();
@@ -138,9 +153,6 @@ namespace SoLoud
 						delete mFile;
 					mFile = 0;
 				}
-				mOggFrameSize = 0;
-				mOggFrameOffset = 0;
-				mOggOutputs = 0;
 			}
 			else
 			if (mParent->mFiletype == WAVSTREAM_FLAC)
@@ -165,6 +177,11 @@ namespace SoLoud
 						delete mFile;
 					mFile = 0;
 				}
+				else
+				if (mParent->mMp3SeekPoint)
+				{
+					drmp3_bind_seek_table(mCodec.mMp3, mParent->mMp3SeekPointCount, mParent->mMp3SeekPoint);
+				}
 			}
 			else
 			{
@@ -178,41 +195,9 @@ namespace SoLoud
 
 	WavStreamInstance::~WavStreamInstance()
 	{
-		switch (mParent->mFiletype)
-		{
-		case WAVSTREAM_OGG:
-			if (mCodec.mOgg)
-			{
-				stb_vorbis_close(mCodec.mOgg);
-			}
-			break;
-		case WAVSTREAM_FLAC:
-			if (mCodec.mFlac)
-			{
-				drflac_close(mCodec.mFlac);
-			}
-			break;
-		case WAVSTREAM_MP3:
-			if (mCodec.mMp3)
-			{
-				drmp3_uninit(mCodec.mMp3);
-				delete mCodec.mMp3;
-				mCodec.mMp3 = 0;
-			}
-			break;
-		case WAVSTREAM_WAV:
-			if (mCodec.mWav)
-			{
-				drwav_uninit(mCodec.mWav);
-				delete mCodec.mWav;
-				mCodec.mWav = 0;
-			}
-			break;
-		}
-		if (mFile != mParent->mStreamFile)
-		{
-			delete mFile;
-		}
+		if (mFile && mParent->parkDecoder_internal(mDecoderGeneration, mFile, mCodec))
+			return;
+		mParent->closeDecoder_internal(mFile, mCodec);
 	}
 
 	static int getOggData(float **aOggOutputs, float *aBuffer, int aSamples, int aPitch, int aFrameSize, int aFrameOffset, int aChannels)
@@ -245,21 +230,14 @@ namespace SoLoud
 		{
 		case WAVSTREAM_FLAC:
 			{
-				unsigned int i, j, k;
+				unsigned int i;
 
 				for (i = 0; i < aSamplesToRead; i += 512)
 				{
 					float tmp[512 * MAX_CHANNELS];
 					unsigned int blockSize = (aSamplesToRead - i) > 512 ? 512 : aSamplesToRead - i;
 					offset += (unsigned int)drflac_read_pcm_frames_f32(mCodec.mFlac, blockSize, tmp);
-
-					for (j = 0; j < blockSize; j++)
-					{
-						for (k = 0; k < mChannels; k++)
-						{
-							aBuffer[k * aSamplesToRead + i + j] = tmp[j * mCodec.mFlac->channels + k];
-						}
-					}
+					deinterlace_samples(tmp, SAMPLE_FLOAT32, mCodec.mFlac->channels, aBuffer + i, aSamplesToRead, blockSize, mChannels);
 				}
 				mOffset += offset;
 				return offset;
@@ -267,21 +245,14 @@ namespace SoLoud
 			break;
 		case WAVSTREAM_MP3:
 			{
-				unsigned int i, j, k;
+				unsigned int i;
 
 				for (i = 0; i < aSamplesToRead; i += 512)
 				{
 					float tmp[512 * MAX_CHANNELS];
 					unsigned int blockSize = (aSamplesToRead - i) > 512 ? 512 : aSamplesToRead - i;
 					offset += (unsigned int)drmp3_read_pcm_frames_f32(mCodec.mMp3, blockSize, tmp);
-
-					for (j = 0; j < blockSize; j++)
-					{
-						for (k = 0; k < mChannels; k++)
-						{
-							aBuffer[k * aSamplesToRead + i + j] = tmp[j * mCodec.mMp3->channels + k];
-						}
-					}
+					deinterlace_samples(tmp, SAMPLE_FLOAT32, mCodec.mMp3->channels, aBuffer + i, aSamplesToRead, blockSize, mChannels);
 				}
 				mOffset += offset;
 				return offset;
@@ -316,21 +287,14 @@ namespace SoLoud
 			break;
 		case WAVSTREAM_WAV:
 			{
-				unsigned int i, j, k;
+				unsigned int i;
 
 				for (i = 0; i < aSamplesToRead; i += 512)
 				{
 					float tmp[512 * MAX_CHANNELS];
 					unsigned int blockSize = (aSamplesToRead - i) > 512 ? 512 : aSamplesToRead - i;
 					offset += (unsigned int)drwav_read_pcm_frames_f32(mCodec.mWav, blockSize, tmp);
-
-					for (j = 0; j < blockSize; j++)
-					{
-						for (k = 0; k < mChannels; k++)
-						{
-							aBuffer[k * aSamplesToRead + i + j] = tmp[j * mCodec.mWav->channels + k];
-						}
-					}
+					deinterlace_samples(tmp, SAMPLE_FLOAT32, mCodec.mWav->channels, aBuffer + i, aSamplesToRead, blockSize, mChannels);
 				}
 				mOffset += offset;
 				return offset;
@@ -374,6 +338,60 @@ namespace SoLoud
 		return 0;
 	}
 
+	result WavStreamInstance::seek(time aSeconds, float *mScratch, unsigned int mScratchSize)
+	{
+		if (mFile == NULL)
+			return AudioSourceInstance::seek(aSeconds, mScratch, mScratchSize);
+
+		double offset = floor(aSeconds * mBaseSamplerate + 0.5);
+		if (offset < 0)
+			offset = 0;
+		unsigned int frame = offset < mParent->mSampleCount ? (unsigned int)offset : mParent->mSampleCount;
+
+		// Past the end there's nothing to decode
+		if (frame < mParent->mSampleCount)
+		{
+			int ok = 0;
+			switch (mParent->mFiletype)
+			{
+			case WAVSTREAM_OGG:
+				// Seek to the frame containing the sample, and skip to it within the frame
+				if (stb_vorbis_seek_frame(mCodec.mOgg, frame))
+				{
+					int start = stb_vorbis_get_sample_offset(mCodec.mOgg);
+					mOggFrameSize = stb_vorbis_get_frame_float(mCodec.mOgg, NULL, &mOggOutputs);
+					mOggFrameOffset = 0;
+					if (start >= 0 && frame > (unsigned int)start)
+						mOggFrameOffset = frame - start;
+					ok = 1;
+				}
+				break;
+			case WAVSTREAM_FLAC:
+				ok = drflac_seek_to_pcm_frame(mCodec.mFlac, frame);
+				break;
+			case WAVSTREAM_MP3:
+				ok = drmp3_seek_to_pcm_frame(mCodec.mMp3, frame);
+				break;
+			case WAVSTREAM_WAV:
+				ok = drwav_seek_to_pcm_frame(mCodec.mWav, frame);
+				break;
+			}
+			if (!ok)
+				return AudioSourceInstance::seek(aSeconds, mScratch, mScratchSize);
+		}
+
+		mOffset = frame;
+		mStreamPosition = aSeconds;
+		return SO_NO_ERROR;
+	}
+
+	time WavStreamInstance::getLength()
+	{
+		if (mFile == NULL)
+			return 0;
+		return mParent->getLength();
+	}
+
 	bool WavStreamInstance::hasEnded()
 	{
 		if (mOffset >= mParent->mSampleCount)
@@ -390,14 +408,104 @@ namespace SoLoud
 		mFiletype = WAVSTREAM_WAV;
 		mMemFile = 0;
 		mStreamFile = 0;
+		mMp3SeekPoint = 0;
+		mMp3SeekPointCount = 0;
+		mParkedCount = 0;
+		mParkMutex = Thread::createMutex();
+		mDecoderGeneration = 0;
 	}
 	
 	WavStream::~WavStream()
 	{
 		stop();
+		resetDecoders_internal();
+		Thread::destroyMutex(mParkMutex);
 		delete[] mFilename;
 		delete mMemFile;
 	}
+
+	bool WavStream::parkDecoder_internal(unsigned int aGeneration, File *aFile, WavStreamCodec aCodec)
+	{
+		bool parked = false;
+		Thread::lockMutex(mParkMutex);
+		if (aGeneration == mDecoderGeneration && mParkedCount < WAVSTREAM_MAX_PARKED_DECODERS)
+		{
+			mParkedFile[mParkedCount] = aFile;
+			mParkedCodec[mParkedCount] = aCodec;
+			mParkedCount++;
+			parked = true;
+		}
+		Thread::unlockMutex(mParkMutex);
+		return parked;
+	}
+
+	bool WavStream::unparkDecoder_internal(File **aFile, WavStreamCodec *aCodec)
+	{
+		bool unparked = false;
+		Thread::lockMutex(mParkMutex);
+		if (mParkedCount > 0)
+		{
+			mParkedCount--;
+			*aFile = mParkedFile[mParkedCount];
+			*aCodec = mParkedCodec[mParkedCount];
+			unparked = true;
+		}
+		Thread::unlockMutex(mParkMutex);
+		return unparked;
+	}
+
+	void WavStream::closeDecoder_internal(File *aFile, WavStreamCodec aCodec)
+	{
+		switch (mFiletype)
+		{
+		case WAVSTREAM_OGG:
+			if (aCodec.mOgg)
+			{
+				stb_vorbis_close(aCodec.mOgg);
+			}
+			break;
+		case WAVSTREAM_FLAC:
+			if (aCodec.mFlac)
+			{
+				drflac_close(aCodec.mFlac);
+			}
+			break;
+		case WAVSTREAM_MP3:
+			if (aCodec.mMp3)
+			{
+				drmp3_uninit(aCodec.mMp3);
+				delete aCodec.mMp3;
+			}
+			break;
+		case WAVSTREAM_WAV:
+			if (aCodec.mWav)
+			{
+				drwav_uninit(aCodec.mWav);
+				delete aCodec.mWav;
+			}
+			break;
+		}
+		if (aFile != mStreamFile)
+		{
+			delete aFile;
+		}
+	}
+
+	void WavStream::resetDecoders_internal()
+	{
+		Thread::lockMutex(mParkMutex);
+		unsigned int i;
+		for (i = 0; i < mParkedCount; i++)
+		{
+			closeDecoder_internal(mParkedFile[i], mParkedCodec[i]);
+		}
+		mParkedCount = 0;
+		mDecoderGeneration++;
+		Thread::unlockMutex(mParkMutex);
+		delete[] mMp3SeekPoint;
+		mMp3SeekPoint = 0;
+		mMp3SeekPointCount = 0;
+	}
 	
 #define MAKEDWORD(a,b,c,d) (((d) << 24) | ((c) << 16) | ((b) << 8) | (a))
 
@@ -488,6 +596,19 @@ namespace SoLoud
 		mBaseSamplerate = (float)decoder.sampleRate;
 		mSampleCount = (unsigned int)samples;
 		mFiletype = WAVSTREAM_MP3;
+
+		// One seek point per second; without them, every seek decodes the frame headers from the start of the file
+		drmp3_uint32 count = (drmp3_uint32)(samples / decoder.sampleRate) + 1;
+		mMp3SeekPoint = new drmp3_seek_point[count];
+		if (drmp3_calculate_seek_points(&decoder, &count, mMp3SeekPoint))
+		{
+			mMp3SeekPointCount = count;
+		}
+		else
+		{
+			delete[] mMp3SeekPoint;
+			mMp3SeekPoint = 0;
+		}
 		drmp3_uninit(&decoder);
 
 		return SO_NO_ERROR;
@@ -495,6 +616,8 @@ namespace SoLoud
 
 	result WavStream::load(const char *aFilename)
 	{
+		stop();
+		resetDecoders_internal();
 		delete[] mFilename;
 		delete mMemFile;
 		mMemFile = 0;
@@ -524,6 +647,8 @@ namespace SoLoud
 
 	result WavStream::loadMem(const unsigned char *aData, unsigned int aDataLen, bool aCopy, bool aTakeOwnership)
 	{
+		stop();
+		resetDecoders_internal();
 		delete[] mFilename;
 		delete mMemFile;
 		mStreamFile = 0;
@@ -568,6 +693,8 @@ namespace SoLoud
 
 	result WavStream::loadFile(File *aFile)
 	{
+		stop();
+		resetDecoders_internal();
 		delete[] mFilename;
 		delete mMemFile;
 		mStreamFile = 0;
@@ -589,6 +716,8 @@ namespace SoLoud
 
 	result WavStream::loadFileToMem(File *aFile)
 	{
+		stop();
+		resetDecoders_internal();
 		delete[] mFilename;
 		delete mMemFile;
 		mStreamFile = 0;
@@ -48,7 +48,6 @@ namespace SoLoud
 {
     struct ALSAData
     {
-        float *buffer;
         short *sampleBuffer;
         snd_pcm_t *alsaDeviceHandle;
         Soloud *soloud;
@@ -63,14 +62,10 @@ namespace SoLoud
     {
         
         ALSAData *data = static_cast<ALSAData*>(aParam);
+        data->soloud->applyAudioThreadScheduling_internal();
         while (!data->audioProcessingDone) 
         {            
-            data->soloud->mix(data->buffer, data->samples);            
-            for (int i=0;i<data->samples*data->channels;++i)
-            {
-                data->sampleBuffer[i] = static_cast<short>(floor(data->buffer[i] 
-                                                          * static_cast<float>(0x7fff)));
-            }
+            data->soloud->mixSigned16(data->sampleBuffer, data->samples);
             if (snd_pcm_writei(data->alsaDeviceHandle, data->sampleBuffer, data->samples) == -EPIPE)
                 snd_pcm_prepare(data->alsaDeviceHandle);
                 
@@ -97,10 +92,6 @@ namespace SoLoud
         {
             delete[] data->sampleBuffer;
         }
-        if (0 != data->buffer)
-        {
-            delete[] data->buffer;
-        }
         delete data;
         aSoloud->mBackendData = 0;
     }
@@ -153,7 +144,6 @@ namespace SoLoud
         snd_pcm_hw_params_get_channels(params, &val);
         data->channels = val;
 
-        data->buffer = new float[data->samples*data->channels];
         data->sampleBuffer = new short[data->samples*data->channels];
         aSoloud->postinit_internal(aSamplerate, data->samples * data->channels, aFlags, 2);
         data->threadHandle = Thread::createThread(alsaThread, data);
@@ -61,6 +61,7 @@ namespace SoLoud
     static void nosoundThread(LPVOID aParam)
     {
         SoLoudNosoundData *data = static_cast<SoLoudNosoundData*>(aParam);
+        data->mSoloud->applyAudioThreadScheduling_internal();
 		int delay = (1000 * data->mSamples) / data->mSamplerate;
 		int overflow = 0;
         while (data->mRunning) 
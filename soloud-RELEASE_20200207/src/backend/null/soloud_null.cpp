@@ -44,7 +44,7 @@ namespace SoLoud
 
     result null_init(Soloud *aSoloud, unsigned int aFlags, unsigned int aSamplerate, unsigned int aBuffer, unsigned int aChannels)
     {
-		if (aChannels == 0 || aChannels == 3 || aChannels == 5 || aChannels == 7 || aChannels > MAX_CHANNELS || aBuffer < SAMPLE_GRANULARITY)
+		if (aChannels == 0 || aChannels == 3 || aChannels == 5 || aChannels == 7 || aChannels > MAX_CHANNELS || aBuffer < aSoloud->mGranularity)
 			return INVALID_PARAMETER;
         aSoloud->mBackendData = 0;
         aSoloud->mBackendCleanupFunc = nullCleanup;
@@ -55,7 +55,6 @@ namespace SoLoud
 
     struct OSSData
     {
-        float *buffer;
         short *sampleBuffer;
         int ossDeviceHandle;
         Soloud *soloud;
@@ -68,14 +67,10 @@ namespace SoLoud
     static void ossThread(void *aParam)
     {
         OSSData *data = static_cast<OSSData*>(aParam);
+        data->soloud->applyAudioThreadScheduling_internal();
         while (!data->audioProcessingDone) 
         {
-            data->soloud->mix(data->buffer, data->samples);
-            for (int i=0;i<data->samples*data->channels;++i)
-            {
-                data->sampleBuffer[i] = static_cast<short>(floor(data->buffer[i] 
-                                                                 * static_cast<float>(0x7fff)));
-            }
+            data->soloud->mixSigned16(data->sampleBuffer, data->samples);
             write(data->ossDeviceHandle, data->sampleBuffer, 
                   sizeof(short)*data->samples*data->channels);
         }
@@ -99,10 +94,6 @@ namespace SoLoud
         {
             delete[] data->sampleBuffer;
         }
-        if (0 != data->buffer)
-        {
-            delete[] data->buffer;
-        }
         close(data->ossDeviceHandle);
         delete data;
         aSoloud->mBackendData = 0;
@@ -164,7 +155,6 @@ namespace SoLoud
         {
             return UNKNOWN_ERROR;
         }
-        data->buffer = new float[data->samples*data->channels];
         data->sampleBuffer = new short[data->samples*data->channels];
         aSoloud->postinit_internal(aSamplerate, data->samples * data->channels, aFlags, 2);
         data->threadHandle = Thread::createThread(ossThread, data);
@@ -29,6 +29,8 @@ freely, subject to the following restrictions:
 #include "soloud_internal.h"
 #include "soloud_thread.h"
 #include "soloud_fft.h"
+#include "soloud_simd.h"
+#include "soloud_convert.h"
 
 
 #ifdef SOLOUD_SSE_INTRINSICS
@@ -124,9 +126,13 @@ namespace SoLoud
 		mBackendID = 0;
 		mActiveVoiceDirty = true;
 		mActiveVoiceCount = 0;
+		mScheduleSample = 0;
+		mScheduleId = 1;
+		mSimdLevel = SIMD_SCALAR;
+		mSimd = getSimdKernels(SIMD_SCALAR);
+		mDitherSeed = 1;
+		mGranularity = SAMPLE_GRANULARITY;
 		int i;
-		for (i = 0; i < VOICE_COUNT; i++)
-			mActiveVoice[i] = 0;
 		for (i = 0; i < FILTERS_PER_STREAM; i++)
 		{
 			mFilter[i] = NULL;
@@ -142,10 +148,6 @@ namespace SoLoud
 		{
 			mVisualizationChannelVolume[i] = 0;
 		}
-		for (i = 0; i < VOICE_COUNT; i++)
-		{
-			mVoice[i] = 0;
-		}
 		mVoiceGroup = 0;
 		mVoiceGroupCount = 0;
 
@@ -163,11 +165,52 @@ namespace SoLoud
 		m3dVelocity[2] = 0;		
 		m3dSoundSpeed = 343.3f;
 		mMaxActiveVoices = 16;
+		mAudibilityThreshold = 0.001f;
+		mGovernorBudget = 0.7f;
+		mGovernorLoad = 0;
+		mGovernorLevel = GOVERNOR_FULL;
+		mGovernorCooldown = 0;
+		mGovernorCalm = 0;
+		mGovernorDegradedVoices = 0;
+		mAudioThreadPolicy = SCHEDULE_NORMAL;
+		mAudioThreadPriority = 0;
+		mAudioThreadCoreMask = 0;
+		mAppliedAudioThreadPolicy = SCHEDULE_NORMAL;
+		mAppliedAudioThreadCoreMask = 0;
+		mAudioMutexInherits = false;
+		mMixAheadBlocks = 0;
+		mMixAheadBlockSize = 0;
+		mMixAheadRingBlockSize = 0;
+		mMixAheadWritten = 0;
+		mMixAheadRead = 0;
+		mMixAheadWriteBlock = 0;
+		mMixAheadReadBlock = 0;
+		mMixAheadReadOffset = 0;
+		mMixAheadUnderruns = 0;
+		mMixAheadThread = NULL;
+		mMixAheadRunning = 0;
+		mMixAheadMutex = NULL;
+		mMixAheadCondition = NULL;
+		mRetired = NULL;
 		mHighestVoice = 0;
 		mResampleData = NULL;
 		mResampleDataOwner = NULL;
+		mResampleDataLive = NULL;
 		for (i = 0; i < 3 * MAX_CHANNELS; i++)
 			m3dSpeakerPosition[i] = 0;
+		mVoiceCapacity = 0;
+		mVoice = NULL;
+		m3dData = NULL;
+		m3dVoiceList = NULL;
+		mActiveVoice = NULL;
+		mBusVoiceStart = NULL;
+		mBusVoiceKeys = 0;
+		mActiveVoiceSort = NULL;
+		mVoiceSyncTime = NULL;
+		mFaderVoice = NULL;
+		mFaderVoiceCount = 0;
+		mFaderVoiceListed = NULL;
+		setVoiceCapacity(VOICE_COUNT);
 	}
 
 	Soloud::~Soloud()
@@ -185,6 +228,16 @@ namespace SoLoud
 		delete[] mVoiceGroup;
 		delete[] mResampleData;
 		delete[] mResampleDataOwner;
+		delete[] mResampleDataLive;
+		delete[] mVoice;
+		delete[] m3dData;
+		delete[] m3dVoiceList;
+		delete[] mActiveVoice;
+		delete[] mBusVoiceStart;
+		delete[] mActiveVoiceSort;
+		delete[] mVoiceSyncTime;
+		delete[] mFaderVoice;
+		delete[] mFaderVoiceListed;
 	}
 
 	void Soloud::deinit()
@@ -194,19 +247,43 @@ namespace SoLoud
 		if (mBackendCleanupFunc)
 			mBackendCleanupFunc(this);
 		mBackendCleanupFunc = 0;
+		stopMixAhead_internal();
+		// Nothing mixes anymore, so voices that ended in the last blocks can go too
+		destroyRetiredVoices();
 		if (mAudioThreadMutex)
 			Thread::destroyMutex(mAudioThreadMutex);
 		mAudioThreadMutex = NULL;
 	}
 
-	result Soloud::init(unsigned int aFlags, unsigned int aBackend, unsigned int aSamplerate, unsigned int aBufferSize, unsigned int aChannels)
+	result Soloud::init(unsigned int aFlags, unsigned int aBackend, unsigned int aSamplerate, unsigned int aBufferSize, unsigned int aChannels, unsigned int aGranularity)
 	{		
 		if (aBackend >= BACKEND_MAX || aChannels == 3 || aChannels == 5 || aChannels == 7 || aChannels > MAX_CHANNELS)
 			return INVALID_PARAMETER;
 
+		if (aGranularity == Soloud::AUTO)
+			aGranularity = SAMPLE_GRANULARITY;
+		// Power of two, so that the channel blocks in the resample buffers stay aligned
+		if (aGranularity < SAMPLE_GRANULARITY_MIN || aGranularity > SAMPLE_GRANULARITY || (aGranularity & (aGranularity - 1)))
+			return INVALID_PARAMETER;
+
 		deinit();
 
-		mAudioThreadMutex = Thread::createMutex();
+		// Backends' init functions call postinit_internal, which sizes the resample buffers with this
+		mGranularity = aGranularity;
+
+		mSimdLevel = detectSimdLevel();
+		mSimd = getSimdKernels(mSimdLevel);
+
+		// A real-time mixing thread waiting for the mutex lends its priority to the holder,
+		// so that a normal thread can't be preempted while the mixer waits for it
+		mAudioThreadMutex = NULL;
+		if (mAudioThreadPolicy != SCHEDULE_NORMAL)
+			mAudioThreadMutex = Thread::createPriorityInheritanceMutex();
+		mAudioMutexInherits = mAudioThreadMutex != NULL;
+		if (mAudioThreadMutex == NULL)
+			mAudioThreadMutex = Thread::createMutex();
+		mAppliedAudioThreadPolicy = SCHEDULE_NORMAL;
+		mAppliedAudioThreadCoreMask = 0;
 
 		mBackendID = 0;
 		mBackendString = 0;
@@ -573,16 +650,20 @@ namespace SoLoud
 		mSamplerate = aSamplerate;
 		mBufferSize = aBufferSize;
 		mScratchSize = aBufferSize;
-		if (mScratchSize < SAMPLE_GRANULARITY * 2) mScratchSize = SAMPLE_GRANULARITY * 2;
+		if (mScratchSize < mGranularity * 2) mScratchSize = mGranularity * 2;
 		if (mScratchSize < 4096) mScratchSize = 4096;
 		mScratchNeeded = mScratchSize;
 		mScratch.init(mScratchSize * MAX_CHANNELS);
 		mOutputScratch.init(mScratchSize * MAX_CHANNELS);
+		delete[] mResampleData;
+		delete[] mResampleDataOwner;
+		delete[] mResampleDataLive;
 		mResampleData = new AlignedFloatBuffer[mMaxActiveVoices * 2];
 		mResampleDataOwner = new AudioSourceInstance*[mMaxActiveVoices];
+		mResampleDataLive = new unsigned char[mMaxActiveVoices];
 		unsigned int i;
 		for (i = 0; i < mMaxActiveVoices * 2; i++)
-			mResampleData[i].init(SAMPLE_GRANULARITY * MAX_CHANNELS);
+			mResampleData[i].init(mGranularity * MAX_CHANNELS);
 		for (i = 0; i < mMaxActiveVoices; i++)
 			mResampleDataOwner[i] = NULL;
 		mFlags = aFlags;
@@ -678,6 +759,12 @@ namespace SoLoud
 			m3dSpeakerPosition[7 * 3 + 2] = -1;
 			break;
 		}
+
+		if (mMixAheadBlocks)
+		{
+			// If the thread can't be started, the back-end mixes directly
+			startMixAhead_internal();
+		}
 	}
 
 	const char * Soloud::getErrorString(result aErrorCode) const
@@ -745,226 +832,22 @@ namespace SoLoud
 		return mFFTData;
 	}
 
-#if defined(SOLOUD_SSE_INTRINSICS)
-	void Soloud::clip_internal(AlignedFloatBuffer &aBuffer, AlignedFloatBuffer &aDestBuffer, unsigned int aSamples, float aVolume0, float aVolume1)
-	{
-		float vd = (aVolume1 - aVolume0) / aSamples;
-		float v = aVolume0;
-		unsigned int i, j, c, d;
-		unsigned int samplequads = (aSamples + 3) / 4; // rounded up
-
-		// Clip
-		if (mFlags & CLIP_ROUNDOFF)
-		{
-			float nb = -1.65f;		__m128 negbound = _mm_load_ps1(&nb);
-			float pb = 1.65f;		__m128 posbound = _mm_load_ps1(&pb);
-			float ls = 0.87f;		__m128 linearscale = _mm_load_ps1(&ls);
-			float cs = -0.1f;		__m128 cubicscale = _mm_load_ps1(&cs);
-			float nw = -0.9862875f;	__m128 negwall = _mm_load_ps1(&nw);
-			float pw = 0.9862875f;	__m128 poswall = _mm_load_ps1(&pw);
-			__m128 postscale = _mm_load_ps1(&mPostClipScaler);
-			TinyAlignedFloatBuffer volumes;
-			volumes.mData[0] = v;
-			volumes.mData[1] = v + vd;
-			volumes.mData[2] = v + vd + vd;
-			volumes.mData[3] = v + vd + vd + vd;
-			vd *= 4;
-			__m128 vdelta = _mm_load_ps1(&vd);
-			c = 0;
-			d = 0;
-			for (j = 0; j < mChannels; j++)
-			{
-				__m128 vol = _mm_load_ps(volumes.mData);
-
-				for (i = 0; i < samplequads; i++)
-				{
-					//float f1 = origdata[c] * v;	c++; v += vd;
-					__m128 f = _mm_load_ps(&aBuffer.mData[c]);
-					c += 4;
-					f = _mm_mul_ps(f, vol);
-					vol = _mm_add_ps(vol, vdelta);
-
-					//float u1 = (f1 > -1.65f);
-					__m128 u = _mm_cmpgt_ps(f, negbound);
-
-					//float o1 = (f1 < 1.65f);
-					__m128 o = _mm_cmplt_ps(f, posbound);
-
-					//f1 = (0.87f * f1 - 0.1f * f1 * f1 * f1) * u1 * o1;
-					__m128 lin = _mm_mul_ps(f, linearscale);
-					__m128 cubic = _mm_mul_ps(f, f);
-					cubic = _mm_mul_ps(cubic, f);
-					cubic = _mm_mul_ps(cubic, cubicscale);
-					f = _mm_add_ps(cubic, lin);
-
-					//f1 = f1 * u1 + !u1 * -0.9862875f;
-					__m128 lowmask = _mm_andnot_ps(u, negwall);
-					__m128 ilowmask = _mm_and_ps(u, f);
-					f = _mm_add_ps(lowmask, ilowmask);
-
-					//f1 = f1 * o1 + !o1 * 0.9862875f;
-					__m128 himask = _mm_andnot_ps(o, poswall);
-					__m128 ihimask = _mm_and_ps(o, f);
-					f = _mm_add_ps(himask, ihimask);
-
-					// outdata[d] = f1 * postclip; d++;
-					f = _mm_mul_ps(f, postscale);
-					_mm_store_ps(&aDestBuffer.mData[d], f);
-					d += 4;
-				}
-			}
-		}
-		else
-		{
-			float nb = -1.0f;	__m128 negbound = _mm_load_ps1(&nb);
-			float pb = 1.0f;	__m128 posbound = _mm_load_ps1(&pb);
-			__m128 postscale = _mm_load_ps1(&mPostClipScaler);
-			TinyAlignedFloatBuffer volumes;
-			volumes.mData[0] = v;
-			volumes.mData[1] = v + vd;
-			volumes.mData[2] = v + vd + vd;
-			volumes.mData[3] = v + vd + vd + vd;
-			vd *= 4;
-			__m128 vdelta = _mm_load_ps1(&vd);
-			c = 0;
-			d = 0;
-			for (j = 0; j < mChannels; j++)
-			{
-				__m128 vol = _mm_load_ps(volumes.mData);
-				for (i = 0; i < samplequads; i++) 
-				{
-					//float f1 = aBuffer.mData[c] * v; c++; v += vd;
-					__m128 f = _mm_load_ps(&aBuffer.mData[c]);
-					c += 4;
-					f = _mm_mul_ps(f, vol);
-					vol = _mm_add_ps(vol, vdelta);
-
-					//f1 = (f1 <= -1) ? -1 : (f1 >= 1) ? 1 : f1;
-					f = _mm_max_ps(f, negbound);
-					f = _mm_min_ps(f, posbound);
-
-					//aDestBuffer.mData[d] = f1 * mPostClipScaler; d++;
-					f = _mm_mul_ps(f, postscale);
-					_mm_store_ps(&aDestBuffer.mData[d], f);
-					d += 4;
-				}
-			}
-		}
-	}
-#else // fallback code
 	void Soloud::clip_internal(AlignedFloatBuffer &aBuffer, AlignedFloatBuffer &aDestBuffer, unsigned int aSamples, float aVolume0, float aVolume1)
 	{
 		float vd = (aVolume1 - aVolume0) / aSamples;
-		float v = aVolume0;
-		unsigned int i, j, c, d;
 		unsigned int samplequads = (aSamples + 3) / 4; // rounded up
-		// Clip
-		if (mFlags & CLIP_ROUNDOFF)
-		{
-			c = 0;
-			d = 0;
-			for (j = 0; j < mChannels; j++)
-			{
-				v = aVolume0;
-				for (i = 0; i < samplequads; i++)
-				{
-					float f1 = aBuffer.mData[c] * v; c++; v += vd;
-					float f2 = aBuffer.mData[c] * v; c++; v += vd;
-					float f3 = aBuffer.mData[c] * v; c++; v += vd;
-					float f4 = aBuffer.mData[c] * v; c++; v += vd;
-
-					f1 = (f1 <= -1.65f) ? -0.9862875f : (f1 >= 1.65f) ? 0.9862875f : (0.87f * f1 - 0.1f * f1 * f1 * f1);
-					f2 = (f2 <= -1.65f) ? -0.9862875f : (f2 >= 1.65f) ? 0.9862875f : (0.87f * f2 - 0.1f * f2 * f2 * f2);
-					f3 = (f3 <= -1.65f) ? -0.9862875f : (f3 >= 1.65f) ? 0.9862875f : (0.87f * f3 - 0.1f * f3 * f3 * f3);
-					f4 = (f4 <= -1.65f) ? -0.9862875f : (f4 >= 1.65f) ? 0.9862875f : (0.87f * f4 - 0.1f * f4 * f4 * f4);
-
-					aDestBuffer.mData[d] = f1 * mPostClipScaler; d++;
-					aDestBuffer.mData[d] = f2 * mPostClipScaler; d++;
-					aDestBuffer.mData[d] = f3 * mPostClipScaler; d++;
-					aDestBuffer.mData[d] = f4 * mPostClipScaler; d++;
-				}
-			}
-		}
-		else
-		{
-			c = 0;
-			d = 0;
-			for (j = 0; j < mChannels; j++)
-			{
-				v = aVolume0;
-				for (i = 0; i < samplequads; i++) 
-				{
-					float f1 = aBuffer.mData[c] * v; c++; v += vd;
-					float f2 = aBuffer.mData[c] * v; c++; v += vd;
-					float f3 = aBuffer.mData[c] * v; c++; v += vd;
-					float f4 = aBuffer.mData[c] * v; c++; v += vd;
-
-					f1 = (f1 <= -1) ? -1 : (f1 >= 1) ? 1 : f1;
-					f2 = (f2 <= -1) ? -1 : (f2 >= 1) ? 1 : f2;
-					f3 = (f3 <= -1) ? -1 : (f3 >= 1) ? 1 : f3;
-					f4 = (f4 <= -1) ? -1 : (f4 >= 1) ? 1 : f4;
-
-					aDestBuffer.mData[d] = f1 * mPostClipScaler; d++;
-					aDestBuffer.mData[d] = f2 * mPostClipScaler; d++;
-					aDestBuffer.mData[d] = f3 * mPostClipScaler; d++;
-					aDestBuffer.mData[d] = f4 * mPostClipScaler; d++;
-			}
-		}
-	}
-}
-#endif
-
-#define FIXPOINT_FRAC_BITS 20
-#define FIXPOINT_FRAC_MUL (1 << FIXPOINT_FRAC_BITS)
-#define FIXPOINT_FRAC_MASK ((1 << FIXPOINT_FRAC_BITS) - 1)
-
-	void resample(float *aSrc,
-		          float *aSrc1, 
-				  float *aDst, 
-				  int aSrcOffset,
-				  int aDstSampleCount,
-				  float /*aSrcSamplerate*/, 
-				  float /*aDstSamplerate*/,
-				  int aStepFixed)
-	{
-#if 0
-
-#elif defined(RESAMPLER_LINEAR)
-		int i;
-		int pos = aSrcOffset;
-
-		for (i = 0; i < aDstSampleCount; i++, pos += aStepFixed)
+		unsigned int j;
+		for (j = 0; j < mChannels; j++)
 		{
-			int p = pos >> FIXPOINT_FRAC_BITS;
-			int f = pos & FIXPOINT_FRAC_MASK;
-#ifdef _DEBUG
-			if (p >= SAMPLE_GRANULARITY || p < 0)
-			{
-				// This should never actually happen
-				p = SAMPLE_GRANULARITY - 1;
-			}
-#endif
-			float s1 = aSrc1[SAMPLE_GRANULARITY - 1];
-			float s2 = aSrc[p];
-			if (p != 0)
-			{
-				s1 = aSrc[p-1];
-			}
-			aDst[i] = s1 + (s2 - s1) * f * (1 / (float)FIXPOINT_FRAC_MUL);
-		}
-#else // Point sample
-		int i;
-		int pos = aSrcOffset;
-
-		for (i = 0; i < aDstSampleCount; i++, pos += aStepFixed)
-		{
-			int p = pos >> FIXPOINT_FRAC_BITS;
-			aDst[i] = aSrc[p];
+			unsigned int ofs = j * samplequads * 4;
+			if (mFlags & CLIP_ROUNDOFF)
+				mSimd->clipRoundoff(aBuffer.mData + ofs, aDestBuffer.mData + ofs, samplequads * 4, aVolume0, vd, mPostClipScaler);
+			else
+				mSimd->clipHard(aBuffer.mData + ofs, aDestBuffer.mData + ofs, samplequads * 4, aVolume0, vd, mPostClipScaler);
 		}
-#endif
 	}
 
-	void panAndExpand(AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels)
+	void panAndExpand(const SimdKernels *aSimd, AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels)
 	{
 		float pan[MAX_CHANNELS]; // current speaker volume
 		float pand[MAX_CHANNELS]; // destination speaker volume
@@ -977,20 +860,26 @@ namespace SoLoud
 			pani[k] = (pand[k] - pan[k]) / aSamplesToRead; // TODO: this is a bit inconsistent.. but it's a hack to begin with
 		}
 
-		int ofs = 0;
-		switch (aChannels)
+		// Cases where every output channel is one input channel times its ramp go through the kernels
+		if (aChannels == 1 || aVoice->mChannels == 1 || aVoice->mChannels == aChannels)
 		{
-		case 1: // Target is mono. Sum everything. (1->1, 2->1, 4->1, 6->1, 8->1)
-			for (j = 0, ofs = 0; j < aVoice->mChannels; j++, ofs += aBufferSize)
+			if (aChannels == 1)
 			{
-				pan[0] = aVoice->mCurrentChannelVolume[0];
-				for (k = 0; k < aSamplesToRead; k++)
-				{
-					pan[0] += pani[0];
-					aBuffer[k] += aScratch[ofs + k] * pan[0];
-				}
+				for (j = 0; j < aVoice->mChannels; j++)
+					aSimd->mixRamp(aScratch + aBufferSize * j, aBuffer, aSamplesToRead, pan[0], pani[0]);
 			}
-			break;
+			else
+			{
+				for (k = 0; k < aChannels; k++)
+					aSimd->mixRamp(aScratch + (aVoice->mChannels == 1 ? 0 : aBufferSize * k), aBuffer + aBufferSize * k, aSamplesToRead, pan[k], pani[k]);
+			}
+			for (k = 0; k < aChannels; k++)
+				aVoice->mCurrentChannelVolume[k] = pand[k];
+			return;
+		}
+
+		switch (aChannels)
+		{
 		case 2:
 			switch (aVoice->mChannels)
 			{
@@ -1039,27 +928,6 @@ namespace SoLoud
 					aBuffer[j + aBufferSize] += 0.5f * (s2 + s4) * pan[1];
 				}
 				break;
-			case 2: // 2->2
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					float s1 = aScratch[j];
-					float s2 = aScratch[aBufferSize + j];
-					aBuffer[j + 0] += s1 * pan[0];
-					aBuffer[j + aBufferSize] += s2 * pan[1];
-				}
-				break;
-			case 1: // 1->2
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					float s = aScratch[j];
-					aBuffer[j + 0] += s * pan[0];
-					aBuffer[j + aBufferSize] += s * pan[1];
-				}
-				break;
 			}
 			break;
 		case 4:
@@ -1107,23 +975,6 @@ namespace SoLoud
 					aBuffer[j + aBufferSize * 3] += s6 * pan[3];
 				}
 				break;
-			case 4: // 4->4
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					pan[2] += pani[2];
-					pan[3] += pani[3];
-					float s1 = aScratch[j];
-					float s2 = aScratch[aBufferSize + j];
-					float s3 = aScratch[aBufferSize * 2 + j];
-					float s4 = aScratch[aBufferSize * 3 + j];
-					aBuffer[j + 0] += s1 * pan[0];
-					aBuffer[j + aBufferSize] += s2 * pan[1];
-					aBuffer[j + aBufferSize * 2] += s3 * pan[2];
-					aBuffer[j + aBufferSize * 3] += s4 * pan[3];
-				}
-				break;
 			case 2: // 2->4
 				for (j = 0; j < aSamplesToRead; j++)
 				{
@@ -1139,20 +990,6 @@ namespace SoLoud
 					aBuffer[j + aBufferSize * 3] += s2 * pan[3];
 				}
 				break;
-			case 1: // 1->4
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					pan[2] += pani[2];
-					pan[3] += pani[3];
-					float s = aScratch[j];
-					aBuffer[j + 0] += s * pan[0];
-					aBuffer[j + aBufferSize] += s * pan[1];
-					aBuffer[j + aBufferSize * 2] += s * pan[2];
-					aBuffer[j + aBufferSize * 3] += s * pan[3];
-				}
-				break;
 			}
 			break;
 		case 6:
@@ -1183,29 +1020,6 @@ namespace SoLoud
 					aBuffer[j + aBufferSize * 5] += 0.5f * (s6 + s8) * pan[5];
 				}
 				break;
-			case 6: // 6->6
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					pan[2] += pani[2];
-					pan[3] += pani[3];
-					pan[4] += pani[4];
-					pan[5] += pani[5];
-					float s1 = aScratch[j];
-					float s2 = aScratch[aBufferSize + j];
-					float s3 = aScratch[aBufferSize * 2 + j];
-					float s4 = aScratch[aBufferSize * 3 + j];
-					float s5 = aScratch[aBufferSize * 4 + j];
-					float s6 = aScratch[aBufferSize * 5 + j];
-					aBuffer[j + 0] += s1 * pan[0];
-					aBuffer[j + aBufferSize] += s2 * pan[1];
-					aBuffer[j + aBufferSize * 2] += s3 * pan[2];
-					aBuffer[j + aBufferSize * 3] += s4 * pan[3];
-					aBuffer[j + aBufferSize * 4] += s5 * pan[4];
-					aBuffer[j + aBufferSize * 5] += s6 * pan[5];
-				}
-				break;
 			case 4: // 4->6
 				for (j = 0; j < aSamplesToRead; j++)
 				{
@@ -1246,58 +1060,11 @@ namespace SoLoud
 					aBuffer[j + aBufferSize * 5] += s2 * pan[5];
 				}
 				break;
-			case 1: // 1->6
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					pan[2] += pani[2];
-					pan[3] += pani[3];
-					pan[4] += pani[4];
-					pan[5] += pani[5];
-					float s = aScratch[j];
-					aBuffer[j + 0] += s * pan[0];
-					aBuffer[j + aBufferSize] += s * pan[1];
-					aBuffer[j + aBufferSize * 2] += s * pan[2];
-					aBuffer[j + aBufferSize * 3] += s * pan[3];
-					aBuffer[j + aBufferSize * 4] += s * pan[4];
-					aBuffer[j + aBufferSize * 5] += s * pan[5];
-				}
-				break;
 			}
 			break;
 		case 8:
 			switch (aVoice->mChannels)
 			{
-			case 8: // 8->8
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					pan[2] += pani[2];
-					pan[3] += pani[3];
-					pan[4] += pani[4];
-					pan[5] += pani[5];
-					pan[6] += pani[6];
-					pan[7] += pani[7];
-					float s1 = aScratch[j];
-					float s2 = aScratch[aBufferSize + j];
-					float s3 = aScratch[aBufferSize * 2 + j];
-					float s4 = aScratch[aBufferSize * 3 + j];
-					float s5 = aScratch[aBufferSize * 4 + j];
-					float s6 = aScratch[aBufferSize * 5 + j];
-					float s7 = aScratch[aBufferSize * 6 + j];
-					float s8 = aScratch[aBufferSize * 7 + j];
-					aBuffer[j + 0] += s1 * pan[0];
-					aBuffer[j + aBufferSize] += s2 * pan[1];
-					aBuffer[j + aBufferSize * 2] += s3 * pan[2];
-					aBuffer[j + aBufferSize * 3] += s4 * pan[3];
-					aBuffer[j + aBufferSize * 4] += s5 * pan[4];
-					aBuffer[j + aBufferSize * 5] += s6 * pan[5];
-					aBuffer[j + aBufferSize * 6] += s7 * pan[6];
-					aBuffer[j + aBufferSize * 7] += s8 * pan[7];
-				}
-				break;
 			case 6: // 6->8
 				for (j = 0; j < aSamplesToRead; j++)
 				{
@@ -1373,28 +1140,6 @@ namespace SoLoud
 					aBuffer[j + aBufferSize * 7] += s2 * pan[7];
 				}
 				break;
-			case 1: // 1->8
-				for (j = 0; j < aSamplesToRead; j++)
-				{
-					pan[0] += pani[0];
-					pan[1] += pani[1];
-					pan[2] += pani[2];
-					pan[3] += pani[3];
-					pan[4] += pani[4];
-					pan[5] += pani[5];
-					pan[6] += pani[6];
-					pan[7] += pani[7];
-					float s = aScratch[j];
-					aBuffer[j + 0] += s * pan[0];
-					aBuffer[j + aBufferSize] += s * pan[1];
-					aBuffer[j + aBufferSize * 2] += s * pan[2];
-					aBuffer[j + aBufferSize * 3] += s * pan[3];
-					aBuffer[j + aBufferSize * 4] += s * pan[4];
-					aBuffer[j + aBufferSize * 5] += s * pan[5];
-					aBuffer[j + aBufferSize * 6] += s * pan[6];
-					aBuffer[j + aBufferSize * 7] += s * pan[7];
-				}
-				break;
 			}
 			break;
 		}
@@ -1403,7 +1148,98 @@ namespace SoLoud
 			aVoice->mCurrentChannelVolume[k] = pand[k];
 	}
 
-	void Soloud::mixBus_internal(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aBus, float aSamplerate, unsigned int aChannels)
+	// Pan aSamples samples of a voice's channel aChannel into the output at aOutOffset, for the channel
+	// layouts panAndExpand mixes with mixRamp
+	static void mixDirectChannel(const SimdKernels *aSimd, const float *aSrc, unsigned int aChannel, unsigned int aVoiceChannels, float *aBuffer, unsigned int aBufferSize, unsigned int aChannels, unsigned int aOutOffset, unsigned int aSamples, const float *aPan, const float *aPanDelta)
+	{
+		unsigned int o = aOutOffset;
+		if (aChannels == 1)
+		{
+			aSimd->mixRamp(aSrc, aBuffer + o, aSamples, aPan[0] + aPanDelta[0] * o, aPanDelta[0]);
+		}
+		else if (aVoiceChannels == 1)
+		{
+			unsigned int k;
+			for (k = 0; k < aChannels; k++)
+				aSimd->mixRamp(aSrc, aBuffer + aBufferSize * k + o, aSamples, aPan[k] + aPanDelta[k] * o, aPanDelta[k]);
+		}
+		else
+		{
+			aSimd->mixRamp(aSrc, aBuffer + aBufferSize * aChannel + o, aSamples, aPan[aChannel] + aPanDelta[aChannel] * o, aPanDelta[aChannel]);
+		}
+	}
+
+	// Resample aSamples samples of a voice's current block and add them to the output at aOutOffset with
+	// the pan ramp, without going through scratch. The block is the source's own sample data when it was
+	// fetched in place, and the resample buffer otherwise. The fused kernel does it all in one pass, when
+	// there's one for the layout; failing that, a tile at a time is resampled, so the samples are still in
+	// the cache when they're panned. At the output rate the source is panned as is.
+	static void mixInPlace(const SimdKernels *aSimd, MixVoiceKernel aFused, AudioSourceInstance *aVoice, unsigned int aGranularity, float *aBuffer, unsigned int aBufferSize, unsigned int aChannels, unsigned int aOutOffset, unsigned int aSamples, unsigned int aStepFixed, bool aPoint, const float *aPan, const float *aPanDelta)
+	{
+#if defined(RESAMPLER_LINEAR)
+		// The linear resampler lags a sample
+		unsigned int lag = aPoint ? 0 : 1;
+#else
+		unsigned int lag = 0;
+#endif
+		const float *block = aVoice->mResampleData[0]->mData;
+		unsigned int pitch = aGranularity;
+		if (aVoice->mDirectData)
+		{
+			block = aVoice->mDirectData;
+			pitch = aVoice->mDirectPitch;
+		}
+
+		unsigned int j;
+		if (aStepFixed == FIXPOINT_FRAC_MUL && (aVoice->mSrcOffset & FIXPOINT_FRAC_MASK) == 0)
+		{
+			unsigned int p = aVoice->mSrcOffset >> FIXPOINT_FRAC_BITS;
+			// At the start of the block, the first sample is the previous block's last, kept in the other resample buffer
+			unsigned int head = p < lag ? 1 : 0;
+			for (j = 0; j < aVoice->mChannels; j++)
+			{
+				if (head)
+					mixDirectChannel(aSimd, aVoice->mResampleData[1]->mData + aGranularity * (j + 1) - 1, j, aVoice->mChannels, aBuffer, aBufferSize, aChannels, aOutOffset, 1, aPan, aPanDelta);
+				mixDirectChannel(aSimd, block + pitch * j + p + head - lag, j, aVoice->mChannels, aBuffer, aBufferSize, aChannels, aOutOffset + head, aSamples - head, aPan, aPanDelta);
+			}
+			return;
+		}
+
+		if (aFused)
+		{
+			float prev[MAX_CHANNELS];
+			float pan[MAX_CHANNELS];
+			for (j = 0; j < aVoice->mChannels; j++)
+				prev[j] = aVoice->mResampleData[1]->mData[aGranularity * (j + 1) - 1];
+			for (j = 0; j < aChannels; j++)
+				pan[j] = aPan[j] + aPanDelta[j] * aOutOffset;
+			aFused(block, pitch, prev, aBuffer + aOutOffset, aBufferSize, aSamples, aVoice->mSrcOffset, aStepFixed, pan, aPanDelta);
+			return;
+		}
+
+		float tile[DIRECT_MIX_TILE];
+		unsigned int done = 0;
+		while (done < aSamples)
+		{
+			unsigned int n = aSamples - done;
+			if (n > DIRECT_MIX_TILE)
+				n = DIRECT_MIX_TILE;
+			for (j = 0; j < aVoice->mChannels; j++)
+			{
+				(aPoint ? aSimd->resamplePoint : aSimd->resample)(block + pitch * j,
+					aVoice->mResampleData[1]->mData + aGranularity * j,
+					aGranularity,
+					tile,
+					aVoice->mSrcOffset + done * aStepFixed,
+					n,
+					aStepFixed);
+				mixDirectChannel(aSimd, tile, j, aVoice->mChannels, aBuffer, aBufferSize, aChannels, aOutOffset + done, n, aPan, aPanDelta);
+			}
+			done += n;
+		}
+	}
+
+	void Soloud::mixBus_internal(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aBus, float aSamplerate, unsigned int aChannels, AudioPanner *aPanner)
 	{
 		unsigned int i, j;
 		// Clear accumulation buffer
@@ -1415,8 +1251,12 @@ namespace SoLoud
 			}
 		}
 
-		// Accumulate sound sources		
-		for (i = 0; i < mActiveVoiceCount; i++)
+		// Accumulate sound sources on this bus
+		unsigned int key = aBus & VOICE_HANDLE_SLOT_MASK;
+		if (key >= mBusVoiceKeys)
+			return;
+		unsigned int last = mBusVoiceStart[key + 1];
+		for (i = mBusVoiceStart[key]; i < last; i++)
 		{
 			AudioSourceInstance *voice = mVoice[mActiveVoice[i]];
 			if (voice &&
@@ -1424,12 +1264,49 @@ namespace SoLoud
 				!(voice->mFlags & AudioSourceInstance::PAUSED) &&
 				!(voice->mFlags & AudioSourceInstance::INAUDIBLE))
 			{
+				if (voice->mFlags & AudioSourceInstance::VIRTUAL)
+				{
+					resyncVoice_internal(mActiveVoice[i], aSamplesToRead / aSamplerate * voice->mOverallRelativePlaySpeed);
+				}
+
+				// Under load, quiet voices are mixed more cheaply
+				bool degraded = mGovernorLevel >= GOVERNOR_POINT_SAMPLING &&
+					!(voice->mFlags & AudioSourceInstance::PROTECTED) &&
+					voice->mOverallVolume < GOVERNOR_QUIET_VOLUME;
+				if (degraded)
+					mGovernorDegradedVoices++;
+				bool skipfilters = degraded && mGovernorLevel >= GOVERNOR_SKIP_FILTERS;
+
 				float step = voice->mSamplerate / aSamplerate;
 				// avoid step overflow
 				if (step > (1 << (32 - FIXPOINT_FRAC_BITS)))
 					step = 0;
 				unsigned int step_fixed = (int)floor(step * FIXPOINT_FRAC_MUL);
 				unsigned int outofs = 0;
+
+				// When the pan is one of panAndExpand's mixRamp cases, voices are resampled and panned
+				// straight into the output, by a kernel picked for the channel layout once per block.
+				// Blocks of unfiltered in-memory voices are read in place as well.
+				bool directpan = !aPanner && (aChannels == 1 || voice->mChannels == 1 || voice->mChannels == aChannels);
+				bool direct = directpan;
+				for (j = 0; j < FILTERS_PER_STREAM; j++)
+				{
+					if (voice->mFilter[j] && !skipfilters)
+						direct = false;
+				}
+				float pan[MAX_CHANNELS];
+				float pani[MAX_CHANNELS];
+				if (directpan)
+				{
+					for (j = 0; j < aChannels; j++)
+					{
+						pan[j] = voice->mCurrentChannelVolume[j];
+						pani[j] = (voice->mChannelVolume[j] * voice->mOverallVolume - pan[j]) / aSamplesToRead;
+					}
+				}
+				MixVoiceKernel fused = directpan ? getMixVoiceKernel(mSimdLevel, voice->mChannels, aChannels, degraded) : NULL;
+				// Scratch holds samples panAndExpand still has to mix
+				bool scratchused = !directpan;
 			
 				if (voice->mDelaySamples)
 				{
@@ -1451,6 +1328,7 @@ namespace SoLoud
 						memset(aScratch + k * aBufferSize, 0, sizeof(float) * outofs); 
 					}
 				}												
+				unsigned int mixstart = outofs;
 
 				while (step_fixed != 0 && outofs < aSamplesToRead)
 				{
@@ -1461,20 +1339,44 @@ namespace SoLoud
 						voice->mResampleData[0] = voice->mResampleData[1];
 						voice->mResampleData[1] = t;
 
+						// Read the block in place if it's all there, left neighbour included
+						voice->mDirectData = NULL;
+						if (direct)
+						{
+							unsigned int count, position;
+							const float *data = voice->getDirectData(&count, &position);
+							if (data && position > 0 && position < count && count - position >= mGranularity)
+							{
+								voice->mDirectData = data + position;
+								voice->mDirectPitch = count;
+								voice->skipDirectData(mGranularity);
+								// The resampler takes the left neighbour of the next block from here, if that one isn't read in place
+								unsigned int k;
+								for (k = 0; k < voice->mChannels; k++)
+									voice->mResampleData[0]->mData[mGranularity * (k + 1) - 1] = voice->mDirectData[count * k + mGranularity - 1];
+							}
+						}
+
 						// Get a block of source data
 
-						int readcount = 0;
-						if (!voice->hasEnded() || voice->mFlags & AudioSourceInstance::LOOPING)
+						unsigned int readcount = 0;
+						if (voice->mDirectData)
+						{
+							readcount = mGranularity;
+						}
+						else if (!voice->hasEnded() || voice->mFlags & AudioSourceInstance::LOOPING)
 						{
-							readcount = voice->getAudio(voice->mResampleData[0]->mData, SAMPLE_GRANULARITY, SAMPLE_GRANULARITY);
-							if (readcount < SAMPLE_GRANULARITY)
+							readcount = voice->getAudio(voice->mResampleData[0]->mData, mGranularity, mGranularity);
+							if (readcount < mGranularity)
 							{
 								if (voice->mFlags & AudioSourceInstance::LOOPING)
 								{
-									while (readcount < SAMPLE_GRANULARITY && voice->seek(voice->mLoopPoint, mScratch.mData, mScratchSize) == SO_NO_ERROR)
+									// Seeking goes by the stream position
+									syncVoiceTime_internal(mActiveVoice[i]);
+									while (readcount < mGranularity && voice->seek(voice->mLoopPoint, mScratch.mData, mScratchSize) == SO_NO_ERROR)
 									{
 										voice->mLoopCount++;
-										int inc = voice->getAudio(voice->mResampleData[0]->mData + readcount, SAMPLE_GRANULARITY - readcount, SAMPLE_GRANULARITY);
+										unsigned int inc = voice->getAudio(voice->mResampleData[0]->mData + readcount, mGranularity - readcount, mGranularity);
 										readcount += inc;
 										if (inc == 0) break;
 									}
@@ -1483,22 +1385,22 @@ namespace SoLoud
 						}
 
                         // Clear remaining of the resample data if the full scratch wasn't used
-						if (readcount < SAMPLE_GRANULARITY)
+						if (readcount < mGranularity)
 						{
 							unsigned int k;
 							for (k = 0; k < voice->mChannels; k++)
-								memset(voice->mResampleData[0]->mData + readcount + SAMPLE_GRANULARITY * k, 0, sizeof(float) * (SAMPLE_GRANULARITY - readcount));
+								memset(voice->mResampleData[0]->mData + readcount + mGranularity * k, 0, sizeof(float) * (mGranularity - readcount));
 						}
 
 						// If we go past zero, crop to zero (a bit of a kludge)
-						if (voice->mSrcOffset < SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL)
+						if (voice->mSrcOffset < mGranularity * FIXPOINT_FRAC_MUL)
 						{
 							voice->mSrcOffset = 0;
 						}
 						else
 						{
 							// We have new block of data, move pointer backwards
-							voice->mSrcOffset -= SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL;
+							voice->mSrcOffset -= mGranularity * FIXPOINT_FRAC_MUL;
 						}
 
 					
@@ -1506,11 +1408,11 @@ namespace SoLoud
 
 						for (j = 0; j < FILTERS_PER_STREAM; j++)
 						{
-							if (voice->mFilter[j])
+							if (voice->mFilter[j] && !skipfilters)
 							{
 								voice->mFilter[j]->filter(
 									voice->mResampleData[0]->mData,
-									SAMPLE_GRANULARITY, 
+									mGranularity, 
 									voice->mChannels,
 									voice->mSamplerate,
 									mStreamTime);
@@ -1527,13 +1429,12 @@ namespace SoLoud
 
 					unsigned int writesamples = 0;
 
-					if (voice->mSrcOffset < SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL)
+					if (voice->mSrcOffset < mGranularity * FIXPOINT_FRAC_MUL)
 					{
-						writesamples = ((SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL) - voice->mSrcOffset) / step_fixed + 1;
-
-						// avoid reading past the current buffer..
-						if (((writesamples * step_fixed + voice->mSrcOffset) >> FIXPOINT_FRAC_BITS) >= SAMPLE_GRANULARITY)
-							writesamples--;
+						// Every source position left in the current buffer. The position past the
+						// last one carries over to the next buffer, so small granularities don't
+						// drift in pitch.
+						writesamples = ((mGranularity * FIXPOINT_FRAC_MUL) - voice->mSrcOffset - 1) / step_fixed + 1;
 					}
 
 
@@ -1544,19 +1445,66 @@ namespace SoLoud
 						writesamples = aSamplesToRead - outofs;
 					}
 
+					bool inplace = voice->mDirectData || fused;
+					if (writesamples && !inplace && !scratchused)
+					{
+						// First block through scratch; the part mixed in place before it must be silent there
+						for (j = 0; j < voice->mChannels; j++)
+							memset(aScratch + aBufferSize * j + mixstart, 0, sizeof(float) * (outofs - mixstart));
+						scratchused = true;
+					}
+
 					// Call resampler to generate the samples, once per channel
-					if (writesamples)
+					if (writesamples && inplace)
+					{
+						mixInPlace(mSimd, fused, voice, mGranularity, aBuffer, aBufferSize, aChannels, outofs, writesamples, step_fixed, degraded, pan, pani);
+						if (scratchused)
+						{
+							// panAndExpand mixes the whole buffer; it mustn't add this part again
+							for (j = 0; j < voice->mChannels; j++)
+								memset(aScratch + aBufferSize * j + outofs, 0, sizeof(float) * writesamples);
+						}
+					}
+					else if (writesamples && step_fixed == FIXPOINT_FRAC_MUL && (voice->mSrcOffset & FIXPOINT_FRAC_MASK) == 0)
 					{
+						// Source at the output rate, on a whole sample: both resamplers reduce to a copy.
+						// The linear one lags a sample, its first one coming from the previous block.
+						unsigned int p = voice->mSrcOffset >> FIXPOINT_FRAC_BITS;
+#if defined(RESAMPLER_LINEAR)
+						bool lag = !degraded;
+#else
+						bool lag = false;
+#endif
 						for (j = 0; j < voice->mChannels; j++)
 						{
-							resample(voice->mResampleData[0]->mData + SAMPLE_GRANULARITY * j,
-								voice->mResampleData[1]->mData + SAMPLE_GRANULARITY * j,
-									 aScratch + aBufferSize * j + outofs, 
-									 voice->mSrcOffset,
-									 writesamples,
-									 voice->mSamplerate,
-									 aSamplerate,
-									 step_fixed);
+							float *src = voice->mResampleData[0]->mData + mGranularity * j;
+							float *dst = aScratch + aBufferSize * j + outofs;
+							if (!lag)
+							{
+								memcpy(dst, src + p, sizeof(float) * writesamples);
+							}
+							else if (p == 0)
+							{
+								dst[0] = voice->mResampleData[1]->mData[mGranularity * (j + 1) - 1];
+								memcpy(dst + 1, src, sizeof(float) * (writesamples - 1));
+							}
+							else
+							{
+								memcpy(dst, src + p - 1, sizeof(float) * writesamples);
+							}
+						}
+					}
+					else if (writesamples)
+					{
+						for (j = 0; j < voice->mChannels; j++)
+						{
+							(degraded ? mSimd->resamplePoint : mSimd->resample)(voice->mResampleData[0]->mData + mGranularity * j,
+								voice->mResampleData[1]->mData + mGranularity * j,
+								mGranularity,
+								aScratch + aBufferSize * j + outofs,
+								voice->mSrcOffset,
+								writesamples,
+								step_fixed);
 						}
 					}
 
@@ -1568,7 +1516,16 @@ namespace SoLoud
 				}
 				
 				// Handle panning and channel expansion (and/or shrinking)
-				panAndExpand(voice, aBuffer, aSamplesToRead, aBufferSize, aScratch, aChannels);
+				if (aPanner)
+					aPanner->pan(this, voice, aBuffer, aSamplesToRead, aBufferSize, aScratch, aChannels);
+				else if (scratchused)
+					panAndExpand(mSimd, voice, aBuffer, aSamplesToRead, aBufferSize, aScratch, aChannels);
+				else
+				{
+					// Everything was mixed in place; just finish the ramp
+					for (j = 0; j < aChannels; j++)
+						voice->mCurrentChannelVolume[j] = voice->mChannelVolume[j] * voice->mOverallVolume;
+				}
 
 				// clear voice if the sound is over
 				if (!(voice->mFlags & AudioSourceInstance::LOOPING) && voice->hasEnded())
@@ -1610,35 +1567,38 @@ namespace SoLoud
 						AlignedFloatBuffer * t = voice->mResampleData[0];
 						voice->mResampleData[0] = voice->mResampleData[1];
 						voice->mResampleData[1] = t;
+						voice->mDirectData = NULL;
 
 						// Get a block of source data
 
-						int readcount = 0;
+						unsigned int readcount = 0;
 						if (!voice->hasEnded() || voice->mFlags & AudioSourceInstance::LOOPING)
 						{
-							readcount = voice->getAudio(voice->mResampleData[0]->mData, SAMPLE_GRANULARITY, SAMPLE_GRANULARITY);
-							if (readcount < SAMPLE_GRANULARITY)
+							readcount = voice->getAudio(voice->mResampleData[0]->mData, mGranularity, mGranularity);
+							if (readcount < mGranularity)
 							{
 								if (voice->mFlags & AudioSourceInstance::LOOPING)
 								{
-									while (readcount < SAMPLE_GRANULARITY && voice->seek(voice->mLoopPoint, mScratch.mData, mScratchSize) == SO_NO_ERROR)
+									// Seeking goes by the stream position
+									syncVoiceTime_internal(mActiveVoice[i]);
+									while (readcount < mGranularity && voice->seek(voice->mLoopPoint, mScratch.mData, mScratchSize) == SO_NO_ERROR)
 									{
 										voice->mLoopCount++;
-										readcount += voice->getAudio(voice->mResampleData[0]->mData + readcount, SAMPLE_GRANULARITY - readcount, SAMPLE_GRANULARITY);
+										readcount += voice->getAudio(voice->mResampleData[0]->mData + readcount, mGranularity - readcount, mGranularity);
 									}
 								}
 							}
 						}
 
 						// If we go past zero, crop to zero (a bit of a kludge)
-						if (voice->mSrcOffset < SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL)
+						if (voice->mSrcOffset < mGranularity * FIXPOINT_FRAC_MUL)
 						{
 							voice->mSrcOffset = 0;
 						}
 						else
 						{
 							// We have new block of data, move pointer backwards
-							voice->mSrcOffset -= SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL;
+							voice->mSrcOffset -= mGranularity * FIXPOINT_FRAC_MUL;
 						}
 
 						// Skip filters
@@ -1653,13 +1613,12 @@ namespace SoLoud
 
 					unsigned int writesamples = 0;
 
-					if (voice->mSrcOffset < SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL)
+					if (voice->mSrcOffset < mGranularity * FIXPOINT_FRAC_MUL)
 					{
-						writesamples = ((SAMPLE_GRANULARITY * FIXPOINT_FRAC_MUL) - voice->mSrcOffset) / step_fixed + 1;
-
-						// avoid reading past the current buffer..
-						if (((writesamples * step_fixed + voice->mSrcOffset) >> FIXPOINT_FRAC_BITS) >= SAMPLE_GRANULARITY)
-							writesamples--;
+						// Every source position left in the current buffer. The position past the
+						// last one carries over to the next buffer, so small granularities don't
+						// drift in pitch.
+						writesamples = ((mGranularity * FIXPOINT_FRAC_MUL) - voice->mSrcOffset - 1) / step_fixed + 1;
 					}
 
 
@@ -1690,25 +1649,21 @@ namespace SoLoud
 
 	void Soloud::mapResampleBuffers_internal()
 	{
-		SOLOUD_ASSERT(mMaxActiveVoices < 256);
-		char live[256];
-		memset(live, 0, mMaxActiveVoices);
 		unsigned int i, j;
-		for (i = 0; i < mMaxActiveVoices; i++)
+		memset(mResampleDataLive, 0, mMaxActiveVoices);
+		for (i = 0; i < mActiveVoiceCount; i++)
 		{
-			for (j = 0; j < mMaxActiveVoices; j++)
+			AudioSourceInstance *voice = mVoice[mActiveVoice[i]];
+			if (voice && voice->mResampleData[0])
 			{
-				if (mResampleDataOwner[i] && mResampleDataOwner[i] == mVoice[mActiveVoice[j]])
-				{
-					live[i] |= 1; // Live channel
-					live[j] |= 2; // Live voice
-				}
+				// The pair ping-pongs, so either buffer gives the pair's index
+				mResampleDataLive[(voice->mResampleData[0] - mResampleData) / 2] = 1;
 			}
 		}
 
 		for (i = 0; i < mMaxActiveVoices; i++)
 		{
-			if (!(live[i] & 1) && mResampleDataOwner[i]) // For all dead channels with owners..
+			if (!mResampleDataLive[i] && mResampleDataOwner[i]) // For all dead channels with owners..
 			{
 				mResampleDataOwner[i]->mResampleData[0] = 0;
 				mResampleDataOwner[i]->mResampleData[1] = 0;
@@ -1716,26 +1671,22 @@ namespace SoLoud
 			}
 		}
 
-		int latestfree = 0;
+		unsigned int latestfree = 0;
 		for (i = 0; i < mActiveVoiceCount; i++)
 		{
-			if (!(live[i] & 2) && mVoice[mActiveVoice[i]]) // For all live voices with no channel..
+			AudioSourceInstance *voice = mVoice[mActiveVoice[i]];
+			if (voice && !voice->mResampleData[0]) // For all live voices with no channel..
 			{
-				int found = -1;
-				for (j = latestfree; found == -1 && j < mMaxActiveVoices; j++)
+				for (j = latestfree; j < mMaxActiveVoices && mResampleDataOwner[j]; j++)
 				{
-					if (mResampleDataOwner[j] == 0)
-					{
-						found = j;
-					}
 				}
-				SOLOUD_ASSERT(found != -1);
-				mResampleDataOwner[found] = mVoice[mActiveVoice[i]];
-				mResampleDataOwner[found]->mResampleData[0] = &mResampleData[found * 2 + 0];
-				mResampleDataOwner[found]->mResampleData[1] = &mResampleData[found * 2 + 1];
-				mResampleDataOwner[found]->mResampleData[0]->clear();
-				mResampleDataOwner[found]->mResampleData[1]->clear();
-				latestfree = found + 1;
+				SOLOUD_ASSERT(j < mMaxActiveVoices);
+				mResampleDataOwner[j] = voice;
+				voice->mResampleData[0] = &mResampleData[j * 2 + 0];
+				voice->mResampleData[1] = &mResampleData[j * 2 + 1];
+				voice->mResampleData[0]->clear();
+				voice->mResampleData[1]->clear();
+				latestfree = j + 1;
 			}
 		}
 	}
@@ -1754,6 +1705,17 @@ namespace SoLoud
 		mustlive = 0;
 		for (i = 0; i < mHighestVoice; i++)
 		{
+			if (mVoice[i] && 
+				(mVoice[i]->mFlags & (AudioSourceInstance::INAUDIBLE | AudioSourceInstance::INAUDIBLE_TICK | AudioSourceInstance::PAUSED)) == (AudioSourceInstance::INAUDIBLE | AudioSourceInstance::INAUDIBLE_TICK) &&
+				mVoice[i]->getLength() > 0)
+			{
+				// Cheap to seek, so let the stream position run on its own and catch up when audible
+				mVoice[i]->mFlags |= AudioSourceInstance::VIRTUAL;
+				// Watched every mix in case it plays out
+				if (!(mVoice[i]->mFlags & AudioSourceInstance::LOOPING))
+					listFaderVoice_internal(i);
+			}
+			else
 			if (mVoice[i] && (!(mVoice[i]->mFlags & (AudioSourceInstance::INAUDIBLE | AudioSourceInstance::PAUSED)) || (mVoice[i]->mFlags & AudioSourceInstance::INAUDIBLE_TICK)))
 			{
 				mActiveVoice[candidates] = i;
@@ -1768,22 +1730,26 @@ namespace SoLoud
 		}
 
 		// Check for early out
-		if (candidates <= mMaxActiveVoices)
+		unsigned int maxactive = getGovernorVoiceLimit();
+		if (candidates <= maxactive)
 		{
 			// everything is audible, early out
 			mActiveVoiceCount = candidates;
 			mapResampleBuffers_internal();
+			groupActiveVoices_internal();
 			return;
 		}
 
-		mActiveVoiceCount = mMaxActiveVoices;
+		mActiveVoiceCount = maxactive;
 
-		if (mustlive >= mMaxActiveVoices)
+		if (mustlive >= maxactive)
 		{
 			// Oopsie. Well, nothing to sort, since the "must live" voices already
 			// ate all our active voice slots.
 			// This is a potentially an error situation, but we have no way to report
 			// error from here. And asserting could be bad, too.
+			mapResampleBuffers_internal();
+			groupActiveVoices_internal();
 			return;
 		}
 
@@ -1827,6 +1793,108 @@ namespace SoLoud
 		}	
 		// TODO: should the rest of the voices be flagged INAUDIBLE?
 		mapResampleBuffers_internal();
+		groupActiveVoices_internal();
+	}
+
+	void Soloud::resyncVoice_internal(unsigned int aVoice, time aLead)
+	{
+		syncVoiceTime_internal(aVoice);
+		AudioSourceInstance *voice = mVoice[aVoice];
+		voice->mFlags &= ~AudioSourceInstance::VIRTUAL;
+
+		time position = voice->mStreamPosition - aLead;
+		if (position < 0)
+			position = 0;
+		time length = voice->getLength();
+		if ((voice->mFlags & AudioSourceInstance::LOOPING) && position >= length && length > voice->mLoopPoint)
+		{
+			time looplength = length - voice->mLoopPoint;
+			time loops = floor((position - voice->mLoopPoint) / looplength);
+			voice->mLoopCount += (unsigned int)loops;
+			position -= loops * looplength;
+		}
+		voice->seek(position, mScratch.mData, mScratchSize);
+		voice->mStreamPosition = position + aLead;
+
+		// Start over with fresh source data
+		voice->mSrcOffset = 0;
+		voice->mLeftoverSamples = 0;
+		voice->mDirectData = NULL;
+	}
+
+	void Soloud::updateGovernor_internal(unsigned int aSamples, unsigned long long aMicros)
+	{
+		float load = aMicros * (float)mSamplerate / (aSamples * 1000000.0f);
+		// Follow spikes quickly, but ease back slowly
+		mGovernorLoad += (load - mGovernorLoad) * (load > mGovernorLoad ? 0.5f : 0.05f);
+
+		if (mGovernorCooldown)
+			mGovernorCooldown--;
+
+		unsigned int level = mGovernorLevel;
+		if (mGovernorLoad > mGovernorBudget)
+		{
+			mGovernorCalm = 0;
+			if (mGovernorCooldown == 0 && level < GOVERNOR_LEVEL_MAX - 1)
+			{
+				level++;
+				mGovernorCooldown = GOVERNOR_COOLDOWN_BLOCKS;
+			}
+		}
+		else
+		if (mGovernorLoad < mGovernorBudget * 0.5f)
+		{
+			mGovernorCalm++;
+			if (mGovernorCalm >= GOVERNOR_RESTORE_BLOCKS && level > GOVERNOR_FULL)
+			{
+				level--;
+				mGovernorCalm = 0;
+				mGovernorCooldown = GOVERNOR_COOLDOWN_BLOCKS;
+			}
+		}
+		else
+		{
+			mGovernorCalm = 0;
+		}
+
+		if (level != mGovernorLevel)
+		{
+			lockAudioMutex_internal();
+			mGovernorLevel = level;
+			// The voice limit may have changed
+			mActiveVoiceDirty = true;
+			unlockAudioMutex_internal();
+		}
+	}
+
+	void Soloud::groupActiveVoices_internal()
+	{
+		// Counting sort by bus key. It is stable, so each bus mixes its voices in the same
+		// order as before.
+		unsigned int i;
+		unsigned int keys = mHighestVoice + 1;
+		SOLOUD_ASSERT(mHighestVoice <= mVoiceCapacity);
+		for (i = 0; i < keys + 2; i++)
+			mBusVoiceStart[i] = 0;
+		for (i = 0; i < mActiveVoiceCount; i++)
+		{
+			unsigned int key = mVoice[mActiveVoice[i]]->mBusHandle & VOICE_HANDLE_SLOT_MASK;
+			// A bus that is gone; the main mix skips it, like any other bus
+			if (key >= keys)
+				key = 0;
+			mBusVoiceStart[key + 2]++;
+		}
+		for (i = 2; i < keys + 2; i++)
+			mBusVoiceStart[i] += mBusVoiceStart[i - 1];
+		for (i = 0; i < mActiveVoiceCount; i++)
+		{
+			unsigned int key = mVoice[mActiveVoice[i]]->mBusHandle & VOICE_HANDLE_SLOT_MASK;
+			if (key >= keys)
+				key = 0;
+			mActiveVoiceSort[mBusVoiceStart[key + 1]++] = mActiveVoice[i];
+		}
+		memcpy(mActiveVoice, mActiveVoiceSort, sizeof(unsigned int) * mActiveVoiceCount);
+		mBusVoiceKeys = keys;
 	}
 
 	void Soloud::mix_internal(unsigned int aSamples)
@@ -1876,8 +1944,19 @@ namespace SoLoud
 		}
 #endif
 
+		unsigned long long mixstart = 0;
+		if (mFlags & ENABLE_GOVERNOR)
+		{
+			mixstart = Thread::getTimeMicros();
+		}
+		mGovernorDegradedVoices = 0;
+
 		float buffertime = aSamples / (float)mSamplerate;
 		float globalVolume[2];
+
+		// Voice stream times run from mStreamTime, so it only moves under the mutex
+		lockAudioMutex_internal();
+
 		mStreamTime += buffertime;
 		mLastClockedTime = 0;
 
@@ -1888,73 +1967,95 @@ namespace SoLoud
 		}
 		globalVolume[1] = mGlobalVolume;
 
-		lockAudioMutex_internal();
+		// Start scheduled plays that land in this buffer.
+		processScheduledEvents_internal(aSamples);
 
-		// Process faders. May change scratch size.
-		int i;
-		for (i = 0; i < (signed)mHighestVoice; i++)
+		// Process faders of the voices that have some. May change scratch size.
+		unsigned int listed = 0;
+		unsigned int k;
+		for (k = 0; k < mFaderVoiceCount; k++)
 		{
-			if (mVoice[i] && !(mVoice[i]->mFlags & AudioSourceInstance::PAUSED))
+			unsigned int ch = mFaderVoice[k];
+			if (mVoice[ch] && !(mVoice[ch]->mFlags & AudioSourceInstance::PAUSED))
 			{
-				float volume[2];
-
-				mVoice[i]->mActiveFader = 0;
+				syncVoiceTime_internal(ch);
 
-				if (mGlobalVolumeFader.mActive > 0)
-				{
-					mVoice[i]->mActiveFader = 1;
-				}
-
-				mVoice[i]->mStreamTime += buffertime;
-				mVoice[i]->mStreamPosition += (double)buffertime * (double)mVoice[i]->mOverallRelativePlaySpeed;
+				mVoice[ch]->mActiveFader = 0;
 
 				// TODO: this is actually unstable, because mStreamTime depends on the relative
 				// play speed. 
-				if (mVoice[i]->mRelativePlaySpeedFader.mActive > 0)
+				if (mVoice[ch]->mRelativePlaySpeedFader.mActive > 0)
 				{
-					float speed = mVoice[i]->mRelativePlaySpeedFader.get(mVoice[i]->mStreamTime);
-					setVoiceRelativePlaySpeed_internal(i, speed);
+					float speed = mVoice[ch]->mRelativePlaySpeedFader.get(mVoice[ch]->mStreamTime);
+					setVoiceRelativePlaySpeed_internal(ch, speed);
 				}
 
-				volume[0] = mVoice[i]->mOverallVolume;
-				if (mVoice[i]->mVolumeFader.mActive > 0)
+				if (mVoice[ch]->mVolumeFader.mActive > 0)
 				{
-					mVoice[i]->mSetVolume = mVoice[i]->mVolumeFader.get(mVoice[i]->mStreamTime);
-					mVoice[i]->mActiveFader = 1;
-					updateVoiceVolume_internal(i);
+					mVoice[ch]->mSetVolume = mVoice[ch]->mVolumeFader.get(mVoice[ch]->mStreamTime);
+					mVoice[ch]->mActiveFader = 1;
+					updateVoiceVolume_internal(ch);
 					mActiveVoiceDirty = true;
 				}
-				volume[1] = mVoice[i]->mOverallVolume;
 
-				if (mVoice[i]->mPanFader.mActive > 0)
+				if (mVoice[ch]->mPanFader.mActive > 0)
 				{
-					float pan = mVoice[i]->mPanFader.get(mVoice[i]->mStreamTime);
-					setVoicePan_internal(i, pan);
-					mVoice[i]->mActiveFader = 1;
+					float pan = mVoice[ch]->mPanFader.get(mVoice[ch]->mStreamTime);
+					setVoicePan_internal(ch, pan);
+					mVoice[ch]->mActiveFader = 1;
 				}
 
-				if (mVoice[i]->mPauseScheduler.mActive)
+				if (mVoice[ch]->mPauseScheduler.mActive)
 				{
-					mVoice[i]->mPauseScheduler.get(mVoice[i]->mStreamTime);
-					if (mVoice[i]->mPauseScheduler.mActive == -1)
+					mVoice[ch]->mPauseScheduler.get(mVoice[ch]->mStreamTime);
+					if (mVoice[ch]->mPauseScheduler.mActive == -1)
 					{
-						mVoice[i]->mPauseScheduler.mActive = 0;
-						setVoicePause_internal(i, 1);
+						mVoice[ch]->mPauseScheduler.mActive = 0;
+						setVoicePause_internal(ch, 1);
 					}
 				}
 
-				if (mVoice[i]->mStopScheduler.mActive)
+				if (mVoice[ch]->mStopScheduler.mActive)
 				{
-					mVoice[i]->mStopScheduler.get(mVoice[i]->mStreamTime);
-					if (mVoice[i]->mStopScheduler.mActive == -1)
+					mVoice[ch]->mStopScheduler.get(mVoice[ch]->mStreamTime);
+					if (mVoice[ch]->mStopScheduler.mActive == -1)
 					{
-						mVoice[i]->mStopScheduler.mActive = 0;
-						stopVoice_internal(i);
+						mVoice[ch]->mStopScheduler.mActive = 0;
+						stopVoice_internal(ch);
 					}
 				}
+
+				// A virtual voice that would have played to its end
+				if (mVoice[ch] &&
+					(mVoice[ch]->mFlags & (AudioSourceInstance::VIRTUAL | AudioSourceInstance::LOOPING)) == AudioSourceInstance::VIRTUAL &&
+					mVoice[ch]->mStreamPosition >= mVoice[ch]->getLength())
+				{
+					stopVoice_internal(ch);
+				}
+			}
+
+			// Faders that have run their course stay put, so their voices can leave the list
+			AudioSourceInstance *v = mVoice[ch];
+			if (v && (v->mRelativePlaySpeedFader.mActive > 0 ||
+				v->mVolumeFader.mActive > 0 ||
+				v->mPanFader.mActive > 0 ||
+				v->mPauseScheduler.mActive ||
+				v->mStopScheduler.mActive ||
+				(v->mFlags & (AudioSourceInstance::VIRTUAL | AudioSourceInstance::LOOPING)) == AudioSourceInstance::VIRTUAL))
+			{
+				mFaderVoice[listed] = ch;
+				listed++;
+			}
+			else
+			{
+				if (v)
+					v->mActiveFader = 0;
+				mFaderVoiceListed[ch] = 0;
 			}
 		}
+		mFaderVoiceCount = listed;
 
+		int i;
 		if (mActiveVoiceDirty)
 			calcActiveVoices_internal();
 
@@ -2019,166 +2120,166 @@ namespace SoLoud
 				}
 			}
 		}
+
+		if (mFlags & ENABLE_GOVERNOR)
+		{
+			updateGovernor_internal(aSamples, Thread::getTimeMicros() - mixstart);
+		}
 	}
 
 	void Soloud::mix(float *aBuffer, unsigned int aSamples)
 	{
+		if (mMixAheadThread)
+		{
+			readMixAhead_internal(aBuffer, aSamples, SAMPLE_FLOAT32);
+			return;
+		}
 		mix_internal(aSamples);
-		interlace_samples_float(mScratch.mData, aBuffer, aSamples, mChannels);
+		interlace_samples(mScratch.mData, aSamples, aBuffer, SAMPLE_FLOAT32, aSamples, mChannels, 0, mSimdLevel);
 	}
 
 	void Soloud::mixSigned16(short *aBuffer, unsigned int aSamples)
 	{
+		if (mMixAheadThread)
+		{
+			readMixAhead_internal(aBuffer, aSamples, SAMPLE_S16);
+			return;
+		}
 		mix_internal(aSamples);
-		interlace_samples_s16(mScratch.mData, aBuffer, aSamples, mChannels);
+		interlace_samples(mScratch.mData, aSamples, aBuffer, SAMPLE_S16, aSamples, mChannels, (mFlags & DITHER_OUTPUT) ? &mDitherSeed : 0, mSimdLevel);
 	}
 
-	void deinterlace_samples_float(const float *aSourceBuffer, float *aDestBuffer, unsigned int aSamples, unsigned int aChannels)
+	void Soloud::applyAudioThreadScheduling_internal()
 	{
-		// 121212 -> 111222
-		unsigned int i, j, c;
-		c = 0;
-		for (j = 0; j < aChannels; j++)
-		{
-			for (i = j; i < aSamples; i += aChannels)
-			{
-				aDestBuffer[c] = aSourceBuffer[i + j];
-				c++;
-			}
-		}
+		if (mAudioThreadPolicy != SCHEDULE_NORMAL)
+			mAppliedAudioThreadPolicy = Thread::setThreadScheduling(mAudioThreadPolicy, mAudioThreadPriority);
+		if (mAudioThreadCoreMask)
+			mAppliedAudioThreadCoreMask = Thread::setThreadAffinity(mAudioThreadCoreMask);
 	}
 
-	void interlace_samples_float(const float *aSourceBuffer, float *aDestBuffer, unsigned int aSamples, unsigned int aChannels)
+	static void mixAheadThread(void *aParam)
+	{
+		Soloud *soloud = (Soloud *)aParam;
+		soloud->applyAudioThreadScheduling_internal();
+		soloud->mixAhead_internal();
+	}
+
+	result Soloud::startMixAhead_internal()
 	{
-		// 111222 -> 121212
-		unsigned int i, j, c;
-		c = 0;
-		for (j = 0; j < aChannels; j++)
+		mMixAheadRingBlockSize = mMixAheadBlockSize ? mMixAheadBlockSize : mGranularity;
+		if (mMixAheadRing.init(mMixAheadBlocks * mMixAheadRingBlockSize * mChannels) != SO_NO_ERROR)
+			return OUT_OF_MEMORY;
+		mMixAheadWritten = 0;
+		mMixAheadRead = 0;
+		mMixAheadWriteBlock = 0;
+		mMixAheadReadBlock = 0;
+		mMixAheadReadOffset = 0;
+		mMixAheadUnderruns = 0;
+		mMixAheadMutex = Thread::createMutex();
+		mMixAheadCondition = Thread::createCondition();
+		mMixAheadRunning = 1;
+		mMixAheadThread = Thread::createThread(mixAheadThread, this);
+		if (mMixAheadThread == NULL)
 		{
-			for (i = j; i < aSamples * aChannels; i += aChannels)
-			{
-				aDestBuffer[i] = aSourceBuffer[c];
-				c++;
-			}
+			stopMixAhead_internal();
+			return UNKNOWN_ERROR;
 		}
+		return SO_NO_ERROR;
 	}
 
-#if 0 // defined(SOLOUD_SSE_INTRINSICS) && defined(_M_IX86)
-	/* There are several issues with this code.
-	   - Doesn't work in x64, because __m64 doesn't exist there.
-	   - Assumes aDestBuffer is well aligned; this is not guaranteed
-	   - (didn't call _mm_clear, but that was an easy fix)
-	   Leaving it here for future reference for now if a more 
-	   working solution is found.
-	 */
-	void interlace_samples_s16_mono(const float *aSourceBuffer, short *aDestBuffer, unsigned int aSamples)
+	void Soloud::stopMixAhead_internal()
 	{
-		const __m128 scale = _mm_set1_ps(0x7fff);
-		const unsigned int blockSize = 16;
-		const unsigned int numBlocks = aSamples / blockSize;
-		SOLOUD_ASSERT((aSamples % blockSize) == 0);
-
-		for (unsigned int i = 0; i < numBlocks; ++i)
+		if (mMixAheadThread)
 		{
-			// A0 A1 A2 A3 B0 B1 B2 B3 -> A0 A1 A2 A3 B0 B1 B2 B3 (float -> short)
-			__m128 s0 = _mm_load_ps(&aSourceBuffer[16 * i + 0]);
-			__m128 s1 = _mm_load_ps(&aSourceBuffer[16 * i + 4]);
-			__m128 s2 = _mm_load_ps(&aSourceBuffer[16 * i + 8]);
-			__m128 s3 = _mm_load_ps(&aSourceBuffer[16 * i + 12]);
-
-			__m64 d0 = _mm_cvtps_pi16(_mm_mul_ps(s0, scale));
-			__m64 d1 = _mm_cvtps_pi16(_mm_mul_ps(s1, scale));
-			__m64 d2 = _mm_cvtps_pi16(_mm_mul_ps(s2, scale));
-			__m64 d3 = _mm_cvtps_pi16(_mm_mul_ps(s3, scale));
-
-			__m128i u = _mm_setr_epi64(d0, d1);
-			__m128i v = _mm_setr_epi64(d2, d3);
-
-			_mm_store_si128(reinterpret_cast<__m128i *>(&aDestBuffer[16 * i + 0]), u);
-			_mm_store_si128(reinterpret_cast<__m128i *>(&aDestBuffer[16 * i + 8]), v);
+			// The thread checks the flag under the mutex before waiting, so it can't miss this wakeup
+			Thread::lockMutex(mMixAheadMutex);
+			mMixAheadRunning = 0;
+			Thread::broadcastCondition(mMixAheadCondition);
+			Thread::unlockMutex(mMixAheadMutex);
+			Thread::wait(mMixAheadThread);
+			Thread::release(mMixAheadThread);
+			mMixAheadThread = NULL;
 		}
+		mMixAheadRunning = 0;
+		if (mMixAheadCondition)
+			Thread::destroyCondition(mMixAheadCondition);
+		mMixAheadCondition = NULL;
+		if (mMixAheadMutex)
+			Thread::destroyMutex(mMixAheadMutex);
+		mMixAheadMutex = NULL;
+	}
 
-		_mm_empty();
-
-		const unsigned int offset = blockSize * numBlocks;
-		for (unsigned int i = offset; i < aSamples; ++i)
+	void Soloud::mixAhead_internal()
+	{
+		unsigned int blockfloats = mMixAheadRingBlockSize * mChannels;
+		while (mMixAheadRunning)
 		{
-			aDestBuffer[i] = static_cast<short>(aSourceBuffer[i] * 0x7fff);
+			if (mMixAheadWritten - Thread::atomicLoad(&mMixAheadRead) >= mMixAheadBlocks)
+			{
+				// The back-end signals under the mutex, so its wakeup can't slip in between the check and the wait
+				Thread::lockMutex(mMixAheadMutex);
+				if (mMixAheadRunning && mMixAheadWritten - Thread::atomicLoad(&mMixAheadRead) >= mMixAheadBlocks)
+					Thread::waitCondition(mMixAheadCondition, mMixAheadMutex);
+				Thread::unlockMutex(mMixAheadMutex);
+				continue;
+			}
+			mix_internal(mMixAheadRingBlockSize);
+			memcpy(mMixAheadRing.mData + mMixAheadWriteBlock * blockfloats, mScratch.mData, sizeof(float) * blockfloats);
+			mMixAheadWriteBlock = (mMixAheadWriteBlock + 1) % mMixAheadBlocks;
+			Thread::atomicStore(&mMixAheadWritten, mMixAheadWritten + 1);
 		}
 	}
 
-	void interlace_samples_s16_stereo(const float *aSourceBuffer, short *aDestBuffer, unsigned int aSamples)
+	void Soloud::readMixAhead_internal(void *aBuffer, unsigned int aSamples, unsigned int aFormat)
 	{
-		const __m128 scale = _mm_set1_ps(0x7fff);
-		const unsigned int blockSize = 8u;
-		const unsigned int numBlocks = aSamples / blockSize;
-		SOLOUD_ASSERT((aSamples % blockSize) == 0);
-
-		for (unsigned int i = 0; i < numBlocks; ++i)
+		unsigned char *dst = (unsigned char *)aBuffer;
+		unsigned int framesize = sample_format_size(aFormat) * mChannels;
+		unsigned int blockfloats = mMixAheadRingBlockSize * mChannels;
+		unsigned int done = 0;
+		bool freed = false;
+		while (done < aSamples && Thread::atomicLoad(&mMixAheadWritten) != mMixAheadRead)
 		{
-			// A0 A1 A2 A3 B0 B1 B2 B3 -> A0 B0 A1 B1 A2 B2 A3 B3
-			__m128 a0 = _mm_load_ps(&aSourceBuffer[8 * i + 0]);
-			__m128 a1 = _mm_load_ps(&aSourceBuffer[8 * i + 4]);
-			__m128 b0 = _mm_load_ps(&aSourceBuffer[aSamples + 8 * i + 0]);
-			__m128 b1 = _mm_load_ps(&aSourceBuffer[aSamples + 8 * i + 4]);
-
-			__m128 x = _mm_unpacklo_ps(a0, b0);
-			__m128 y = _mm_unpackhi_ps(a0, b0);
-			__m128 z = _mm_unpacklo_ps(a1, b1);
-			__m128 w = _mm_unpackhi_ps(a1, b1);
-
-			__m64 d0 = _mm_cvtps_pi16(_mm_mul_ps(x, scale));
-			__m64 d1 = _mm_cvtps_pi16(_mm_mul_ps(y, scale));
-			__m64 d2 = _mm_cvtps_pi16(_mm_mul_ps(z, scale));
-			__m64 d3 = _mm_cvtps_pi16(_mm_mul_ps(w, scale));
-
-			__m128i u = _mm_setr_epi64(d0, d1);
-			__m128i v = _mm_setr_epi64(d2, d3);
-
-			_mm_store_si128(reinterpret_cast<__m128i *>(&aDestBuffer[16 * i + 0]), u);
-			_mm_store_si128(reinterpret_cast<__m128i *>(&aDestBuffer[16 * i + 8]), v);
+			unsigned int samples = mMixAheadRingBlockSize - mMixAheadReadOffset;
+			if (samples > aSamples - done)
+				samples = aSamples - done;
+			interlace_samples(mMixAheadRing.mData + mMixAheadReadBlock * blockfloats + mMixAheadReadOffset, mMixAheadRingBlockSize,
+				dst + done * framesize, aFormat, samples, mChannels, (aFormat != SAMPLE_FLOAT32 && (mFlags & DITHER_OUTPUT)) ? &mDitherSeed : 0, mSimdLevel);
+			done += samples;
+			mMixAheadReadOffset += samples;
+			if (mMixAheadReadOffset == mMixAheadRingBlockSize)
+			{
+				mMixAheadReadOffset = 0;
+				mMixAheadReadBlock = (mMixAheadReadBlock + 1) % mMixAheadBlocks;
+				Thread::atomicStore(&mMixAheadRead, mMixAheadRead + 1);
+				freed = true;
+			}
 		}
-
-		_mm_empty();
-
-		const unsigned int offset = blockSize * numBlocks;
-		for (unsigned int i = offset; i < aSamples; ++i)
+		if (freed)
 		{
-			aDestBuffer[2 * i + 0] = static_cast<short>(aSourceBuffer[i] * 0x7fff);
-			aDestBuffer[2 * i + 1] = static_cast<short>(aSourceBuffer[i + aSamples] * 0x7fff);
+			Thread::lockMutex(mMixAheadMutex);
+			Thread::signalCondition(mMixAheadCondition);
+			Thread::unlockMutex(mMixAheadMutex);
+		}
+		if (done < aSamples)
+		{
+			memset(dst + done * framesize, 0, (aSamples - done) * framesize);
+			mMixAheadUnderruns++;
 		}
 	}
-#endif
 
-	void interlace_samples_s16(const float *aSourceBuffer, short *aDestBuffer, unsigned int aSamples, unsigned int aChannels)
+	void deinterlace_samples_float(const float *aSourceBuffer, float *aDestBuffer, unsigned int aSamples, unsigned int aChannels)
 	{
-#if 0 // defined(SOLOUD_SSE_INTRINSICS) && defined(_M_IX86)
-		switch (aChannels)
-		{
-		case 1:
-			interlace_samples_s16_mono(aSourceBuffer, aDestBuffer, aSamples);
-			return;
-
-		case 2:
-			interlace_samples_s16_stereo(aSourceBuffer, aDestBuffer, aSamples);
-			return;
+		deinterlace_samples(aSourceBuffer, SAMPLE_FLOAT32, aChannels, aDestBuffer, aSamples, aSamples, aChannels);
+	}
 
-		default:
-			break;
-		}
-#endif
+	void interlace_samples_float(const float *aSourceBuffer, float *aDestBuffer, unsigned int aSamples, unsigned int aChannels)
+	{
+		interlace_samples(aSourceBuffer, aSamples, aDestBuffer, SAMPLE_FLOAT32, aSamples, aChannels);
+	}
 
-		// 111222 -> 121212
-		unsigned int i, j, c;
-		c = 0;
-		for (j = 0; j < aChannels; j++)
-		{
-			for (i = j; i < aSamples * aChannels; i += aChannels)
-			{
-				aDestBuffer[i] = (short)(aSourceBuffer[c] * 0x7fff);
-				c++;
-			}
-		}
+	void interlace_samples_s16(const float *aSourceBuffer, short *aDestBuffer, unsigned int aSamples, unsigned int aChannels)
+	{
+		interlace_samples(aSourceBuffer, aSamples, aDestBuffer, SAMPLE_S16, aSamples, aChannels);
 	}
 
 	void Soloud::lockAudioMutex_internal()
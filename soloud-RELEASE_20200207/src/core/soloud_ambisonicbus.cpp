@@ -0,0 +1,335 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+
+#include <math.h>
+#include "soloud.h"
+#include "soloud_ambisonicbus.h"
+#include "soloud_internal.h"
+#include "soloud_simd.h"
+
+namespace SoLoud
+{
+	void calc_ambisonic_gains(float *aGain, const float *aDirection, unsigned int aChannels)
+	{
+		// Ambisonic axes are x to the front, y to the left and z up; map them from
+		// world space as seen by the default listener, looking down -z with y up.
+		float x = -aDirection[2];
+		float y = -aDirection[0];
+		float z = aDirection[1];
+		unsigned int i;
+		for (i = 0; i < aChannels; i++)
+			aGain[i] = 0;
+		aGain[0] = 1;
+		if (x == 0 && y == 0 && z == 0)
+			return;
+
+		if (aChannels >= 4)
+		{
+			aGain[1] = y;
+			aGain[2] = z;
+			aGain[3] = x;
+		}
+		if (aChannels >= 9)
+		{
+			aGain[4] = 1.7320508f * x * y;
+			aGain[5] = 1.7320508f * y * z;
+			aGain[6] = 0.5f * (3 * z * z - 1);
+			aGain[7] = 1.7320508f * x * z;
+			aGain[8] = 0.8660254f * (x * x - y * y);
+		}
+		if (aChannels >= 16)
+		{
+			aGain[9] = 0.7905694f * y * (3 * x * x - y * y);
+			aGain[10] = 3.8729833f * x * y * z;
+			aGain[11] = 0.6123724f * y * (5 * z * z - 1);
+			aGain[12] = 0.5f * z * (5 * z * z - 3);
+			aGain[13] = 0.6123724f * x * (5 * z * z - 1);
+			aGain[14] = 1.9364917f * z * (x * x - y * y);
+			aGain[15] = 0.7905694f * x * (x * x - 3 * y * y);
+		}
+	}
+
+	void fold_to_mono(float *aBuffer, unsigned int aSamples, unsigned int aBufferSize, unsigned int aChannels)
+	{
+		if (aChannels < 2)
+			return;
+		float scale = 1.0f / aChannels;
+		unsigned int i, j;
+		for (i = 0; i < aSamples; i++)
+		{
+			float sample = aBuffer[i];
+			for (j = 1; j < aChannels; j++)
+				sample += aBuffer[i + aBufferSize * j];
+			aBuffer[i] = sample * scale;
+		}
+	}
+
+	void encode_ambisonic(const SimdKernels *aSimd, AudioSourceInstance *aVoice, const float *aSource, float *aBuffer, unsigned int aSamples, unsigned int aBufferSize, unsigned int aChannels, float aVolume)
+	{
+		float gain[AMBISONIC_MAX_CHANNELS];
+		calc_ambisonic_gains(gain, aVoice->m3dDirection, aChannels);
+		unsigned int i;
+		for (i = 0; i < aChannels; i++)
+		{
+			float target = gain[i] * aVolume;
+			float current = aVoice->mCurrentAmbisonicGain[i];
+			if (target != 0 || current != 0)
+				aSimd->mixRamp(aSource, aBuffer + aBufferSize * i, aSamples, current, (target - current) / aSamples);
+			aVoice->mCurrentAmbisonicGain[i] = target;
+		}
+	}
+
+	// Sum of squared speaker gains for a sound in the given direction
+	static float decodedEnergy(const float *aDecoder, const float *aDirection, unsigned int aChannels, unsigned int aBChannels)
+	{
+		float gain[AMBISONIC_MAX_CHANNELS];
+		calc_ambisonic_gains(gain, aDirection, aBChannels);
+		float energy = 0;
+		unsigned int i, k;
+		for (i = 0; i < aChannels; i++)
+		{
+			float g = 0;
+			for (k = 0; k < aBChannels; k++)
+				g += aDecoder[i * AMBISONIC_MAX_CHANNELS + k] * gain[k];
+			energy += g * g;
+		}
+		return energy;
+	}
+
+	AmbisonicBusInstance::AmbisonicBusInstance(AmbisonicBus *aParent) : BusInstance(aParent)
+	{
+		mOrder = aParent->mOrder;
+		int i;
+		for (i = 0; i < MAX_CHANNELS * AMBISONIC_MAX_CHANNELS; i++)
+			mDecoder[i] = 0;
+	}
+
+	unsigned int AmbisonicBusInstance::getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize)
+	{
+		unsigned int i, j, k;
+		// The decoder accumulates, so start from silence
+		for (i = 0; i < aBufferSize * mChannels; i++)
+			aBuffer[i] = 0;
+
+		int handle = mParent->mChannelHandle;
+		if (handle == 0)
+			return aSamplesToRead;
+
+		Soloud *s = mParent->mSoloud;
+		if (s->mScratchNeeded != mScratchSize)
+		{
+			mScratchSize = s->mScratchNeeded;
+			mScratch.init(mScratchSize * MAX_CHANNELS);
+			mBFormat.init(mScratchSize * AMBISONIC_MAX_CHANNELS);
+		}
+
+		unsigned int bchannels = (mOrder + 1) * (mOrder + 1);
+		s->mixBus_internal(mBFormat.mData, aSamplesToRead, aBufferSize, mScratch.mData, handle, mSamplerate, bchannels, this);
+
+		// Decode once for the whole bus. Listener rotation only changes the
+		// decode matrix, which is ramped over the block like voice volumes.
+		float decoder[MAX_CHANNELS * AMBISONIC_MAX_CHANNELS];
+		calcDecoder_internal(decoder);
+		for (j = 0; j < mChannels; j++)
+		{
+			for (k = 0; k < bchannels; k++)
+			{
+				float from = mDecoder[j * AMBISONIC_MAX_CHANNELS + k];
+				float to = decoder[j * AMBISONIC_MAX_CHANNELS + k];
+				if (from != 0 || to != 0)
+					s->mSimd->mixRamp(mBFormat.mData + aBufferSize * k, aBuffer + aBufferSize * j, aSamplesToRead, from, (to - from) / aSamplesToRead);
+				mDecoder[j * AMBISONIC_MAX_CHANNELS + k] = to;
+			}
+		}
+
+		updateVisualization_internal(aBuffer, aSamplesToRead, aBufferSize);
+		return aSamplesToRead;
+	}
+
+	// Build a projection decoder with max-rE weighting, scaled so that a sound in the
+	// direction of a speaker comes out at unit energy on average.
+	static void buildDecoder(float *aDecoder, const float *aSpeaker, const bool *aLive, unsigned int aChannels, unsigned int aSpeakers, unsigned int aOrder)
+	{
+		// max-rE weights for each order band, by decode order
+		static const float maxre[AMBISONIC_MAX_ORDER + 1][AMBISONIC_MAX_ORDER + 1] =
+		{
+			{ 1, 0, 0, 0 },
+			{ 1, 0.577350f, 0, 0 },
+			{ 1, 0.774597f, 0.4f, 0 },
+			{ 1, 0.861136f, 0.612334f, 0.304747f }
+		};
+		unsigned int bchannels = (aOrder + 1) * (aOrder + 1);
+		unsigned int i, j, k;
+		for (i = 0; i < MAX_CHANNELS * AMBISONIC_MAX_CHANNELS; i++)
+			aDecoder[i] = 0;
+
+		for (i = 0; i < aChannels; i++)
+		{
+			if (!aLive[i])
+				continue;
+			float *row = aDecoder + i * AMBISONIC_MAX_CHANNELS;
+			calc_ambisonic_gains(row, aSpeaker + 3 * i, bchannels);
+			for (k = 0; k < bchannels; k++)
+			{
+				unsigned int n = (k >= 9) ? 3 : (k >= 4) ? 2 : (k >= 1) ? 1 : 0;
+				row[k] *= maxre[aOrder][n] * (2 * n + 1);
+			}
+		}
+
+		float energy = 0;
+		for (j = 0; j < aChannels; j++)
+		{
+			if (aLive[j])
+				energy += decodedEnergy(aDecoder, aSpeaker + 3 * j, aChannels, bchannels);
+		}
+		float scale = (float)sqrt(aSpeakers / energy);
+		float omni = 0;
+		for (i = 0; i < aChannels; i++)
+		{
+			for (k = 0; k < bchannels; k++)
+				aDecoder[i * AMBISONIC_MAX_CHANNELS + k] *= scale;
+			omni += aDecoder[i * AMBISONIC_MAX_CHANNELS];
+		}
+
+		// Null speakers (such as the subwoofer) get the omnidirectional part
+		omni /= aSpeakers;
+		for (i = 0; i < aChannels; i++)
+		{
+			if (!aLive[i])
+				aDecoder[i * AMBISONIC_MAX_CHANNELS] = omni;
+		}
+	}
+
+	void AmbisonicBusInstance::pan(Soloud *aSoloud, AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels)
+	{
+		// Sounds are encoded as point sources, so fold multichannel voices to mono first
+		fold_to_mono(aScratch, aSamplesToRead, aBufferSize, aVoice->mChannels);
+		encode_ambisonic(aSoloud->mSimd, aVoice, aScratch, aBuffer, aSamplesToRead, aBufferSize, aChannels, aVoice->mOverallVolume);
+	}
+
+	void AmbisonicBusInstance::calcDecoder_internal(float *aDecoder)
+	{
+		float speaker[3 * MAX_CHANNELS];
+		bool live[MAX_CHANNELS];
+		mParent->mSoloud->get3dSpeakerDirections_internal(speaker);
+
+		unsigned int i, j, k;
+		unsigned int speakers = 0;
+		for (i = 0; i < mChannels; i++)
+		{
+			live[i] = speaker[3 * i + 0] != 0 || speaker[3 * i + 1] != 0 || speaker[3 * i + 2] != 0;
+			if (live[i])
+				speakers++;
+		}
+
+		if (speakers == 0)
+		{
+			for (i = 0; i < MAX_CHANNELS * AMBISONIC_MAX_CHANNELS; i++)
+				aDecoder[i] = 0;
+			for (i = 0; i < mChannels; i++)
+				aDecoder[i * AMBISONIC_MAX_CHANNELS] = 1;
+			return;
+		}
+
+		// A ring of speakers resolves order N with 2N+1 speakers; stereo still gets first order
+		unsigned int order = mOrder;
+		if (speakers < 7 && order > 2)
+			order = 2;
+		if (speakers < 5 && order > 1)
+			order = 1;
+		if (speakers < 2)
+			order = 0;
+
+		// Irregular layouts leave holes at high orders. Step the order down until the
+		// loudness at the speakers and between each pair of them stays within 3dB.
+		while (order > 1)
+		{
+			unsigned int bchannels = (order + 1) * (order + 1);
+			buildDecoder(aDecoder, speaker, live, mChannels, speakers, order);
+			float minenergy = 1e30f;
+			float maxenergy = 0;
+			for (i = 0; i < mChannels; i++)
+			{
+				for (j = i; live[i] && j < mChannels; j++)
+				{
+					if (!live[j])
+						continue;
+					float dir[3];
+					float mag = 0;
+					for (k = 0; k < 3; k++)
+					{
+						dir[k] = speaker[3 * i + k] + speaker[3 * j + k];
+						mag += dir[k] * dir[k];
+					}
+					// Opposite speakers have no midpoint
+					if (mag < 0.01f)
+						continue;
+					mag = 1 / (float)sqrt(mag);
+					for (k = 0; k < 3; k++)
+						dir[k] *= mag;
+					float energy = decodedEnergy(aDecoder, dir, mChannels, bchannels);
+					if (energy < minenergy)
+						minenergy = energy;
+					if (energy > maxenergy)
+						maxenergy = energy;
+				}
+			}
+			if (maxenergy <= minenergy * 2)
+				return;
+			order--;
+		}
+		buildDecoder(aDecoder, speaker, live, mChannels, speakers, order);
+	}
+
+	AmbisonicBus::AmbisonicBus()
+	{
+		mOrder = 1;
+	}
+
+	BusInstance * AmbisonicBus::createInstance()
+	{
+		if (mChannelHandle)
+		{
+			stop();
+			mChannelHandle = 0;
+			mInstance = 0;
+		}
+		mInstance = new AmbisonicBusInstance(this);
+		return mInstance;
+	}
+
+	result AmbisonicBus::setOrder(unsigned int aOrder)
+	{
+		if (aOrder < 1 || aOrder > AMBISONIC_MAX_ORDER)
+			return INVALID_PARAMETER;
+		mOrder = aOrder;
+		return SO_NO_ERROR;
+	}
+
+	unsigned int AmbisonicBus::getOrder()
+	{
+		return mOrder;
+	}
+};
@@ -49,6 +49,9 @@ namespace SoLoud
 		mHandle = 0;
 		for (int i = 0; i < MAX_CHANNELS; i++)
 			mChannelVolume[i] = 0;
+		m3dDirection[0] = 0;
+		m3dDirection[1] = 0;
+		m3dDirection[2] = 0;
 	}
 
 	void AudioSourceInstance3dData::init(AudioSource &aSource)
@@ -86,6 +89,8 @@ namespace SoLoud
 		mBusHandle = ~0u;
 		mLoopCount = 0;
 		mLoopPoint = 0;
+		mAudibilityThreshold = -1;
+		mRetireNext = NULL;
 		for (i = 0; i < FILTERS_PER_STREAM; i++)
 		{
 			mFilter[i] = NULL;
@@ -94,11 +99,20 @@ namespace SoLoud
 		{
 			mCurrentChannelVolume[i] = 0;
 		}
+		for (i = 0; i < AMBISONIC_MAX_CHANNELS; i++)
+		{
+			mCurrentAmbisonicGain[i] = 0;
+		}
+		m3dDirection[0] = 0;
+		m3dDirection[1] = 0;
+		m3dDirection[2] = 0;
 		// behind pointers because we swap between the two buffers
 		mResampleData[0] = 0;
 		mResampleData[1] = 0;
 		mSrcOffset = 0;
 		mLeftoverSamples = 0;
+		mDirectData = NULL;
+		mDirectPitch = 0;
 		mDelaySamples = 0;
 		mOverallVolume = 0;
 		mOverallRelativePlaySpeed = 1;
@@ -122,6 +136,7 @@ namespace SoLoud
 		mStreamTime = 0.0f;
 		mStreamPosition = 0.0f;
 		mLoopPoint = aSource.mLoopPoint;
+		mAudibilityThreshold = aSource.mAudibilityThreshold;
 
 		if (aSource.mFlags & AudioSource::SHOULD_LOOP)
 		{
@@ -150,6 +165,11 @@ namespace SoLoud
 		return NOT_IMPLEMENTED;
 	}
 
+	time AudioSourceInstance::getLength()
+	{
+		return 0;
+	}
+
 	result AudioSourceInstance::seek(double aSeconds, float *mScratch, unsigned int mScratchSize)
 	{
 		double offset = aSeconds - mStreamPosition;
@@ -199,6 +219,7 @@ namespace SoLoud
 		mColliderData = 0;
 		mVolume = 1;
 		mLoopPoint = 0;
+		mAudibilityThreshold = -1;
 	}
 
 	AudioSource::~AudioSource() 
@@ -313,6 +334,11 @@ namespace SoLoud
 		mAttenuator = aAttenuator;
 	}
 
+	void AudioSource::setAudibilityThreshold(float aThreshold)
+	{
+		mAudibilityThreshold = aThreshold;
+	}
+
 	void AudioSource::setInaudibleBehavior(bool aMustTick, bool aKill)
 	{
 		mFlags &= ~(AudioSource::INAUDIBLE_KILL | AudioSource::INAUDIBLE_TICK);
@@ -332,6 +358,15 @@ namespace SoLoud
 	    return 0;
 	}
 
+	const float *AudioSourceInstance::getDirectData(unsigned int * /*aSampleCount*/, unsigned int * /*aPosition*/)
+	{
+		return NULL;
+	}
+
+	void AudioSourceInstance::skipDirectData(unsigned int /*aSamples*/)
+	{
+	}
+
 
 };
 
@@ -32,7 +32,7 @@ namespace SoLoud
 	{
 		mParent = aParent;
 		mScratchSize = 0;
-		mFlags |= PROTECTED | INAUDIBLE_TICK;		
+		mFlags |= PROTECTED | INAUDIBLE_TICK | BUS;
 		for (int i = 0; i < MAX_CHANNELS; i++)
 			mVisualizationChannelVolume[i] = 0;
 		for (int i = 0; i < 256; i++)
@@ -60,6 +60,12 @@ namespace SoLoud
 		
 		s->mixBus_internal(aBuffer, aSamplesToRead, aBufferSize, mScratch.mData, handle, mSamplerate, mChannels);
 
+		updateVisualization_internal(aBuffer, aSamplesToRead, aBufferSize);
+		return aSamplesToRead;
+	}
+
+	void BusInstance::updateVisualization_internal(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize)
+	{
 		int i;
 		if (mParent->mFlags & AudioSource::VISUALIZATION_DATA)
 		{
@@ -100,7 +106,6 @@ namespace SoLoud
 				}
 			}
 		}
-		return aSamplesToRead;
 	}
 
 	bool BusInstance::hasEnded()
@@ -111,15 +116,7 @@ namespace SoLoud
 
 	BusInstance::~BusInstance()
 	{
-		Soloud *s = mParent->mSoloud;
-		int i;
-		for (i = 0; i < (signed)s->mHighestVoice; i++)
-		{
-			if (s->mVoice[i] && s->mVoice[i]->mBusHandle == mParent->mChannelHandle)
-			{
-				s->stopVoice_internal(i);
-			}
-		}
+		// The voices playing on this bus were stopped along with it; see Soloud::stopVoice_internal
 	}
 
 	Bus::Bus()
@@ -228,11 +225,28 @@ namespace SoLoud
 		return mSoloud->play3dClocked(aSoundTime, aSound, aPosX, aPosY, aPosZ, aVelX, aVelY, aVelZ, aVolume, mChannelHandle);
 	}
 
+	unsigned int Bus::playScheduled(time aStartTime, AudioSource &aSound, float aVolume, float aPan)
+	{
+		if (!mInstance || !mSoloud)
+		{
+			return 0;
+		}
+
+		findBusHandle();
+
+		if (mChannelHandle == 0)
+		{
+			return 0;
+		}
+		return mSoloud->playScheduled(aStartTime, aSound, aVolume, aPan, mChannelHandle);
+	}
+
 	void Bus::annexSound(handle aVoiceHandle)
 	{
 		findBusHandle();
 		FOR_ALL_VOICES_PRE_EXT
 			mSoloud->mVoice[ch]->mBusHandle = mChannelHandle;
+			mSoloud->mActiveVoiceDirty = true;
 		FOR_ALL_VOICES_POST_EXT
 	}
 
@@ -339,7 +353,7 @@ namespace SoLoud
 		unsigned int count = 0;
 		findBusHandle();
 		mSoloud->lockAudioMutex_internal();
-		for (i = 0; i < VOICE_COUNT; i++)
+		for (i = 0; i < (signed)mSoloud->mHighestVoice; i++)
 			if (mSoloud->mVoice[i] && mSoloud->mVoice[i]->mBusHandle == mChannelHandle)
 				count++;
 		mSoloud->unlockAudioMutex_internal();
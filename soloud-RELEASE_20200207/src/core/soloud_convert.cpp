@@ -0,0 +1,530 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include <string.h>
+#include <math.h>
+#include "soloud.h"
+#include "soloud_simd.h"
+#include "soloud_convert.h"
+
+// Integer conversions go through a float buffer of this many frames at a time
+#define CONVERT_CHUNK 256
+
+namespace SoLoud
+{
+	struct ConvertKernels
+	{
+		// Scale to 16-bit, add aNoise (in LSBs, may be NULL), round and saturate
+		void (*floatToS16)(const float *aSrc, short *aDst, unsigned int aCount, const float *aNoise);
+		void (*s16ToFloat)(const short *aSrc, float *aDst, unsigned int aCount);
+		// Two planar channels to interlaced stereo
+		void (*interlace2)(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aSamples);
+		// Interlaced stereo to two planar channels
+		void (*deinterlace2)(const float *aSrc, float *aDst0, float *aDst1, unsigned int aSamples);
+	};
+
+	////////////////////////////////////////////////////////////
+	// Scalar kernels
+
+	static void floatToS16_scalar(const float *aSrc, short *aDst, unsigned int aCount, const float *aNoise)
+	{
+		unsigned int i;
+		for (i = 0; i < aCount; i++)
+		{
+			float f = aSrc[i] * 0x7fff;
+			if (aNoise)
+				f += aNoise[i];
+			f = (f < -32768.0f) ? -32768.0f : (f > 32767.0f) ? 32767.0f : f;
+			aDst[i] = (short)lrintf(f);
+		}
+	}
+
+	static void s16ToFloat_scalar(const short *aSrc, float *aDst, unsigned int aCount)
+	{
+		unsigned int i;
+		for (i = 0; i < aCount; i++)
+			aDst[i] = aSrc[i] / (float)0x8000;
+	}
+
+	static void interlace2_scalar(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aSamples)
+	{
+		unsigned int i;
+		for (i = 0; i < aSamples; i++)
+		{
+			aDst[i * 2] = aSrc0[i];
+			aDst[i * 2 + 1] = aSrc1[i];
+		}
+	}
+
+	static void deinterlace2_scalar(const float *aSrc, float *aDst0, float *aDst1, unsigned int aSamples)
+	{
+		unsigned int i;
+		for (i = 0; i < aSamples; i++)
+		{
+			aDst0[i] = aSrc[i * 2];
+			aDst1[i] = aSrc[i * 2 + 1];
+		}
+	}
+
+	static const ConvertKernels gScalarConvert =
+	{
+		floatToS16_scalar,
+		s16ToFloat_scalar,
+		interlace2_scalar,
+		deinterlace2_scalar
+	};
+
+#ifdef SOLOUD_SSE_INTRINSICS
+	////////////////////////////////////////////////////////////
+	// SSE2 kernels
+
+	SOLOUD_TARGET_SSE2
+	static void floatToS16_sse2(const float *aSrc, short *aDst, unsigned int aCount, const float *aNoise)
+	{
+		__m128 scale = _mm_set1_ps((float)0x7fff);
+		__m128 lo = _mm_set1_ps(-32768.0f);
+		__m128 hi = _mm_set1_ps(32767.0f);
+		unsigned int i;
+		for (i = 0; i + 8 <= aCount; i += 8)
+		{
+			__m128 a = _mm_mul_ps(_mm_loadu_ps(aSrc + i), scale);
+			__m128 b = _mm_mul_ps(_mm_loadu_ps(aSrc + i + 4), scale);
+			if (aNoise)
+			{
+				a = _mm_add_ps(a, _mm_loadu_ps(aNoise + i));
+				b = _mm_add_ps(b, _mm_loadu_ps(aNoise + i + 4));
+			}
+			// Clamp before converting; out of range floats convert to 0x80000000
+			a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+			b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+			_mm_storeu_si128((__m128i *)(aDst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+		}
+		if (i < aCount)
+			floatToS16_scalar(aSrc + i, aDst + i, aCount - i, aNoise ? aNoise + i : 0);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void s16ToFloat_sse2(const short *aSrc, float *aDst, unsigned int aCount)
+	{
+		__m128 scale = _mm_set1_ps(1 / (float)0x8000);
+		unsigned int i;
+		for (i = 0; i + 8 <= aCount; i += 8)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i *)(aSrc + i));
+			// Put each short in the top half of a 32-bit lane, then shift down with sign
+			__m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+			__m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+			_mm_storeu_ps(aDst + i, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+			_mm_storeu_ps(aDst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+		}
+		if (i < aCount)
+			s16ToFloat_scalar(aSrc + i, aDst + i, aCount - i);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void interlace2_sse2(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aSamples)
+	{
+		unsigned int i;
+		for (i = 0; i + 4 <= aSamples; i += 4)
+		{
+			__m128 a = _mm_loadu_ps(aSrc0 + i);
+			__m128 b = _mm_loadu_ps(aSrc1 + i);
+			_mm_storeu_ps(aDst + i * 2, _mm_unpacklo_ps(a, b));
+			_mm_storeu_ps(aDst + i * 2 + 4, _mm_unpackhi_ps(a, b));
+		}
+		if (i < aSamples)
+			interlace2_scalar(aSrc0 + i, aSrc1 + i, aDst + i * 2, aSamples - i);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void deinterlace2_sse2(const float *aSrc, float *aDst0, float *aDst1, unsigned int aSamples)
+	{
+		unsigned int i;
+		for (i = 0; i + 4 <= aSamples; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(aSrc + i * 2);
+			__m128 y = _mm_loadu_ps(aSrc + i * 2 + 4);
+			_mm_storeu_ps(aDst0 + i, _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(aDst1 + i, _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+		if (i < aSamples)
+			deinterlace2_scalar(aSrc + i * 2, aDst0 + i, aDst1 + i, aSamples - i);
+	}
+
+	static const ConvertKernels gSSE2Convert =
+	{
+		floatToS16_sse2,
+		s16ToFloat_sse2,
+		interlace2_sse2,
+		deinterlace2_sse2
+	};
+#endif
+
+#ifdef SOLOUD_AVX_INTRINSICS
+	////////////////////////////////////////////////////////////
+	// AVX2 kernels, also used for the AVX-512 level
+
+	SOLOUD_TARGET_AVX2
+	static void floatToS16_avx2(const float *aSrc, short *aDst, unsigned int aCount, const float *aNoise)
+	{
+		__m256 scale = _mm256_set1_ps((float)0x7fff);
+		__m256 lo = _mm256_set1_ps(-32768.0f);
+		__m256 hi = _mm256_set1_ps(32767.0f);
+		unsigned int i;
+		for (i = 0; i + 16 <= aCount; i += 16)
+		{
+			__m256 a = _mm256_mul_ps(_mm256_loadu_ps(aSrc + i), scale);
+			__m256 b = _mm256_mul_ps(_mm256_loadu_ps(aSrc + i + 8), scale);
+			if (aNoise)
+			{
+				a = _mm256_add_ps(a, _mm256_loadu_ps(aNoise + i));
+				b = _mm256_add_ps(b, _mm256_loadu_ps(aNoise + i + 8));
+			}
+			a = _mm256_min_ps(_mm256_max_ps(a, lo), hi);
+			b = _mm256_min_ps(_mm256_max_ps(b, lo), hi);
+			// Packing works within 128-bit lanes; put the quadwords back in order
+			__m256i s = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+			_mm256_storeu_si256((__m256i *)(aDst + i), _mm256_permute4x64_epi64(s, 0xd8));
+		}
+		if (i < aCount)
+			floatToS16_sse2(aSrc + i, aDst + i, aCount - i, aNoise ? aNoise + i : 0);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void s16ToFloat_avx2(const short *aSrc, float *aDst, unsigned int aCount)
+	{
+		__m256 scale = _mm256_set1_ps(1 / (float)0x8000);
+		unsigned int i;
+		for (i = 0; i + 8 <= aCount; i += 8)
+		{
+			__m256i s = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(aSrc + i)));
+			_mm256_storeu_ps(aDst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+		}
+		if (i < aCount)
+			s16ToFloat_scalar(aSrc + i, aDst + i, aCount - i);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void interlace2_avx2(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aSamples)
+	{
+		unsigned int i;
+		for (i = 0; i + 8 <= aSamples; i += 8)
+		{
+			__m256 a = _mm256_loadu_ps(aSrc0 + i);
+			__m256 b = _mm256_loadu_ps(aSrc1 + i);
+			// Unpacks work within 128-bit lanes; swap the middle halves back in order
+			__m256 lo = _mm256_unpacklo_ps(a, b);
+			__m256 hi = _mm256_unpackhi_ps(a, b);
+			_mm256_storeu_ps(aDst + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+			_mm256_storeu_ps(aDst + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+		}
+		if (i < aSamples)
+			interlace2_sse2(aSrc0 + i, aSrc1 + i, aDst + i * 2, aSamples - i);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void deinterlace2_avx2(const float *aSrc, float *aDst0, float *aDst1, unsigned int aSamples)
+	{
+		__m256i order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+		unsigned int i;
+		for (i = 0; i + 8 <= aSamples; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(aSrc + i * 2);
+			__m256 y = _mm256_loadu_ps(aSrc + i * 2 + 8);
+			// Shuffles work within lanes: gives a0 a1 a4 a5 a2 a3 a6 a7
+			__m256 a = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+			__m256 b = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+			_mm256_storeu_ps(aDst0 + i, _mm256_permutevar8x32_ps(a, order));
+			_mm256_storeu_ps(aDst1 + i, _mm256_permutevar8x32_ps(b, order));
+		}
+		if (i < aSamples)
+			deinterlace2_sse2(aSrc + i * 2, aDst0 + i, aDst1 + i, aSamples - i);
+	}
+
+	static const ConvertKernels gAVX2Convert =
+	{
+		floatToS16_avx2,
+		s16ToFloat_avx2,
+		interlace2_avx2,
+		deinterlace2_avx2
+	};
+#endif
+
+	static const ConvertKernels *getConvertKernels(unsigned int aMaxSimdLevel)
+	{
+		unsigned int level = detectSimdLevel();
+		if (level > aMaxSimdLevel)
+			level = aMaxSimdLevel;
+#ifdef SOLOUD_AVX_INTRINSICS
+		if (level >= Soloud::SIMD_AVX2)
+			return &gAVX2Convert;
+#endif
+#ifdef SOLOUD_SSE_INTRINSICS
+		if (level >= Soloud::SIMD_SSE2)
+			return &gSSE2Convert;
+#endif
+		return &gScalarConvert;
+	}
+
+	////////////////////////////////////////////////////////////
+	// Format conversion
+
+	// TPDF dither: sum of two uniform randoms, -1..1 LSB
+	static void makeDither(float *aNoise, unsigned int aCount, unsigned int *aSeed)
+	{
+		unsigned int seed = *aSeed;
+		unsigned int i;
+		for (i = 0; i < aCount; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			float r1 = (seed >> 8) * (1 / 16777216.0f);
+			seed = seed * 1664525 + 1013904223;
+			float r2 = (seed >> 8) * (1 / 16777216.0f);
+			aNoise[i] = r1 + r2 - 1.0f;
+		}
+		*aSeed = seed;
+	}
+
+	unsigned int sample_format_size(unsigned int aFormat)
+	{
+		switch (aFormat)
+		{
+		case SAMPLE_S16: return 2;
+		case SAMPLE_S24: return 3;
+		case SAMPLE_S32: return 4;
+		}
+		return 4;
+	}
+
+	// Float to any format, aCount up to CONVERT_CHUNK * MAX_CHANNELS samples
+	static void fromFloat(const ConvertKernels *aKernels, const float *aSrc, void *aDst, unsigned int aFormat, unsigned int aCount, unsigned int *aDitherSeed)
+	{
+		float noise[CONVERT_CHUNK * MAX_CHANNELS];
+		const float *n = 0;
+		if (aDitherSeed && aFormat != SAMPLE_FLOAT32)
+		{
+			makeDither(noise, aCount, aDitherSeed);
+			n = noise;
+		}
+		unsigned int i;
+		switch (aFormat)
+		{
+		case SAMPLE_FLOAT32:
+			memcpy(aDst, aSrc, aCount * sizeof(float));
+			break;
+		case SAMPLE_S16:
+			aKernels->floatToS16(aSrc, (short *)aDst, aCount, n);
+			break;
+		case SAMPLE_S24:
+			{
+				unsigned char *d = (unsigned char *)aDst;
+				for (i = 0; i < aCount; i++)
+				{
+					float f = aSrc[i] * 0x7fffff;
+					if (n)
+						f += n[i];
+					f = (f < -8388608.0f) ? -8388608.0f : (f > 8388607.0f) ? 8388607.0f : f;
+					int v = (int)lrintf(f);
+					d[i * 3] = (unsigned char)v;
+					d[i * 3 + 1] = (unsigned char)(v >> 8);
+					d[i * 3 + 2] = (unsigned char)(v >> 16);
+				}
+			}
+			break;
+		case SAMPLE_S32:
+			{
+				int *d = (int *)aDst;
+				for (i = 0; i < aCount; i++)
+				{
+					// Float doesn't have the bits for this; work in double
+					double f = aSrc[i] * 2147483647.0;
+					if (n)
+						f += n[i];
+					f = (f < -2147483648.0) ? -2147483648.0 : (f > 2147483647.0) ? 2147483647.0 : f;
+					d[i] = (int)lrint(f);
+				}
+			}
+			break;
+		}
+	}
+
+	// Any format to float, aCount up to CONVERT_CHUNK * MAX_CHANNELS samples
+	static void toFloat(const ConvertKernels *aKernels, const void *aSrc, unsigned int aFormat, float *aDst, unsigned int aCount)
+	{
+		unsigned int i;
+		switch (aFormat)
+		{
+		case SAMPLE_FLOAT32:
+			memcpy(aDst, aSrc, aCount * sizeof(float));
+			break;
+		case SAMPLE_S16:
+			aKernels->s16ToFloat((const short *)aSrc, aDst, aCount);
+			break;
+		case SAMPLE_S24:
+			{
+				const unsigned char *s = (const unsigned char *)aSrc;
+				for (i = 0; i < aCount; i++)
+				{
+					int v = s[i * 3] | (s[i * 3 + 1] << 8) | ((signed char)s[i * 3 + 2] << 16);
+					aDst[i] = v / (float)0x800000;
+				}
+			}
+			break;
+		case SAMPLE_S32:
+			{
+				const int *s = (const int *)aSrc;
+				for (i = 0; i < aCount; i++)
+					aDst[i] = (float)(s[i] / 2147483648.0);
+			}
+			break;
+		}
+	}
+
+	void convert_samples(const void *aSrc, unsigned int aSrcFormat, void *aDst, unsigned int aDstFormat, unsigned int aCount, unsigned int *aDitherSeed, unsigned int aMaxSimdLevel)
+	{
+		if (aSrcFormat >= SAMPLE_FORMAT_MAX || aDstFormat >= SAMPLE_FORMAT_MAX)
+			return;
+		if (aSrcFormat == aDstFormat)
+		{
+			memcpy(aDst, aSrc, aCount * sample_format_size(aSrcFormat));
+			return;
+		}
+		const ConvertKernels *k = getConvertKernels(aMaxSimdLevel);
+		const unsigned char *src = (const unsigned char *)aSrc;
+		unsigned char *dst = (unsigned char *)aDst;
+		unsigned int srcsize = sample_format_size(aSrcFormat);
+		unsigned int dstsize = sample_format_size(aDstFormat);
+		float tmp[CONVERT_CHUNK * MAX_CHANNELS];
+		unsigned int i;
+		for (i = 0; i < aCount; i += CONVERT_CHUNK * MAX_CHANNELS)
+		{
+			unsigned int n = aCount - i;
+			if (n > CONVERT_CHUNK * MAX_CHANNELS)
+				n = CONVERT_CHUNK * MAX_CHANNELS;
+			if (aSrcFormat == SAMPLE_FLOAT32)
+			{
+				fromFloat(k, (const float *)(src + i * srcsize), dst + i * dstsize, aDstFormat, n, aDitherSeed);
+			}
+			else if (aDstFormat == SAMPLE_FLOAT32)
+			{
+				toFloat(k, src + i * srcsize, aSrcFormat, (float *)(dst + i * dstsize), n);
+			}
+			else
+			{
+				toFloat(k, src + i * srcsize, aSrcFormat, tmp, n);
+				fromFloat(k, tmp, dst + i * dstsize, aDstFormat, n, aDitherSeed);
+			}
+		}
+	}
+
+	static void interlaceFloat(const ConvertKernels *aKernels, const float *aSrc, unsigned int aSrcPitch, float *aDst, unsigned int aSamples, unsigned int aChannels)
+	{
+		if (aChannels == 1)
+		{
+			memcpy(aDst, aSrc, aSamples * sizeof(float));
+			return;
+		}
+		if (aChannels == 2)
+		{
+			aKernels->interlace2(aSrc, aSrc + aSrcPitch, aDst, aSamples);
+			return;
+		}
+		unsigned int i, j;
+		for (j = 0; j < aChannels; j++)
+		{
+			const float *src = aSrc + aSrcPitch * j;
+			for (i = 0; i < aSamples; i++)
+				aDst[i * aChannels + j] = src[i];
+		}
+	}
+
+	static void deinterlaceFloat(const ConvertKernels *aKernels, const float *aSrc, unsigned int aSrcChannels, float *aDst, unsigned int aDstPitch, unsigned int aSamples, unsigned int aChannels)
+	{
+		if (aSrcChannels == 1)
+		{
+			memcpy(aDst, aSrc, aSamples * sizeof(float));
+			return;
+		}
+		if (aSrcChannels == 2 && aChannels == 2)
+		{
+			aKernels->deinterlace2(aSrc, aDst, aDst + aDstPitch, aSamples);
+			return;
+		}
+		unsigned int i, j;
+		for (j = 0; j < aChannels; j++)
+		{
+			float *dst = aDst + aDstPitch * j;
+			for (i = 0; i < aSamples; i++)
+				dst[i] = aSrc[i * aSrcChannels + j];
+		}
+	}
+
+	void interlace_samples(const float *aSrc, unsigned int aSrcPitch, void *aDst, unsigned int aFormat, unsigned int aSamples, unsigned int aChannels, unsigned int *aDitherSeed, unsigned int aMaxSimdLevel)
+	{
+		if (aFormat >= SAMPLE_FORMAT_MAX || aChannels < 1 || aChannels > MAX_CHANNELS)
+			return;
+		const ConvertKernels *k = getConvertKernels(aMaxSimdLevel);
+		if (aFormat == SAMPLE_FLOAT32)
+		{
+			interlaceFloat(k, aSrc, aSrcPitch, (float *)aDst, aSamples, aChannels);
+			return;
+		}
+		unsigned char *dst = (unsigned char *)aDst;
+		unsigned int framesize = sample_format_size(aFormat) * aChannels;
+		float tmp[CONVERT_CHUNK * MAX_CHANNELS];
+		unsigned int i;
+		for (i = 0; i < aSamples; i += CONVERT_CHUNK)
+		{
+			unsigned int n = aSamples - i;
+			if (n > CONVERT_CHUNK)
+				n = CONVERT_CHUNK;
+			interlaceFloat(k, aSrc + i, aSrcPitch, tmp, n, aChannels);
+			fromFloat(k, tmp, dst + i * framesize, aFormat, n * aChannels, aDitherSeed);
+		}
+	}
+
+	void deinterlace_samples(const void *aSrc, unsigned int aFormat, unsigned int aSrcChannels, float *aDst, unsigned int aDstPitch, unsigned int aSamples, unsigned int aChannels, unsigned int aMaxSimdLevel)
+	{
+		if (aFormat >= SAMPLE_FORMAT_MAX || aSrcChannels < 1 || aSrcChannels > MAX_CHANNELS || aChannels > aSrcChannels)
+			return;
+		const ConvertKernels *k = getConvertKernels(aMaxSimdLevel);
+		if (aFormat == SAMPLE_FLOAT32)
+		{
+			deinterlaceFloat(k, (const float *)aSrc, aSrcChannels, aDst, aDstPitch, aSamples, aChannels);
+			return;
+		}
+		const unsigned char *src = (const unsigned char *)aSrc;
+		unsigned int framesize = sample_format_size(aFormat) * aSrcChannels;
+		float tmp[CONVERT_CHUNK * MAX_CHANNELS];
+		unsigned int i;
+		for (i = 0; i < aSamples; i += CONVERT_CHUNK)
+		{
+			unsigned int n = aSamples - i;
+			if (n > CONVERT_CHUNK)
+				n = CONVERT_CHUNK;
+			toFloat(k, src + i * framesize, aFormat, tmp, n * aSrcChannels);
+			deinterlaceFloat(k, tmp, aSrcChannels, aDst + i, aDstPitch, n, aChannels);
+		}
+	}
+};
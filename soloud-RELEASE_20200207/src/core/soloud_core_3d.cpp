@@ -276,6 +276,13 @@ namespace SoLoud
 			// doppler
 			v->mDopplerValue = doppler(pos, vel, lvel, v->m3dDopplerFactor, m3dSoundSpeed);
 
+			// world space direction, for ambisonic encoding
+			vec3 dir = pos;
+			dir.normalize();
+			v->m3dDirection[0] = dir.mX;
+			v->m3dDirection[1] = dir.mY;
+			v->m3dDirection[2] = dir.mZ;
+
 			// panning
 			pos = m.mul(pos);
 			pos.normalize();
@@ -301,10 +308,64 @@ namespace SoLoud
 		}
 	}
 
+	void Soloud::get3dListenerMatrix_internal(float *aMatrix)
+	{
+		vec3 at, up;
+		at.mX = m3dAt[0];
+		at.mY = m3dAt[1];
+		at.mZ = m3dAt[2];
+		up.mX = m3dUp[0];
+		up.mY = m3dUp[1];
+		up.mZ = m3dUp[2];
+		mat3 m;
+		if (mFlags & LEFT_HANDED_3D)
+		{
+			m.lookatLH(at, up);
+		}
+		else
+		{
+			m.lookatRH(at, up);
+		}
+
+		int i;
+		for (i = 0; i < 3; i++)
+		{
+			aMatrix[3 * i + 0] = m.m[i].mX;
+			aMatrix[3 * i + 1] = m.m[i].mY;
+			aMatrix[3 * i + 2] = m.m[i].mZ;
+		}
+	}
+
+	void Soloud::get3dSpeakerDirections_internal(float *aDirection)
+	{
+		float m[9];
+		get3dListenerMatrix_internal(m);
+
+		int i;
+		for (i = 0; i < MAX_CHANNELS; i++)
+		{
+			vec3 speaker;
+			speaker.mX = 0;
+			speaker.mY = 0;
+			speaker.mZ = 0;
+			if (i < (signed)mChannels)
+			{
+				speaker.mX = m3dSpeakerPosition[3 * i + 0];
+				speaker.mY = m3dSpeakerPosition[3 * i + 1];
+				speaker.mZ = m3dSpeakerPosition[3 * i + 2];
+				speaker.normalize();
+			}
+			// The listener matrix is orthonormal, so its transpose takes listener space to world space
+			aDirection[3 * i + 0] = m[0] * speaker.mX + m[3] * speaker.mY + m[6] * speaker.mZ;
+			aDirection[3 * i + 1] = m[1] * speaker.mX + m[4] * speaker.mY + m[7] * speaker.mZ;
+			aDirection[3 * i + 2] = m[2] * speaker.mX + m[5] * speaker.mY + m[8] * speaker.mZ;
+		}
+	}
+
 	void Soloud::update3dAudio()
 	{
 		unsigned int voicecount = 0;
-		unsigned int voices[VOICE_COUNT];
+		unsigned int *voices = m3dVoiceList;
 
 		// Step 1 - find voices that need 3d processing
 		lockAudioMutex_internal();
@@ -340,26 +401,21 @@ namespace SoLoud
 				{
 					vi->mChannelVolume[j] = v->mChannelVolume[j];
 				}
-
-				if (vi->mOverallVolume < 0.001f)
+				for (j = 0; j < 3; j++)
 				{
-					// Inaudible.
-					vi->mFlags |= AudioSourceInstance::INAUDIBLE;
-
-					if (vi->mFlags & AudioSourceInstance::INAUDIBLE_KILL)
-					{
-						stopVoice_internal(voices[i]);
-					}
+					vi->m3dDirection[j] = v->m3dDirection[j];
 				}
-				else
+
+				if ((vi->mFlags & AudioSourceInstance::INAUDIBLE) && (vi->mFlags & AudioSourceInstance::INAUDIBLE_KILL))
 				{
-					vi->mFlags &= ~AudioSourceInstance::INAUDIBLE;
+					stopVoice_internal(voices[i]);
 				}
 			}
 		}
 
 		mActiveVoiceDirty = true;
 		unlockAudioMutex_internal();
+		destroyRetiredVoices();
 	}
 
 
@@ -394,43 +450,47 @@ namespace SoLoud
 			samples += (int)floor((dist / m3dSoundSpeed) * mSamplerate);
 		}
 
-		update3dVoices_internal((unsigned int *)&v, 1);
-		updateVoiceRelativePlaySpeed_internal(v);
+		init3dVoice_internal(v);
+
+		unlockAudioMutex_internal();
+		setDelaySamples(h, samples);
+		setPause(h, aPaused);
+		return h;
+	}
+
+	void Soloud::init3dVoice_internal(unsigned int aVoice)
+	{
+		update3dVoices_internal(&aVoice, 1);
+		updateVoiceRelativePlaySpeed_internal(aVoice);
 		int j;
 		for (j = 0; j < MAX_CHANNELS; j++)
 		{
-			mVoice[v]->mChannelVolume[j] = m3dData[v].mChannelVolume[j];
+			mVoice[aVoice]->mChannelVolume[j] = m3dData[aVoice].mChannelVolume[j];
+		}
+		for (j = 0; j < 3; j++)
+		{
+			mVoice[aVoice]->m3dDirection[j] = m3dData[aVoice].m3dDirection[j];
 		}
 
-		updateVoiceVolume_internal(v);
+		updateVoiceVolume_internal(aVoice);
 		
 		// Fix initial voice volume ramp up
 		int i;
 		for (i = 0; i < MAX_CHANNELS; i++)
 		{
-			mVoice[v]->mCurrentChannelVolume[i] = mVoice[v]->mChannelVolume[i] * mVoice[v]->mOverallVolume;
+			mVoice[aVoice]->mCurrentChannelVolume[i] = mVoice[aVoice]->mChannelVolume[i] * mVoice[aVoice]->mOverallVolume;
 		}
-
-		if (mVoice[v]->mOverallVolume < 0.01f)
+		calc_ambisonic_gains(mVoice[aVoice]->mCurrentAmbisonicGain, mVoice[aVoice]->m3dDirection, AMBISONIC_MAX_CHANNELS);
+		for (i = 0; i < AMBISONIC_MAX_CHANNELS; i++)
 		{
-			// Inaudible.
-			mVoice[v]->mFlags |= AudioSourceInstance::INAUDIBLE;
-
-			if (mVoice[v]->mFlags & AudioSourceInstance::INAUDIBLE_KILL)
-			{
-				stopVoice_internal(v);
-			}
+			mVoice[aVoice]->mCurrentAmbisonicGain[i] *= mVoice[aVoice]->mOverallVolume;
 		}
-		else
+
+		if ((mVoice[aVoice]->mFlags & AudioSourceInstance::INAUDIBLE) && (mVoice[aVoice]->mFlags & AudioSourceInstance::INAUDIBLE_KILL))
 		{
-			mVoice[v]->mFlags &= ~AudioSourceInstance::INAUDIBLE;
+			stopVoice_internal(aVoice);
 		}
 		mActiveVoiceDirty = true;
-
-		unlockAudioMutex_internal();
-		setDelaySamples(h, samples);
-		setPause(h, aPaused);
-		return h;
 	}
 
 	handle Soloud::play3dClocked(time aSoundTime, AudioSource &aSound, float aPosX, float aPosY, float aPosZ, float aVelX, float aVelY, float aVelZ, float aVolume, unsigned int aBus)
@@ -476,6 +536,10 @@ namespace SoLoud
 		{
 			mVoice[v]->mChannelVolume[j] = m3dData[v].mChannelVolume[j];
 		}
+		for (j = 0; j < 3; j++)
+		{
+			mVoice[v]->m3dDirection[j] = m3dData[v].m3dDirection[j];
+		}
 
 		updateVoiceVolume_internal(v);
 
@@ -485,20 +549,15 @@ namespace SoLoud
 		{
 			mVoice[v]->mCurrentChannelVolume[i] = mVoice[v]->mChannelVolume[i] * mVoice[v]->mOverallVolume;
 		}
-
-		if (mVoice[v]->mOverallVolume < 0.01f)
+		calc_ambisonic_gains(mVoice[v]->mCurrentAmbisonicGain, mVoice[v]->m3dDirection, AMBISONIC_MAX_CHANNELS);
+		for (i = 0; i < AMBISONIC_MAX_CHANNELS; i++)
 		{
-			// Inaudible.
-			mVoice[v]->mFlags |= AudioSourceInstance::INAUDIBLE;
-
-			if (mVoice[v]->mFlags & AudioSourceInstance::INAUDIBLE_KILL)
-			{
-				stopVoice_internal(v);
-			}
+			mVoice[v]->mCurrentAmbisonicGain[i] *= mVoice[v]->mOverallVolume;
 		}
-		else
+
+		if ((mVoice[v]->mFlags & AudioSourceInstance::INAUDIBLE) && (mVoice[v]->mFlags & AudioSourceInstance::INAUDIBLE_KILL))
 		{
-			mVoice[v]->mFlags &= ~AudioSourceInstance::INAUDIBLE;
+			stopVoice_internal(v);
 		}
 		mActiveVoiceDirty = true;
 		unlockAudioMutex_internal();
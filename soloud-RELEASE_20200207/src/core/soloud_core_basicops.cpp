@@ -37,34 +37,69 @@ namespace SoLoud
 			aSound.stop();
 		}
 
-		// Creation of an audio instance may take significant amount of time,
-		// so let's not do it inside the audio thread mutex.
 		aSound.mSoloud = this;
-		SoLoud::AudioSourceInstance *instance = aSound.createInstance();
+		SoLoud::AudioSourceInstance *instance = createInstance_internal(aSound);
+		if (instance == NULL)
+			return UNKNOWN_ERROR;
 
 		lockAudioMutex_internal();
-		int ch = findFreeVoice_internal();
+		int ch = startVoice_internal(aSound, instance, aVolume, aPan, aPaused, aBus);
 		if (ch < 0) 
 		{
 			unlockAudioMutex_internal();
 			delete instance;
 			return UNKNOWN_ERROR;
 		}
+		unlockAudioMutex_internal();
+
+		// Starting the voice may have stolen an old one
+		destroyRetiredVoices();
+
+		int handle = getHandleFromVoice_internal(ch);
+		return handle;
+	}
+
+	AudioSourceInstance *Soloud::createInstance_internal(AudioSource &aSound)
+	{
+		// Instance and filter creation may take significant amount of time,
+		// so let's not do either inside the audio thread mutex.
+		AudioSourceInstance *instance = aSound.createInstance();
+		if (instance == NULL)
+			return NULL;
+		int i;
+		for (i = 0; i < FILTERS_PER_STREAM; i++)
+		{
+			if (aSound.mFilter[i])
+			{
+				instance->mFilter[i] = aSound.mFilter[i]->createInstance();
+			}
+		}
+		return instance;
+	}
+
+	int Soloud::startVoice_internal(AudioSource &aSound, AudioSourceInstance *aInstance, float aVolume, float aPan, bool aPaused, unsigned int aBus)
+	{
+		int ch = findFreeVoice_internal();
+		if (ch < 0) 
+		{
+			return -1;
+		}
 		if (!aSound.mAudioSourceID)
 		{
 			aSound.mAudioSourceID = mAudioSourceID;
 			mAudioSourceID++;
 		}
-		mVoice[ch] = instance;
+		mVoice[ch] = aInstance;
 		mVoice[ch]->mAudioSourceID = aSound.mAudioSourceID;
 		mVoice[ch]->mBusHandle = aBus;
 		mVoice[ch]->init(aSound, mPlayIndex);
+		mVoiceSyncTime[ch] = mStreamTime;
 		m3dData[ch].init(aSound);
 
 		mPlayIndex++;
 
-		// 20 bits, skip the last one (top bits full = voice group)
-		if (mPlayIndex == 0xfffff) 
+		// Skip the last one (top bits full = voice group)
+		if (mPlayIndex == VOICE_HANDLE_INDEX_MASK)
 		{
 			mPlayIndex = 0;
 		}
@@ -95,7 +130,8 @@ namespace SoLoud
 		
 		for (i = 0; i < FILTERS_PER_STREAM; i++)
 		{
-			if (aSound.mFilter[i])
+			// Normally created up front by createInstance_internal, outside the audio thread
+			if (aSound.mFilter[i] && !mVoice[ch]->mFilter[i])
 			{
 				mVoice[ch]->mFilter[i] = aSound.mFilter[i]->createInstance();
 			}
@@ -103,10 +139,7 @@ namespace SoLoud
 
 		mActiveVoiceDirty = true;
 
-		unlockAudioMutex_internal();
-
-		int handle = getHandleFromVoice_internal(ch);
-		return handle;
+		return ch;
 	}
 
 	handle Soloud::playClocked(time aSoundTime, AudioSource &aSound, float aVolume, float aPan, unsigned int aBus)
@@ -142,6 +175,7 @@ namespace SoLoud
 		result res = SO_NO_ERROR;
 		result singleres = SO_NO_ERROR;
 		FOR_ALL_VOICES_PRE
+			syncVoiceTime_internal(ch);
 			singleres = mVoice[ch]->seek(aSeconds, mScratch.mData, mScratchSize);
 		if (singleres != SO_NO_ERROR)
 			res = singleres;
@@ -155,12 +189,15 @@ namespace SoLoud
 		FOR_ALL_VOICES_PRE
 			stopVoice_internal(ch);
 		FOR_ALL_VOICES_POST
+		destroyRetiredVoices();
 	}
 
 	void Soloud::stopAudioSource(AudioSource &aSound)
 	{
 		if (aSound.mAudioSourceID)
 		{
+			cancelScheduledSource_internal(aSound.mAudioSourceID);
+
 			lockAudioMutex_internal();
 			
 			int i;
@@ -172,18 +209,22 @@ namespace SoLoud
 				}
 			}
 			unlockAudioMutex_internal();
+			// The instances must go before the caller can destroy the source they point to
+			destroyRetiredVoices();
 		}
 	}
 
 	void Soloud::stopAll()
 	{
 		int i;
+		cancelAllScheduled();
 		lockAudioMutex_internal();
 		for (i = 0; i < (signed)mHighestVoice; i++)
 		{
 			stopVoice_internal(i);
 		}
 		unlockAudioMutex_internal();
+		destroyRetiredVoices();
 	}
 
 	int Soloud::countAudioSource(AudioSource &aSound)
@@ -36,7 +36,9 @@ namespace SoLoud
 			return;
 		}
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mPauseScheduler.set(1, 0, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -48,7 +50,9 @@ namespace SoLoud
 			return;
 		}
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mStopScheduler.set(1, 0, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -62,7 +66,9 @@ namespace SoLoud
 		}
 
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mVolumeFader.set(from, aTo, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -76,7 +82,9 @@ namespace SoLoud
 		}
 
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mPanFader.set(from, aTo, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -89,7 +97,9 @@ namespace SoLoud
 			return;
 		}
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mRelativePlaySpeedFader.set(from, aTo, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -114,7 +124,9 @@ namespace SoLoud
 		}
 
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mVolumeFader.setLFO(aFrom, aTo, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -127,7 +139,9 @@ namespace SoLoud
 		}
 
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mPanFader.setLFO(aFrom, aTo, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -140,7 +154,9 @@ namespace SoLoud
 		}
 		
 		FOR_ALL_VOICES_PRE
+		syncVoiceTime_internal(ch);
 		mVoice[ch]->mRelativePlaySpeedFader.setLFO(aFrom, aTo, aTime, mVoice[ch]->mStreamTime);
+		listFaderVoice_internal(ch);
 		FOR_ALL_VOICES_POST
 	}
 
@@ -23,6 +23,7 @@ freely, subject to the following restrictions:
 */
 
 #include "soloud.h"
+#include "soloud_simd.h"
 
 // Getters - return information about SoLoud state
 
@@ -47,7 +48,7 @@ namespace SoLoud
 	{
 		if (mVoice[aVoice] == 0)
 			return 0;
-		return (aVoice + 1) | (mVoice[aVoice]->mPlayIndex << 12);
+		return (aVoice + 1) | (mVoice[aVoice]->mPlayIndex << VOICE_HANDLE_SLOT_BITS);
 	}
 
 	int Soloud::getVoiceFromHandle_internal(handle aVoiceHandle) const
@@ -61,10 +62,11 @@ namespace SoLoud
 			return -1;
 		}
 
-		int ch = (aVoiceHandle & 0xfff) - 1;
-		unsigned int idx = aVoiceHandle >> 12;
-		if (mVoice[ch] &&
-			(mVoice[ch]->mPlayIndex & 0xfffff) == idx)
+		int ch = (aVoiceHandle & VOICE_HANDLE_SLOT_MASK) - 1;
+		unsigned int idx = aVoiceHandle >> VOICE_HANDLE_SLOT_BITS;
+		if ((unsigned int)ch < mVoiceCapacity &&
+			mVoice[ch] &&
+			(mVoice[ch]->mPlayIndex & VOICE_HANDLE_INDEX_MASK) == idx)
 		{
 			return ch;
 		}
@@ -76,6 +78,64 @@ namespace SoLoud
 		return mMaxActiveVoices;
 	}
 
+	float Soloud::getAudibilityThreshold() const
+	{
+		return mAudibilityThreshold;
+	}
+
+	float Soloud::getGovernorLoad() const
+	{
+		return mGovernorLoad;
+	}
+
+	unsigned int Soloud::getGovernorLevel() const
+	{
+		return mGovernorLevel;
+	}
+
+	unsigned int Soloud::getGovernorVoiceLimit() const
+	{
+		if (mGovernorLevel < GOVERNOR_VOICES_75)
+			return mMaxActiveVoices;
+		unsigned int limit = mMaxActiveVoices * (GOVERNOR_LEVEL_MAX - mGovernorLevel) / 4;
+		return limit ? limit : 1;
+	}
+
+	unsigned int Soloud::getGovernorDegradedVoiceCount() const
+	{
+		return mGovernorDegradedVoices;
+	}
+
+	unsigned int Soloud::getMixAhead() const
+	{
+		return mMixAheadBlocks;
+	}
+
+	unsigned int Soloud::getMixAheadUnderrunCount() const
+	{
+		return mMixAheadUnderruns;
+	}
+
+	unsigned int Soloud::getAudioThreadScheduling() const
+	{
+		return mAppliedAudioThreadPolicy;
+	}
+
+	unsigned long long Soloud::getAudioThreadAffinity() const
+	{
+		return mAppliedAudioThreadCoreMask;
+	}
+
+	bool Soloud::getAudioMutexPriorityInheritance() const
+	{
+		return mAudioMutexInherits;
+	}
+
+	unsigned int Soloud::getVoiceCapacity() const
+	{
+		return mVoiceCapacity;
+	}
+
 	unsigned int Soloud::getActiveVoiceCount()
 	{
 		lockAudioMutex_internal();
@@ -105,7 +165,7 @@ namespace SoLoud
 	bool Soloud::isValidVoiceHandle(handle aVoiceHandle)
 	{
 		// voice groups are not valid voice handles
-		if ((aVoiceHandle & 0xfffff000) == 0xfffff000)
+		if ((aVoiceHandle & VOICE_GROUP_HANDLE_MASK) == VOICE_GROUP_HANDLE_MASK)
 			return 0;
 
 		lockAudioMutex_internal();
@@ -212,6 +272,7 @@ namespace SoLoud
 			unlockAudioMutex_internal();
 			return 0;
 		}
+		syncVoiceTime_internal(ch);
 		double v = mVoice[ch]->mStreamTime;
 		unlockAudioMutex_internal();
 		return v;
@@ -226,6 +287,7 @@ namespace SoLoud
 			unlockAudioMutex_internal();
 			return 0;
 		}
+		syncVoiceTime_internal(ch);
 		double v = mVoice[ch]->mStreamPosition;
 		unlockAudioMutex_internal();
 		return v;
@@ -297,7 +359,7 @@ namespace SoLoud
 		if (mHighestVoice > 0 && mVoice[mHighestVoice - 1] == NULL)
 			mHighestVoice--;
 		
-		for (i = 0; i < VOICE_COUNT; i++)
+		for (i = 0; i < (signed)mVoiceCapacity; i++)
 		{
 			if (mVoice[i] == NULL)
 			{
@@ -363,6 +425,21 @@ namespace SoLoud
 		return mBufferSize;
 	}
 
+	unsigned int Soloud::getSupportedSimdLevel()
+	{
+		return detectSimdLevel();
+	}
+
+	unsigned int Soloud::getSimdLevel()
+	{
+		return mSimdLevel;
+	}
+
+	unsigned int Soloud::getGranularity()
+	{
+		return mGranularity;
+	}
+
 	// Get speaker position in 3d space
 	result Soloud::getSpeakerPosition(unsigned int aChannel, float &aX, float &aY, float &aZ)
 	{
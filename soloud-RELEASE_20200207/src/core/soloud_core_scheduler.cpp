@@ -0,0 +1,252 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "soloud_internal.h"
+
+// Core operations related to the sample-accurate play scheduler
+
+namespace SoLoud
+{
+	unsigned int Soloud::pushScheduledEvent_internal(ScheduledEvent &aEvent, time aStartTime, AudioSource &aSound)
+	{
+		double sample = floor(aStartTime * mSamplerate);
+		if (sample < 0)
+			sample = 0;
+
+		lockAudioMutex_internal();
+		if (!aSound.mAudioSourceID)
+		{
+			aSound.mAudioSourceID = mAudioSourceID;
+			mAudioSourceID++;
+		}
+		aEvent.mStartSample = (unsigned long long)sample;
+		aEvent.mId = mScheduleId;
+		mScheduleId++;
+		if (mScheduleId == 0)
+			mScheduleId = 1;
+		if (mScheduler.push(aEvent) != SO_NO_ERROR)
+		{
+			unlockAudioMutex_internal();
+			delete aEvent.mInstance;
+			return 0;
+		}
+		unlockAudioMutex_internal();
+		return aEvent.mId;
+	}
+
+	unsigned int Soloud::playScheduled(time aStartTime, AudioSource &aSound, float aVolume, float aPan, unsigned int aBus)
+	{
+		if (mSamplerate == 0)
+			return 0;
+
+		aSound.mSoloud = this;
+		ScheduledEvent ev;
+		ev.mSource = &aSound;
+		ev.mInstance = createInstance_internal(aSound);
+		if (ev.mInstance == NULL)
+			return 0;
+		ev.mVolume = aVolume;
+		ev.mPan = aPan;
+		ev.mBus = aBus;
+		ev.m3d = false;
+		int i;
+		for (i = 0; i < 3; i++)
+		{
+			ev.m3dPosition[i] = 0;
+			ev.m3dVelocity[i] = 0;
+		}
+		return pushScheduledEvent_internal(ev, aStartTime, aSound);
+	}
+
+	unsigned int Soloud::play3dScheduled(time aStartTime, AudioSource &aSound, float aPosX, float aPosY, float aPosZ, float aVelX, float aVelY, float aVelZ, float aVolume, unsigned int aBus)
+	{
+		if (mSamplerate == 0)
+			return 0;
+
+		aSound.mSoloud = this;
+		ScheduledEvent ev;
+		ev.mSource = &aSound;
+		ev.mInstance = createInstance_internal(aSound);
+		if (ev.mInstance == NULL)
+			return 0;
+		ev.mVolume = aVolume;
+		ev.mPan = 0;
+		ev.mBus = aBus;
+		ev.m3d = true;
+		ev.m3dPosition[0] = aPosX;
+		ev.m3dPosition[1] = aPosY;
+		ev.m3dPosition[2] = aPosZ;
+		ev.m3dVelocity[0] = aVelX;
+		ev.m3dVelocity[1] = aVelY;
+		ev.m3dVelocity[2] = aVelZ;
+		return pushScheduledEvent_internal(ev, aStartTime, aSound);
+	}
+
+	result Soloud::cancelScheduled(unsigned int aEventId)
+	{
+		ScheduledEvent ev;
+		lockAudioMutex_internal();
+		int idx = mScheduler.find(aEventId);
+		if (idx < 0)
+		{
+			unlockAudioMutex_internal();
+			return INVALID_PARAMETER;
+		}
+		mScheduler.removeAt(idx, ev);
+		unlockAudioMutex_internal();
+		delete ev.mInstance;
+		return SO_NO_ERROR;
+	}
+
+	void Soloud::cancelAllScheduled()
+	{
+		cancelScheduledSource_internal(0);
+	}
+
+	void Soloud::cancelScheduledSource_internal(unsigned int aAudioSourceID)
+	{
+		// Collect the instances under the lock, but delete them outside of it
+		AudioSourceInstance *doomed[64];
+		for (;;)
+		{
+			int count = 0;
+			lockAudioMutex_internal();
+			// Removing one at a time moves events across the scan, so compact the array and re-heap it once
+			unsigned int i, kept = 0;
+			for (i = 0; i < mScheduler.mCount; i++)
+			{
+				if (count < 64 && (aAudioSourceID == 0 || mScheduler.mEvent[i].mSource->mAudioSourceID == aAudioSourceID))
+				{
+					doomed[count] = mScheduler.mEvent[i].mInstance;
+					count++;
+				}
+				else
+				{
+					mScheduler.mEvent[kept] = mScheduler.mEvent[i];
+					kept++;
+				}
+			}
+			if (kept != mScheduler.mCount)
+			{
+				mScheduler.mCount = kept;
+				mScheduler.rebuild();
+			}
+			unlockAudioMutex_internal();
+
+			int j;
+			for (j = 0; j < count; j++)
+				delete doomed[j];
+
+			if (count < 64)
+				return;
+		}
+	}
+
+	unsigned int Soloud::getScheduledCount()
+	{
+		lockAudioMutex_internal();
+		unsigned int count = mScheduler.mCount;
+		unlockAudioMutex_internal();
+		return count;
+	}
+
+	time Soloud::getScheduleTime()
+	{
+		if (mSamplerate == 0)
+			return 0;
+		lockAudioMutex_internal();
+		unsigned long long sample = mScheduleSample;
+		unlockAudioMutex_internal();
+		return (time)sample / mSamplerate;
+	}
+
+	void Soloud::processScheduledEvents_internal(unsigned int aSamples)
+	{
+		unsigned long long blockend = mScheduleSample + aSamples;
+		ScheduledEvent *top;
+		while ((top = mScheduler.top()) != NULL && top->mStartSample < blockend)
+		{
+			ScheduledEvent ev = *top;
+			mScheduler.pop();
+
+			if (ev.mSource->mFlags & AudioSource::SINGLE_INSTANCE)
+			{
+				int i;
+				for (i = 0; i < (signed)mHighestVoice; i++)
+				{
+					if (mVoice[i] && mVoice[i]->mAudioSourceID == ev.mSource->mAudioSourceID)
+					{
+						stopVoice_internal(i);
+					}
+				}
+			}
+
+			int ch = startVoice_internal(*ev.mSource, ev.mInstance, ev.mVolume, ev.mPan, 0, ev.mBus);
+			if (ch < 0)
+			{
+				retireInstance_internal(ev.mInstance);
+				continue;
+			}
+
+			// Events that were scheduled in the past start at the top of the block
+			unsigned int samples = 0;
+			if (ev.mStartSample > mScheduleSample)
+				samples = (unsigned int)(ev.mStartSample - mScheduleSample);
+
+			if (ev.m3d)
+			{
+				m3dData[ch].mHandle = getHandleFromVoice_internal(ch);
+				mVoice[ch]->mFlags |= AudioSourceInstance::PROCESS_3D;
+				int i;
+				for (i = 0; i < 3; i++)
+				{
+					m3dData[ch].m3dPosition[i] = ev.m3dPosition[i];
+					m3dData[ch].m3dVelocity[i] = ev.m3dVelocity[i];
+				}
+
+				if (ev.mSource->mFlags & AudioSource::DISTANCE_DELAY)
+				{
+					float pos[3];
+					for (i = 0; i < 3; i++)
+					{
+						pos[i] = ev.m3dPosition[i];
+						if (!(mVoice[ch]->mFlags & AudioSourceInstance::LISTENER_RELATIVE))
+							pos[i] -= m3dPosition[i];
+					}
+					float dist = (float)sqrt(pos[0] * pos[0] + pos[1] * pos[1] + pos[2] * pos[2]);
+					samples += (int)floor((dist / m3dSoundSpeed) * mSamplerate);
+				}
+
+				init3dVoice_internal(ch);
+				if (mVoice[ch] == NULL)
+					continue;
+			}
+
+			mVoice[ch]->mDelaySamples = samples;
+			// Started during this mix, which already counts towards its stream time
+			mVoiceSyncTime[ch] -= aSamples / (time)mSamplerate;
+		}
+		mScheduleSample = blockend;
+	}
+}
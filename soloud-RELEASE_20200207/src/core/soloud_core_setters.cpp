@@ -23,6 +23,7 @@ freely, subject to the following restrictions:
 */
 
 #include "soloud_internal.h"
+#include "soloud_simd.h"
 
 // Setters - set various bits of SoLoud state
 
@@ -39,6 +40,19 @@ namespace SoLoud
 		mGlobalVolume = aVolume;
 	}		
 
+	result Soloud::setSimdLevel(unsigned int aLevel)
+	{
+		if (aLevel >= SIMD_LEVEL_MAX)
+			return INVALID_PARAMETER;
+		if (aLevel > detectSimdLevel())
+			return NOT_IMPLEMENTED;
+		lockAudioMutex_internal();
+		mSimdLevel = aLevel;
+		mSimd = getSimdKernels(aLevel);
+		unlockAudioMutex_internal();
+		return SO_NO_ERROR;
+	}
+
 	result Soloud::setRelativePlaySpeed(handle aVoiceHandle, float aSpeed)
 	{
 		result retVal = 0;
@@ -66,17 +80,28 @@ namespace SoLoud
 
 	result Soloud::setMaxActiveVoiceCount(unsigned int aVoiceCount)
 	{
-		if (aVoiceCount == 0 || aVoiceCount >= VOICE_COUNT)
+		if (aVoiceCount == 0 || aVoiceCount >= mVoiceCapacity)
 			return INVALID_PARAMETER;
 		lockAudioMutex_internal();
+		unsigned int i;
+		// Voices get new buffers on the next active voice update
+		for (i = 0; mResampleDataOwner && i < mMaxActiveVoices; i++)
+		{
+			if (mResampleDataOwner[i])
+			{
+				mResampleDataOwner[i]->mResampleData[0] = 0;
+				mResampleDataOwner[i]->mResampleData[1] = 0;
+			}
+		}
 		mMaxActiveVoices = aVoiceCount;
 		delete[] mResampleData;
 		delete[] mResampleDataOwner;
+		delete[] mResampleDataLive;
 		mResampleData = new AlignedFloatBuffer[aVoiceCount * 2];
 		mResampleDataOwner = new AudioSourceInstance*[aVoiceCount];
-		unsigned int i;
+		mResampleDataLive = new unsigned char[aVoiceCount];
 		for (i = 0; i < aVoiceCount * 2; i++)
-			mResampleData[i].init(SAMPLE_GRANULARITY * MAX_CHANNELS);
+			mResampleData[i].init(mGranularity * MAX_CHANNELS);
 		for (i = 0; i < aVoiceCount; i++)
 			mResampleDataOwner[i] = NULL;
 		mActiveVoiceDirty = true;
@@ -84,6 +109,91 @@ namespace SoLoud
 		return SO_NO_ERROR;
 	}
 
+	result Soloud::setVoiceCapacity(unsigned int aVoiceCount)
+	{
+		if (aVoiceCount <= mMaxActiveVoices || aVoiceCount > VOICE_COUNT_MAX)
+			return INVALID_PARAMETER;
+		AudioSourceInstance **voice = new AudioSourceInstance*[aVoiceCount];
+		AudioSourceInstance3dData *data3d = new AudioSourceInstance3dData[aVoiceCount];
+		unsigned int *voicelist3d = new unsigned int[aVoiceCount];
+		unsigned int *activevoice = new unsigned int[aVoiceCount];
+		// One key per voice slot plus the main mix, and two more for groupActiveVoices_internal's prefix sum
+		unsigned int *busvoicestart = new unsigned int[aVoiceCount + 3];
+		unsigned int *activevoicesort = new unsigned int[aVoiceCount];
+		time *voicesynctime = new time[aVoiceCount];
+		unsigned int *fadervoice = new unsigned int[aVoiceCount];
+		unsigned char *fadervoicelisted = new unsigned char[aVoiceCount];
+		if (voice == NULL || data3d == NULL || voicelist3d == NULL || activevoice == NULL || busvoicestart == NULL || activevoicesort == NULL ||
+			voicesynctime == NULL || fadervoice == NULL || fadervoicelisted == NULL)
+		{
+			delete[] voice;
+			delete[] data3d;
+			delete[] voicelist3d;
+			delete[] activevoice;
+			delete[] busvoicestart;
+			delete[] activevoicesort;
+			delete[] voicesynctime;
+			delete[] fadervoice;
+			delete[] fadervoicelisted;
+			return OUT_OF_MEMORY;
+		}
+
+		lockAudioMutex_internal();
+		unsigned int i;
+		for (i = aVoiceCount; i < mHighestVoice; i++)
+			stopVoice_internal(i);
+		if (mHighestVoice > aVoiceCount)
+			mHighestVoice = aVoiceCount;
+		for (i = 0; i < aVoiceCount; i++)
+		{
+			voice[i] = NULL;
+			voicesynctime[i] = mStreamTime;
+			fadervoicelisted[i] = 0;
+			if (i < mVoiceCapacity)
+			{
+				voice[i] = mVoice[i];
+				data3d[i] = m3dData[i];
+				voicesynctime[i] = mVoiceSyncTime[i];
+			}
+		}
+		unsigned int fadervoicecount = 0;
+		for (i = 0; i < mFaderVoiceCount; i++)
+		{
+			if (mFaderVoice[i] < aVoiceCount)
+			{
+				fadervoice[fadervoicecount] = mFaderVoice[i];
+				fadervoicelisted[mFaderVoice[i]] = 1;
+				fadervoicecount++;
+			}
+		}
+		delete[] mVoice;
+		delete[] m3dData;
+		delete[] m3dVoiceList;
+		delete[] mActiveVoice;
+		delete[] mBusVoiceStart;
+		delete[] mActiveVoiceSort;
+		delete[] mVoiceSyncTime;
+		delete[] mFaderVoice;
+		delete[] mFaderVoiceListed;
+		mVoice = voice;
+		m3dData = data3d;
+		m3dVoiceList = voicelist3d;
+		mActiveVoice = activevoice;
+		mBusVoiceStart = busvoicestart;
+		mActiveVoiceSort = activevoicesort;
+		mVoiceSyncTime = voicesynctime;
+		mFaderVoice = fadervoice;
+		mFaderVoiceCount = fadervoicecount;
+		mFaderVoiceListed = fadervoicelisted;
+		mVoiceCapacity = aVoiceCount;
+		mActiveVoiceCount = 0;
+		mBusVoiceKeys = 0;
+		mActiveVoiceDirty = true;
+		unlockAudioMutex_internal();
+		destroyRetiredVoices();
+		return SO_NO_ERROR;
+	}
+
 	void Soloud::setPauseAll(bool aPause)
 	{
 		lockAudioMutex_internal();
@@ -146,6 +256,21 @@ namespace SoLoud
 			FOR_ALL_VOICES_POST
 	}
 
+	void Soloud::setAudibilityThreshold(float aThreshold)
+	{
+		lockAudioMutex_internal();
+		mAudibilityThreshold = aThreshold;
+		unsigned int i;
+		for (i = 0; i < mHighestVoice; i++)
+		{
+			if (mVoice[i])
+			{
+				updateVoiceAudibility_internal(i);
+			}
+		}
+		unlockAudioMutex_internal();
+	}
+
 	void Soloud::setInaudibleBehavior(handle aVoiceHandle, bool aMustTick, bool aKill)
 	{
 		FOR_ALL_VOICES_PRE
@@ -210,6 +335,55 @@ namespace SoLoud
 		}
 	}
 
+	void Soloud::setGovernorEnable(bool aEnable)
+	{
+		lockAudioMutex_internal();
+		if (aEnable)
+		{
+			mFlags |= ENABLE_GOVERNOR;
+		}
+		else
+		{
+			mFlags &= ~ENABLE_GOVERNOR;
+			if (mGovernorLevel != GOVERNOR_FULL)
+				mActiveVoiceDirty = true;
+			mGovernorLevel = GOVERNOR_FULL;
+			mGovernorLoad = 0;
+			mGovernorCooldown = 0;
+			mGovernorCalm = 0;
+		}
+		unlockAudioMutex_internal();
+	}
+
+	result Soloud::setMixAhead(unsigned int aBlocks, unsigned int aBlockSize)
+	{
+		// A single block would leave nothing to play while it's being mixed, and
+		// blocks are mixed in the scratch buffer, which holds at least 4096 samples
+		if (aBlocks == 1 || aBlocks > MIX_AHEAD_MAX_BLOCKS || aBlockSize > SAMPLE_GRANULARITY * 8)
+			return INVALID_PARAMETER;
+		mMixAheadBlocks = aBlocks;
+		mMixAheadBlockSize = aBlockSize;
+		return SO_NO_ERROR;
+	}
+
+	result Soloud::setAudioThreadScheduling(unsigned int aPolicy, int aPriority, unsigned long long aCoreMask)
+	{
+		if (aPolicy > SCHEDULE_RR || aPriority < 0)
+			return INVALID_PARAMETER;
+		mAudioThreadPolicy = aPolicy;
+		mAudioThreadPriority = aPriority;
+		mAudioThreadCoreMask = aCoreMask;
+		return SO_NO_ERROR;
+	}
+
+	result Soloud::setGovernorBudget(float aBudget)
+	{
+		if (!(aBudget > 0))
+			return INVALID_PARAMETER;
+		mGovernorBudget = aBudget;
+		return SO_NO_ERROR;
+	}
+
 	result Soloud::setSpeakerPosition(unsigned int aChannel, float aX, float aY, float aZ)
 	{
 		if (aChannel >= mChannels)
@@ -48,10 +48,10 @@ namespace SoLoud
 				mVoiceGroup[i][0] = 16;
 				mVoiceGroup[i][1] = 0;
 				unlockAudioMutex_internal();
-				return 0xfffff000 | i;
+				return VOICE_GROUP_HANDLE_MASK | i;
 			}		
 		}
-		if (mVoiceGroupCount == 4096)
+		if (mVoiceGroupCount > VOICE_HANDLE_SLOT_MASK)
 		{
 			unlockAudioMutex_internal();
 			return 0;
@@ -91,7 +91,7 @@ namespace SoLoud
 		mVoiceGroup[i][0] = 16;
 		mVoiceGroup[i][1] = 0;
 		unlockAudioMutex_internal();
-		return 0xfffff000 | i;
+		return VOICE_GROUP_HANDLE_MASK | i;
 	}
 
 	// Destroy a voice group. 
@@ -99,7 +99,7 @@ namespace SoLoud
 	{
 		if (!isVoiceGroup(aVoiceGroupHandle))
 			return INVALID_PARAMETER;
-		int c = aVoiceGroupHandle & 0xfff;
+		int c = aVoiceGroupHandle & VOICE_HANDLE_SLOT_MASK;
 		
 		lockAudioMutex_internal();
 		delete[] mVoiceGroup[c];
@@ -120,7 +120,7 @@ namespace SoLoud
 
 		trimVoiceGroup_internal(aVoiceGroupHandle);
 		
-		int c = aVoiceGroupHandle & 0xfff;
+		int c = aVoiceGroupHandle & VOICE_HANDLE_SLOT_MASK;
 		unsigned int i;
 
 		lockAudioMutex_internal();
@@ -164,9 +164,9 @@ namespace SoLoud
 	// Is this handle a valid voice group?
 	bool Soloud::isVoiceGroup(handle aVoiceGroupHandle)
 	{
-		if ((aVoiceGroupHandle & 0xfffff000) != 0xfffff000)
+		if ((aVoiceGroupHandle & VOICE_GROUP_HANDLE_MASK) != VOICE_GROUP_HANDLE_MASK)
 			return 0;
-		unsigned int c = aVoiceGroupHandle & 0xfff;
+		unsigned int c = aVoiceGroupHandle & VOICE_HANDLE_SLOT_MASK;
 		if (c >= mVoiceGroupCount)
 			return 0;
 
@@ -184,7 +184,7 @@ namespace SoLoud
 		if (!isVoiceGroup(aVoiceGroupHandle))
 			return 1;
 		trimVoiceGroup_internal(aVoiceGroupHandle);
-		int c = aVoiceGroupHandle & 0xfff;
+		int c = aVoiceGroupHandle & VOICE_HANDLE_SLOT_MASK;
 
 		lockAudioMutex_internal();
 		bool res = mVoiceGroup[c][1] == 0;
@@ -198,7 +198,7 @@ namespace SoLoud
 	{
 		if (!isVoiceGroup(aVoiceGroupHandle))
 			return;
-		int c = aVoiceGroupHandle & 0xfff;
+		int c = aVoiceGroupHandle & VOICE_HANDLE_SLOT_MASK;
 
 		lockAudioMutex_internal();
 		// empty group
@@ -249,9 +249,9 @@ namespace SoLoud
 
 	handle *Soloud::voiceGroupHandleToArray_internal(handle aVoiceGroupHandle) const
 	{
-		if ((aVoiceGroupHandle & 0xfffff000) != 0xfffff000)
+		if ((aVoiceGroupHandle & VOICE_GROUP_HANDLE_MASK) != VOICE_GROUP_HANDLE_MASK)
 			return NULL;
-		unsigned int c = aVoiceGroupHandle & 0xfff;
+		unsigned int c = aVoiceGroupHandle & VOICE_HANDLE_SLOT_MASK;
 		if (c >= mVoiceGroupCount)
 			return NULL;
 		if (mVoiceGroup[c] == NULL)
@@ -23,6 +23,7 @@ freely, subject to the following restrictions:
 */
 
 #include "soloud.h"
+#include "soloud_thread.h"
 
 // Direct voice operations (no mutexes - called from other functions)
 
@@ -30,7 +31,7 @@ namespace SoLoud
 {
 	result Soloud::setVoiceRelativePlaySpeed_internal(unsigned int aVoice, float aSpeed)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
 		if (aSpeed <= 0.0f)
 		{
@@ -48,11 +49,13 @@ namespace SoLoud
 
 	void Soloud::setVoicePause_internal(unsigned int aVoice, int aPause)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
 		mActiveVoiceDirty = true;
 		if (mVoice[aVoice])
 		{
+			// Paused voices' stream time stands still
+			syncVoiceTime_internal(aVoice);
 			mVoice[aVoice]->mPauseScheduler.mActive = 0;
 
 			if (aPause)
@@ -68,7 +71,7 @@ namespace SoLoud
 
 	void Soloud::setVoicePan_internal(unsigned int aVoice, float aPan)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
 		if (mVoice[aVoice])
 		{
@@ -103,7 +106,7 @@ namespace SoLoud
 
 	void Soloud::setVoiceVolume_internal(unsigned int aVoice, float aVolume)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
 		mActiveVoiceDirty = true;
 		if (mVoice[aVoice])
@@ -115,39 +118,100 @@ namespace SoLoud
 
 	void Soloud::stopVoice_internal(unsigned int aVoice)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
 		mActiveVoiceDirty = true;
 		if (mVoice[aVoice])
 		{
-			// Delete via temporary variable to avoid recursion
+			// Clear the slot first to avoid recursion
 			AudioSourceInstance * v = mVoice[aVoice];
+			handle h = getHandleFromVoice_internal(aVoice);
 			mVoice[aVoice] = 0;
 
-			unsigned int i;
-			for (i = 0; i < mMaxActiveVoices; i++)
+			if (v->mResampleData[0])
 			{
-				if (mResampleDataOwner[i] == v)
+				mResampleDataOwner[(v->mResampleData[0] - mResampleData) / 2] = NULL;
+			}
+
+			if (v->mFlags & AudioSourceInstance::BUS)
+			{
+				unsigned int i;
+				for (i = 0; i < mHighestVoice; i++)
 				{
-					mResampleDataOwner[i] = NULL;
+					if (mVoice[i] && mVoice[i]->mBusHandle == h)
+					{
+						stopVoice_internal(i);
+					}
 				}
 			}
 
+			// This may be the audio thread, so leave the destructor to destroyRetiredVoices
+			retireInstance_internal(v);
+		}
+	}
+
+	void Soloud::retireInstance_internal(AudioSourceInstance *aInstance)
+	{
+		void *head;
+		do
+		{
+			head = mRetired;
+			aInstance->mRetireNext = (AudioSourceInstance *)head;
+		}
+		while (Thread::atomicCompareExchangePointer(&mRetired, head, aInstance) != head);
+	}
+
+	void Soloud::destroyRetiredVoices()
+	{
+		// Take the whole list at once; with a single taker, nodes can't come back while a push is in flight
+		AudioSourceInstance *v = (AudioSourceInstance *)Thread::atomicExchangePointer(&mRetired, NULL);
+		while (v)
+		{
+			AudioSourceInstance *next = v->mRetireNext;
 			delete v;
+			v = next;
 		}
 	}
 
 	void Soloud::updateVoiceRelativePlaySpeed_internal(unsigned int aVoice)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
+		// The stream position so far went at the old speed
+		syncVoiceTime_internal(aVoice);
 		mVoice[aVoice]->mOverallRelativePlaySpeed = m3dData[aVoice].mDopplerValue * mVoice[aVoice]->mSetRelativePlaySpeed;
 		mVoice[aVoice]->mSamplerate = mVoice[aVoice]->mBaseSamplerate * mVoice[aVoice]->mOverallRelativePlaySpeed;
 	}
 
+	void Soloud::syncVoiceTime_internal(unsigned int aVoice)
+	{
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
+		SOLOUD_ASSERT(mInsideAudioThreadMutex);
+		AudioSourceInstance *v = mVoice[aVoice];
+		if (v && !(v->mFlags & AudioSourceInstance::PAUSED))
+		{
+			time elapsed = mStreamTime - mVoiceSyncTime[aVoice];
+			v->mStreamTime += elapsed;
+			v->mStreamPosition += elapsed * (double)v->mOverallRelativePlaySpeed;
+		}
+		mVoiceSyncTime[aVoice] = mStreamTime;
+	}
+
+	void Soloud::listFaderVoice_internal(unsigned int aVoice)
+	{
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
+		SOLOUD_ASSERT(mInsideAudioThreadMutex);
+		if (!mFaderVoiceListed[aVoice])
+		{
+			mFaderVoiceListed[aVoice] = 1;
+			mFaderVoice[mFaderVoiceCount] = aVoice;
+			mFaderVoiceCount++;
+		}
+	}
+
 	void Soloud::updateVoiceVolume_internal(unsigned int aVoice)
 	{
-		SOLOUD_ASSERT(aVoice < VOICE_COUNT);
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
 		SOLOUD_ASSERT(mInsideAudioThreadMutex);
 		mVoice[aVoice]->mOverallVolume = mVoice[aVoice]->mSetVolume * m3dData[aVoice].m3dVolume;
 		if (mVoice[aVoice]->mFlags & AudioSourceInstance::PAUSED)
@@ -158,5 +222,37 @@ namespace SoLoud
 				mVoice[aVoice]->mCurrentChannelVolume[i] = mVoice[aVoice]->mChannelVolume[i] * mVoice[aVoice]->mOverallVolume;
 			}
 		}
+		updateVoiceAudibility_internal(aVoice);
+	}
+
+	void Soloud::updateVoiceAudibility_internal(unsigned int aVoice)
+	{
+		SOLOUD_ASSERT(aVoice < mVoiceCapacity);
+		SOLOUD_ASSERT(mInsideAudioThreadMutex);
+		AudioSourceInstance *voice = mVoice[aVoice];
+		// The engine threshold only culls 3d voices. Muting a 2d voice, or fading it through 0, mustn't
+		// freeze it, unless its source asked for a threshold of its own.
+		float threshold = voice->mAudibilityThreshold;
+		if (threshold < 0)
+			threshold = (voice->mFlags & AudioSourceInstance::PROCESS_3D) ? mAudibilityThreshold : 0;
+		// Come back at a higher volume than we left at, so that voices hovering around the
+		// threshold don't keep flipping.
+		if (voice->mFlags & AudioSourceInstance::INAUDIBLE)
+		{
+			threshold *= 2;
+		}
+		unsigned int flags = voice->mFlags;
+		if (voice->mOverallVolume < threshold)
+		{
+			voice->mFlags |= AudioSourceInstance::INAUDIBLE;
+		}
+		else
+		{
+			voice->mFlags &= ~AudioSourceInstance::INAUDIBLE;
+		}
+		if (voice->mFlags != flags)
+		{
+			mActiveVoiceDirty = true;
+		}
 	}
 }
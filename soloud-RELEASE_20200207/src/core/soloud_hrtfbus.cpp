@@ -0,0 +1,646 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+
+#include <string.h>
+#include <math.h>
+#include "soloud.h"
+#include "soloud_hrtfbus.h"
+#include "soloud_wav.h"
+#include "soloud_fft.h"
+#include "soloud_internal.h"
+#include "soloud_simd.h"
+
+namespace SoLoud
+{
+	Hrtf::Hrtf()
+	{
+		mData = 0;
+		mDirection = 0;
+		mLength = 0;
+		mDirectionCount = 0;
+	}
+
+	Hrtf::~Hrtf()
+	{
+		delete[] mData;
+		delete[] mDirection;
+	}
+
+	result Hrtf::load(const char *aFilename, const float *aDirections, unsigned int aDirectionCount)
+	{
+		if (aFilename == NULL || aDirections == NULL || aDirectionCount == 0)
+			return INVALID_PARAMETER;
+		Wav wav;
+		result res = wav.load(aFilename);
+		if (res != SO_NO_ERROR)
+			return res;
+		if (wav.mChannels != 2 || wav.mSampleCount < aDirectionCount)
+			return FILE_LOAD_FAILED;
+
+		unsigned int length = wav.mSampleCount / aDirectionCount;
+		float *data = new float[length * 2 * aDirectionCount];
+		if (data == NULL)
+			return OUT_OF_MEMORY;
+		unsigned int i, j;
+		for (i = 0; i < aDirectionCount; i++)
+		{
+			for (j = 0; j < length; j++)
+			{
+				data[i * length * 2 + j] = wav.mData[i * length + j];
+				data[i * length * 2 + length + j] = wav.mData[wav.mSampleCount + i * length + j];
+			}
+		}
+		res = loadRaw(data, length, aDirections, aDirectionCount);
+		delete[] data;
+		return res;
+	}
+
+	result Hrtf::loadRaw(const float *aData, unsigned int aLength, const float *aDirections, unsigned int aDirectionCount)
+	{
+		if (aData == NULL || aDirections == NULL || aDirectionCount == 0 || aLength == 0 || aLength > SOLOUD_HRTF_MAX_LENGTH)
+			return INVALID_PARAMETER;
+		unsigned int i;
+		for (i = 0; i < aDirectionCount; i++)
+		{
+			if (aDirections[i * 3 + 0] == 0 && aDirections[i * 3 + 1] == 0 && aDirections[i * 3 + 2] == 0)
+				return INVALID_PARAMETER;
+		}
+
+		float *data = new float[aLength * 2 * aDirectionCount];
+		float *direction = new float[aDirectionCount * 3];
+		if (data == NULL || direction == NULL)
+		{
+			delete[] data;
+			delete[] direction;
+			return OUT_OF_MEMORY;
+		}
+		memcpy(data, aData, sizeof(float) * aLength * 2 * aDirectionCount);
+		for (i = 0; i < aDirectionCount; i++)
+		{
+			const float *d = aDirections + i * 3;
+			float mag = (float)sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+			direction[i * 3 + 0] = d[0] / mag;
+			direction[i * 3 + 1] = d[1] / mag;
+			direction[i * 3 + 2] = d[2] / mag;
+		}
+
+		delete[] mData;
+		delete[] mDirection;
+		mData = data;
+		mDirection = direction;
+		mLength = aLength;
+		mDirectionCount = aDirectionCount;
+		return SO_NO_ERROR;
+	}
+
+	unsigned int Hrtf::getLength()
+	{
+		return mLength;
+	}
+
+	unsigned int Hrtf::getDirectionCount()
+	{
+		return mDirectionCount;
+	}
+
+	// Add the first aSamples values of a block convolution result and the pending tail to
+	// the left and right outputs, and keep the rest as the new tail. aResult may be NULL.
+	// Results and tails are aSize complex values, left ear in the real and right in the imaginary part.
+	static void overlapAdd(const float *aResult, float *aTail, float *aLeft, float *aRight, unsigned int aSamples, unsigned int aSize)
+	{
+		unsigned int i;
+		if (aResult)
+		{
+			for (i = 0; i < aSamples; i++)
+			{
+				aLeft[i] += aResult[i * 2] + aTail[i * 2];
+				aRight[i] += aResult[i * 2 + 1] + aTail[i * 2 + 1];
+			}
+			for (i = 0; i < (aSize - aSamples) * 2; i++)
+				aTail[i] = aTail[i + aSamples * 2] + aResult[i + aSamples * 2];
+		}
+		else
+		{
+			for (i = 0; i < aSamples; i++)
+			{
+				aLeft[i] += aTail[i * 2];
+				aRight[i] += aTail[i * 2 + 1];
+			}
+			for (i = 0; i < (aSize - aSamples) * 2; i++)
+				aTail[i] = aTail[i + aSamples * 2];
+		}
+		for (; i < aSize * 2; i++)
+			aTail[i] = 0;
+	}
+
+	// Zero pad real samples into a complex buffer and transform it
+	static void transform(const float *aSamples, unsigned int aCount, float *aSpectrum, unsigned int aSize)
+	{
+		unsigned int i;
+		for (i = 0; i < aCount; i++)
+		{
+			aSpectrum[i * 2] = aSamples[i];
+			aSpectrum[i * 2 + 1] = 0;
+		}
+		for (i = aCount * 2; i < aSize * 2; i++)
+			aSpectrum[i] = 0;
+		FFT::fft(aSpectrum, aSize * 2);
+	}
+
+	HrtfBusInstance::HrtfBusInstance(HrtfBus *aParent) : BusInstance(aParent)
+	{
+		Soloud *s = aParent->mSoloud;
+		Hrtf *hrtf = aParent->mHrtf;
+		unsigned int i, j, k;
+
+		// Without an HRTF, a single direction with a unit impulse for both ears
+		static const float impulse[2] = { 1, 1 };
+		static const float forward[3] = { 0, 0, 1 };
+		const float *data = impulse;
+		const float *direction = forward;
+		mLength = 1;
+		mDirectionCount = 1;
+		if (hrtf && hrtf->mDirectionCount)
+		{
+			data = hrtf->mData;
+			direction = hrtf->mDirection;
+			mLength = hrtf->mLength;
+			mDirectionCount = hrtf->mDirectionCount;
+		}
+
+		mBlockSize = s ? s->mGranularity : SAMPLE_GRANULARITY;
+		mFFTSize = 1;
+		while (mFFTSize < mBlockSize + mLength - 1)
+			mFFTSize *= 2;
+		unsigned int size = mFFTSize * 2;
+
+		mMaxVoices = aParent->mMaxVoices;
+		mDirection.init(mDirectionCount * 3);
+		mSpectrum.init(mDirectionCount * size);
+		mFieldFilter.init(4 * size);
+		mFieldTail.init(size);
+		mFieldTail.clear();
+		mFieldTailLength = 0;
+		mFieldActive = false;
+		mSlotData.init(mMaxVoices * (mBlockSize + size * 2));
+		mSlotData.clear();
+		mWork.init(size * 4);
+		mCandidateCount = 0;
+
+		for (i = 0; i < 9; i++)
+		{
+			mRotation[i] = 0;
+			mListener[i] = 0;
+		}
+
+		// Spectrum of each response pair, left ear as the real and right as the imaginary part,
+		// so one complex multiply convolves a mono signal for both ears.
+		for (i = 0; i < mDirectionCount; i++)
+		{
+			float *spectrum = mSpectrum.mData + i * size;
+			for (j = 0; j < mLength; j++)
+			{
+				spectrum[j * 2] = data[i * mLength * 2 + j];
+				spectrum[j * 2 + 1] = data[i * mLength * 2 + mLength + j];
+			}
+			for (j = mLength * 2; j < size; j++)
+				spectrum[j] = 0;
+			FFT::fft(spectrum, size);
+			for (j = 0; j < 3; j++)
+				mDirection.mData[i * 3 + j] = direction[i * 3 + j];
+		}
+
+		// The sound field is decoded to six virtual speakers around the listener, each
+		// heard through its own response. Both steps are linear, so they fold into one
+		// filter per B-format channel.
+		static const float speaker[6 * 3] =
+		{
+			1, 0, 0, -1, 0, 0,
+			0, 1, 0, 0, -1, 0,
+			0, 0, 1, 0, 0, -1
+		};
+		mFieldFilter.clear();
+		float *spectrum = mWork.mData;
+		for (i = 0; i < 6; i++)
+		{
+			float gain[4];
+			calc_ambisonic_gains(gain, speaker + i * 3, 4);
+			interpolate_internal(spectrum, speaker + i * 3);
+			for (k = 0; k < 4; k++)
+			{
+				// First order max-rE projection decoder
+				float d = (k == 0 ? 1 : 3 * 0.577350f * gain[k]) / 6;
+				for (j = 0; j < size; j++)
+					mFieldFilter.mData[k * size + j] += d * spectrum[j];
+			}
+		}
+
+		for (i = 0; i < SOLOUD_HRTF_MAX_VOICES; i++)
+		{
+			VoiceSlot &slot = mSlot[i];
+			slot.mVoice = 0;
+			slot.mPlayIndex = 0;
+			slot.mRelease = false;
+			slot.mSeen = false;
+			slot.mEnding = false;
+			slot.mValid = false;
+			slot.mGain = 0;
+			slot.mVolume = 0;
+			slot.mSource[0] = 0;
+			slot.mSource[1] = 0;
+			slot.mSource[2] = 0;
+			slot.mDirection[0] = 0;
+			slot.mDirection[1] = 0;
+			slot.mDirection[2] = 0;
+			slot.mInput = 0;
+			slot.mFilter = 0;
+			slot.mTail = 0;
+			slot.mTailLength = 0;
+			if (i < mMaxVoices)
+			{
+				slot.mInput = mSlotData.mData + i * (mBlockSize + size * 2);
+				slot.mFilter = slot.mInput + mBlockSize;
+				slot.mTail = slot.mFilter + size;
+			}
+		}
+	}
+
+	void HrtfBusInstance::interpolate_internal(float *aSpectrum, const float *aDirection)
+	{
+		// Blend the three nearest directions, weighted by how close they are
+		int nearest[3] = { -1, -1, -1 };
+		float nearestdot[3] = { -2, -2, -2 };
+		unsigned int i, j;
+		for (i = 0; i < mDirectionCount; i++)
+		{
+			const float *d = mDirection.mData + i * 3;
+			float dot = d[0] * aDirection[0] + d[1] * aDirection[1] + d[2] * aDirection[2];
+			for (j = 0; j < 3; j++)
+			{
+				if (dot > nearestdot[j])
+				{
+					unsigned int k;
+					for (k = 2; k > j; k--)
+					{
+						nearest[k] = nearest[k - 1];
+						nearestdot[k] = nearestdot[k - 1];
+					}
+					nearest[j] = i;
+					nearestdot[j] = dot;
+					break;
+				}
+			}
+		}
+
+		float weight[3];
+		float total = 0;
+		for (j = 0; j < 3; j++)
+		{
+			weight[j] = nearest[j] < 0 ? 0 : 1 / (1.0001f - nearestdot[j]);
+			total += weight[j];
+		}
+
+		unsigned int size = mFFTSize * 2;
+		for (i = 0; i < size; i++)
+			aSpectrum[i] = 0;
+		for (j = 0; j < 3; j++)
+		{
+			if (nearest[j] < 0)
+				continue;
+			float w = weight[j] / total;
+			const float *spectrum = mSpectrum.mData + nearest[j] * size;
+			for (i = 0; i < size; i++)
+				aSpectrum[i] += w * spectrum[i];
+		}
+	}
+
+	void HrtfBusInstance::pan(Soloud *aSoloud, AudioSourceInstance *aVoice, float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize, float *aScratch, unsigned int aChannels)
+	{
+		fold_to_mono(aScratch, aSamplesToRead, aBufferSize, aVoice->mChannels);
+
+		unsigned int i;
+		VoiceSlot *slot = 0;
+		for (i = 0; i < mMaxVoices; i++)
+		{
+			if (mSlot[i].mVoice == aVoice && mSlot[i].mPlayIndex == aVoice->mPlayIndex)
+			{
+				slot = &mSlot[i];
+				break;
+			}
+		}
+
+		// The mixer stops voices that end right after panning them, so everything the slots
+		// need later in the block is copied here rather than read from the voice
+		bool ending = !(aVoice->mFlags & AudioSourceInstance::LOOPING) && aVoice->hasEnded();
+		float fieldvolume = aVoice->mOverallVolume;
+		if (slot)
+		{
+			// Cross-fade between the sound field and the slot as voices move in and out
+			float target = slot->mRelease ? 0 : aVoice->mOverallVolume;
+			if (!slot->mRelease)
+				fieldvolume = 0;
+			aSoloud->mSimd->mixRamp(aScratch, slot->mInput, aSamplesToRead, slot->mGain, (target - slot->mGain) / aSamplesToRead);
+			slot->mGain = target;
+			slot->mSeen = true;
+			slot->mEnding = ending;
+			slot->mVolume = aVoice->mOverallVolume;
+			for (i = 0; i < 3; i++)
+				slot->mSource[i] = aVoice->m3dDirection[i];
+		}
+		else if ((aVoice->mFlags & AudioSourceInstance::PROCESS_3D) && !ending)
+		{
+			// Keep the loudest voices as candidates for slots
+			unsigned int pos = mCandidateCount;
+			while (pos > 0 && mCandidate[pos - 1].mVolume < aVoice->mOverallVolume)
+				pos--;
+			if (pos < mMaxVoices)
+			{
+				if (mCandidateCount < mMaxVoices)
+					mCandidateCount++;
+				for (i = mCandidateCount - 1; i > pos; i--)
+					mCandidate[i] = mCandidate[i - 1];
+				Candidate &c = mCandidate[pos];
+				c.mVoice = aVoice;
+				c.mPlayIndex = aVoice->mPlayIndex;
+				c.mVolume = aVoice->mOverallVolume;
+				for (i = 0; i < 3; i++)
+					c.mSource[i] = aVoice->m3dDirection[i];
+			}
+		}
+
+		if (fieldvolume != 0 || aVoice->mCurrentAmbisonicGain[0] != 0)
+		{
+			encode_ambisonic(aSoloud->mSimd, aVoice, aScratch, aBuffer, aSamplesToRead, aBufferSize, aChannels, fieldvolume);
+			mFieldActive = true;
+		}
+	}
+
+	void HrtfBusInstance::renderField_internal(float *aBuffer, unsigned int aSamples, unsigned int aBufferSize)
+	{
+		Soloud *s = mParent->mSoloud;
+		unsigned int size = mFFTSize * 2;
+		unsigned int i, j, k;
+
+		if (!mFieldActive)
+		{
+			if (mFieldTailLength)
+			{
+				overlapAdd(0, mFieldTail.mData, aBuffer, aBuffer + aBufferSize, aSamples, mFFTSize);
+				mFieldTailLength = mFieldTailLength > aSamples ? mFieldTailLength - aSamples : 0;
+			}
+			return;
+		}
+
+		// Rotate the world space field into listener space. The first order harmonics are the
+		// direction's components with the x and z axes flipped, so the rotation is the
+		// listener matrix with the same flips applied to its rows and columns.
+		static const float flip[3] = { -1, 1, -1 };
+		float rotation[9];
+		for (i = 0; i < 3; i++)
+			for (j = 0; j < 3; j++)
+				rotation[i * 3 + j] = flip[i] * flip[j] * mListener[i * 3 + j];
+
+		float *field = mField.mData;
+		float *local = mLocalField.mData;
+		memcpy(local, field, sizeof(float) * aSamples);
+		for (i = 0; i < 3; i++)
+		{
+			float *dst = local + aBufferSize * (i + 1);
+			for (k = 0; k < aSamples; k++)
+				dst[k] = 0;
+			for (j = 0; j < 3; j++)
+			{
+				float from = mRotation[i * 3 + j];
+				float to = rotation[i * 3 + j];
+				if (from != 0 || to != 0)
+					s->mSimd->mixRamp(field + aBufferSize * (j + 1), dst, aSamples, from, (to - from) / aSamples);
+				mRotation[i * 3 + j] = to;
+			}
+		}
+
+		float *spectrum = mWork.mData;
+		float *result = mWork.mData + size;
+		for (i = 0; i < size; i++)
+			result[i] = 0;
+		for (k = 0; k < 4; k++)
+		{
+			transform(local + aBufferSize * k, aSamples, spectrum, mFFTSize);
+			s->mSimd->complexMulAdd(spectrum, mFieldFilter.mData + k * size, result, mFFTSize);
+		}
+		FFT::ifft(result, size);
+		overlapAdd(result, mFieldTail.mData, aBuffer, aBuffer + aBufferSize, aSamples, mFFTSize);
+		mFieldTailLength = mFieldTailLength > aSamples ? mFieldTailLength - aSamples : 0;
+		if (mFieldTailLength < mLength - 1)
+			mFieldTailLength = mLength - 1;
+	}
+
+	void HrtfBusInstance::renderSlot_internal(VoiceSlot &aSlot, float *aBuffer, unsigned int aSamples, unsigned int aBufferSize)
+	{
+		Soloud *s = mParent->mSoloud;
+		unsigned int size = mFFTSize * 2;
+		unsigned int i;
+
+		if (aSlot.mVoice && !aSlot.mSeen)
+		{
+			// Stopped, paused or inaudible; the slot is free for someone else
+			aSlot.mVoice = 0;
+		}
+
+		if (!aSlot.mVoice)
+		{
+			if (aSlot.mTailLength)
+			{
+				overlapAdd(0, aSlot.mTail, aBuffer, aBuffer + aBufferSize, aSamples, mFFTSize);
+				aSlot.mTailLength = aSlot.mTailLength > aSamples ? aSlot.mTailLength - aSamples : 0;
+			}
+			return;
+		}
+
+		// Direction in listener space
+		const float *d = aSlot.mSource;
+		float dir[3];
+		for (i = 0; i < 3; i++)
+			dir[i] = mListener[i * 3 + 0] * d[0] + mListener[i * 3 + 1] * d[1] + mListener[i * 3 + 2] * d[2];
+		if (dir[0] == 0 && dir[1] == 0 && dir[2] == 0)
+			dir[2] = 1;
+
+		if (!aSlot.mValid)
+		{
+			interpolate_internal(aSlot.mFilter, dir);
+			memcpy(aSlot.mDirection, dir, sizeof(float) * 3);
+			aSlot.mValid = true;
+		}
+
+		float *spectrum = mWork.mData;
+		float *result = mWork.mData + size;
+		transform(aSlot.mInput, aSamples, spectrum, mFFTSize);
+		for (i = 0; i < size; i++)
+			result[i] = 0;
+		s->mSimd->complexMulAdd(spectrum, aSlot.mFilter, result, mFFTSize);
+		FFT::ifft(result, size);
+
+		float dot = dir[0] * aSlot.mDirection[0] + dir[1] * aSlot.mDirection[1] + dir[2] * aSlot.mDirection[2];
+		if (dot < 0.99999f)
+		{
+			// Moved; convolve with the new filter as well and cross-fade to it over the block
+			float *filter = mWork.mData + size * 2;
+			float *newresult = mWork.mData + size * 3;
+			interpolate_internal(filter, dir);
+			for (i = 0; i < size; i++)
+				newresult[i] = 0;
+			s->mSimd->complexMulAdd(spectrum, filter, newresult, mFFTSize);
+			FFT::ifft(newresult, size);
+			for (i = 0; i < aSamples; i++)
+			{
+				float t = (i + 1) / (float)aSamples;
+				newresult[i * 2] = result[i * 2] + (newresult[i * 2] - result[i * 2]) * t;
+				newresult[i * 2 + 1] = result[i * 2 + 1] + (newresult[i * 2 + 1] - result[i * 2 + 1]) * t;
+			}
+			memcpy(aSlot.mFilter, filter, sizeof(float) * size);
+			memcpy(aSlot.mDirection, dir, sizeof(float) * 3);
+			result = newresult;
+		}
+
+		overlapAdd(result, aSlot.mTail, aBuffer, aBuffer + aBufferSize, aSamples, mFFTSize);
+		aSlot.mTailLength = aSlot.mTailLength > aSamples ? aSlot.mTailLength - aSamples : 0;
+		if (aSlot.mTailLength < mLength - 1)
+			aSlot.mTailLength = mLength - 1;
+
+		if (aSlot.mRelease || aSlot.mEnding)
+		{
+			// Faded out to the sound field, or stopped, during this block
+			aSlot.mVoice = 0;
+		}
+	}
+
+	void HrtfBusInstance::assignSlots_internal()
+	{
+		unsigned int i, j;
+		for (i = 0; i < mCandidateCount; i++)
+		{
+			const Candidate &c = mCandidate[i];
+			VoiceSlot *weakest = 0;
+			for (j = 0; j < mMaxVoices; j++)
+			{
+				VoiceSlot &slot = mSlot[j];
+				if (slot.mVoice == 0)
+				{
+					slot.mVoice = c.mVoice;
+					slot.mPlayIndex = c.mPlayIndex;
+					slot.mRelease = false;
+					slot.mEnding = false;
+					slot.mValid = false;
+					slot.mGain = 0;
+					slot.mVolume = c.mVolume;
+					memcpy(slot.mSource, c.mSource, sizeof(float) * 3);
+					weakest = 0;
+					break;
+				}
+				if (!slot.mRelease && (weakest == 0 || slot.mVolume < weakest->mVolume))
+					weakest = &slot;
+			}
+			// Swap only for a clearly louder voice so that similar voices don't keep trading places.
+			// The released slot is free for the candidate on a later block.
+			if (weakest && weakest->mVolume * 2 < c.mVolume)
+				weakest->mRelease = true;
+		}
+	}
+
+	unsigned int HrtfBusInstance::getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize)
+	{
+		unsigned int i;
+		for (i = 0; i < aBufferSize * mChannels; i++)
+			aBuffer[i] = 0;
+
+		int handle = mParent->mChannelHandle;
+		if (handle == 0 || mChannels < 2 || aSamplesToRead > mBlockSize)
+			return aSamplesToRead;
+
+		Soloud *s = mParent->mSoloud;
+		if (s->mScratchNeeded != mScratchSize)
+		{
+			mScratchSize = s->mScratchNeeded;
+			mScratch.init(mScratchSize * MAX_CHANNELS);
+			mField.init(mScratchSize * 4);
+			mLocalField.init(mScratchSize * 4);
+		}
+
+		s->get3dListenerMatrix_internal(mListener);
+		for (i = 0; i < mMaxVoices; i++)
+		{
+			mSlot[i].mSeen = false;
+			if (mSlot[i].mVoice)
+				memset(mSlot[i].mInput, 0, sizeof(float) * aSamplesToRead);
+		}
+		mCandidateCount = 0;
+		mFieldActive = false;
+
+		s->mixBus_internal(mField.mData, aSamplesToRead, aBufferSize, mScratch.mData, handle, mSamplerate, 4, this);
+
+		renderField_internal(aBuffer, aSamplesToRead, aBufferSize);
+		for (i = 0; i < mMaxVoices; i++)
+			renderSlot_internal(mSlot[i], aBuffer, aSamplesToRead, aBufferSize);
+		assignSlots_internal();
+
+		updateVisualization_internal(aBuffer, aSamplesToRead, aBufferSize);
+		return aSamplesToRead;
+	}
+
+	HrtfBus::HrtfBus()
+	{
+		mHrtf = 0;
+		mMaxVoices = 8;
+	}
+
+	BusInstance * HrtfBus::createInstance()
+	{
+		if (mChannelHandle)
+		{
+			stop();
+			mChannelHandle = 0;
+			mInstance = 0;
+		}
+		mInstance = new HrtfBusInstance(this);
+		return mInstance;
+	}
+
+	void HrtfBus::setHrtf(Hrtf *aHrtf)
+	{
+		mHrtf = aHrtf;
+	}
+
+	result HrtfBus::setMaxVoices(unsigned int aVoices)
+	{
+		if (aVoices > SOLOUD_HRTF_MAX_VOICES)
+			return INVALID_PARAMETER;
+		mMaxVoices = aVoices;
+		return SO_NO_ERROR;
+	}
+
+	unsigned int HrtfBus::getMaxVoices()
+	{
+		return mMaxVoices;
+	}
+};
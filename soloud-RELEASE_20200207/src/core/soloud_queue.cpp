@@ -47,7 +47,8 @@ namespace SoLoud
 			copycount -= readcount;
 			if (mParent->mSource[mParent->mReadIndex]->hasEnded())
 			{
-				delete mParent->mSource[mParent->mReadIndex];
+				// Called from the audio thread; let destroyRetiredVoices run the destructor
+				mParent->mSoloud->retireInstance_internal(mParent->mSource[mParent->mReadIndex]);
 				mParent->mSource[mParent->mReadIndex] = 0;
 				mParent->mReadIndex = (mParent->mReadIndex + 1) % SOLOUD_QUEUE_MAX;
 				mParent->mCount--;
@@ -122,6 +123,8 @@ namespace SoLoud
 			aSound.mAudioSourceID = mSoloud->mAudioSourceID;
 			mSoloud->mAudioSourceID++;
 		}
+		// Played-out entries are retired, so the source's destructor has to drain them through stopAudioSource
+		aSound.mSoloud = mSoloud;
 
 		SoLoud::AudioSourceInstance *instance = aSound.createInstance();
 
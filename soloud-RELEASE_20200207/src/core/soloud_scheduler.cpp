@@ -0,0 +1,163 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include <string.h>
+#include "soloud.h"
+#include "soloud_scheduler.h"
+
+namespace SoLoud
+{
+	Scheduler::Scheduler()
+	{
+		mEvent = 0;
+		mCount = 0;
+		mCapacity = 0;
+	}
+
+	Scheduler::~Scheduler()
+	{
+		delete[] mEvent;
+	}
+
+	result Scheduler::push(const ScheduledEvent &aEvent)
+	{
+		if (mCount == mCapacity)
+		{
+			unsigned int newcap = mCapacity ? mCapacity * 2 : 64;
+			ScheduledEvent *n = new ScheduledEvent[newcap];
+			if (n == NULL)
+				return OUT_OF_MEMORY;
+			if (mCount)
+				memcpy(n, mEvent, sizeof(ScheduledEvent) * mCount);
+			delete[] mEvent;
+			mEvent = n;
+			mCapacity = newcap;
+		}
+		mEvent[mCount] = aEvent;
+		mCount++;
+		siftUp(mCount - 1);
+		return SO_NO_ERROR;
+	}
+
+	ScheduledEvent *Scheduler::top()
+	{
+		if (mCount == 0)
+			return 0;
+		return &mEvent[0];
+	}
+
+	void Scheduler::pop()
+	{
+		if (mCount == 0)
+			return;
+		mCount--;
+		if (mCount)
+		{
+			mEvent[0] = mEvent[mCount];
+			siftDown(0);
+		}
+	}
+
+	void Scheduler::removeAt(unsigned int aIndex, ScheduledEvent &aEvent)
+	{
+		if (aIndex >= mCount)
+			return;
+		aEvent = mEvent[aIndex];
+		mCount--;
+		if (aIndex == mCount)
+			return;
+		mEvent[aIndex] = mEvent[mCount];
+		// The moved event may belong either above or below its new slot
+		if (aIndex > 0 && less(aIndex, (aIndex - 1) / 2))
+			siftUp(aIndex);
+		else
+			siftDown(aIndex);
+	}
+
+	int Scheduler::find(unsigned int aId) const
+	{
+		unsigned int i;
+		for (i = 0; i < mCount; i++)
+		{
+			if (mEvent[i].mId == aId)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	void Scheduler::rebuild()
+	{
+		unsigned int i = mCount / 2;
+		while (i > 0)
+		{
+			i--;
+			siftDown(i);
+		}
+	}
+
+	bool Scheduler::less(unsigned int aA, unsigned int aB) const
+	{
+		if (mEvent[aA].mStartSample != mEvent[aB].mStartSample)
+			return mEvent[aA].mStartSample < mEvent[aB].mStartSample;
+		// Same start sample; keep the order the events were scheduled in
+		return (int)(mEvent[aA].mId - mEvent[aB].mId) < 0;
+	}
+
+	void Scheduler::swap(unsigned int aA, unsigned int aB)
+	{
+		ScheduledEvent t = mEvent[aA];
+		mEvent[aA] = mEvent[aB];
+		mEvent[aB] = t;
+	}
+
+	void Scheduler::siftUp(unsigned int aIndex)
+	{
+		while (aIndex > 0)
+		{
+			unsigned int parent = (aIndex - 1) / 2;
+			if (!less(aIndex, parent))
+				break;
+			swap(aIndex, parent);
+			aIndex = parent;
+		}
+	}
+
+	void Scheduler::siftDown(unsigned int aIndex)
+	{
+		for (;;)
+		{
+			unsigned int left = aIndex * 2 + 1;
+			unsigned int right = left + 1;
+			unsigned int smallest = aIndex;
+			if (left < mCount && less(left, smallest))
+				smallest = left;
+			if (right < mCount && less(right, smallest))
+				smallest = right;
+			if (smallest == aIndex)
+				break;
+			swap(aIndex, smallest);
+			aIndex = smallest;
+		}
+	}
+};
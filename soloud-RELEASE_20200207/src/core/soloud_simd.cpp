@@ -0,0 +1,893 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "soloud.h"
+#include "soloud_simd.h"
+
+#ifdef SOLOUD_SSE_INTRINSICS
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace SoLoud
+{
+	////////////////////////////////////////////////////////////
+	// Scalar reference kernels
+
+	static void clipHard_scalar(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		float v = aVolume;
+		unsigned int i;
+		for (i = 0; i < aSamples; i++)
+		{
+			float f = aSrc[i] * v;
+			v += aVolumeDelta;
+			f = (f <= -1) ? -1 : (f >= 1) ? 1 : f;
+			aDst[i] = f * aPostScale;
+		}
+	}
+
+	static void clipRoundoff_scalar(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		float v = aVolume;
+		unsigned int i;
+		for (i = 0; i < aSamples; i++)
+		{
+			float f = aSrc[i] * v;
+			v += aVolumeDelta;
+			f = (f <= -1.65f) ? -0.9862875f : (f >= 1.65f) ? 0.9862875f : (0.87f * f - 0.1f * f * f * f);
+			aDst[i] = f * aPostScale;
+		}
+	}
+
+	static void resamplePoint_scalar(const float *aSrc, const float * /*aSrc1*/, unsigned int /*aSrcSampleCount*/, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed)
+	{
+		int i;
+		int pos = aSrcOffset;
+
+		for (i = 0; i < aDstSampleCount; i++, pos += aStepFixed)
+		{
+			int p = pos >> FIXPOINT_FRAC_BITS;
+			aDst[i] = aSrc[p];
+		}
+	}
+
+	static void resample_scalar(const float *aSrc, const float *aSrc1, unsigned int aSrcSampleCount, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed)
+	{
+#if defined(RESAMPLER_LINEAR)
+		int i;
+		int pos = aSrcOffset;
+
+		for (i = 0; i < aDstSampleCount; i++, pos += aStepFixed)
+		{
+			int p = pos >> FIXPOINT_FRAC_BITS;
+			int f = pos & FIXPOINT_FRAC_MASK;
+#ifdef _DEBUG
+			if (p >= (int)aSrcSampleCount || p < 0)
+			{
+				// This should never actually happen
+				p = aSrcSampleCount - 1;
+			}
+#endif
+			float s1 = aSrc1[aSrcSampleCount - 1];
+			float s2 = aSrc[p];
+			if (p != 0)
+			{
+				s1 = aSrc[p-1];
+			}
+			aDst[i] = s1 + (s2 - s1) * f * (1 / (float)FIXPOINT_FRAC_MUL);
+		}
+#else // Point sample
+		resamplePoint_scalar(aSrc, aSrc1, aSrcSampleCount, aDst, aSrcOffset, aDstSampleCount, aStepFixed);
+#endif
+	}
+
+	static void mixRamp_scalar(const float *aSrc, float *aDst, unsigned int aSamples, float aPan, float aPanDelta)
+	{
+		unsigned int i;
+		for (i = 0; i < aSamples; i++)
+		{
+			aPan += aPanDelta;
+			aDst[i] += aSrc[i] * aPan;
+		}
+	}
+
+	static void complexMulAdd_scalar(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aCount)
+	{
+		unsigned int i;
+		for (i = 0; i < aCount * 2; i += 2)
+		{
+			float re = aSrc0[i] * aSrc1[i] - aSrc0[i + 1] * aSrc1[i + 1];
+			float im = aSrc0[i] * aSrc1[i + 1] + aSrc0[i + 1] * aSrc1[i];
+			aDst[i] += re;
+			aDst[i + 1] += im;
+		}
+	}
+
+	// Fused voice kernels, one instance per source and output channel count and resampler. The
+	// output channel is fed by the sum of the source channels (DST 1), the only one (SRC 1), or its own.
+	template <unsigned int SRC, unsigned int DST, bool POINT>
+	static void mixVoice_scalar(const float *aSrc, unsigned int aSrcPitch, const float *aPrev, float *aDst, unsigned int aDstPitch, unsigned int aSamples, int aSrcOffset, int aStepFixed, const float *aPan, const float *aPanDelta)
+	{
+		float pan[DST];
+		unsigned int c, k;
+		for (k = 0; k < DST; k++)
+			pan[k] = aPan[k];
+
+		unsigned int i;
+		int pos = aSrcOffset;
+		for (i = 0; i < aSamples; i++, pos += aStepFixed)
+		{
+			int p = pos >> FIXPOINT_FRAC_BITS;
+			float s[SRC];
+			for (c = 0; c < SRC; c++)
+			{
+				const float *src = aSrc + aSrcPitch * c;
+				if (POINT)
+				{
+					s[c] = src[p];
+				}
+				else
+				{
+					float s1 = p ? src[p - 1] : aPrev[c];
+					float s2 = src[p];
+					s[c] = s1 + (s2 - s1) * (pos & FIXPOINT_FRAC_MASK) * (1 / (float)FIXPOINT_FRAC_MUL);
+				}
+			}
+			for (k = 0; k < DST; k++)
+			{
+				pan[k] += aPanDelta[k];
+				float *dst = aDst + aDstPitch * k + i;
+				if (DST == 1)
+				{
+					for (c = 0; c < SRC; c++)
+						*dst += s[c] * pan[0];
+				}
+				else
+				{
+					*dst += s[SRC == 1 ? 0 : k] * pan[k];
+				}
+			}
+		}
+	}
+
+	static const SimdKernels gScalarKernels =
+	{
+		clipHard_scalar,
+		clipRoundoff_scalar,
+		resample_scalar,
+		resamplePoint_scalar,
+		mixRamp_scalar,
+		complexMulAdd_scalar
+	};
+
+#ifdef SOLOUD_SSE_INTRINSICS
+	////////////////////////////////////////////////////////////
+	// SSE2 kernels. Tails that don't fill a vector go to the scalar kernels.
+
+	SOLOUD_TARGET_SSE2
+	static void clipHard_sse2(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		__m128 negbound = _mm_set1_ps(-1.0f);
+		__m128 posbound = _mm_set1_ps(1.0f);
+		__m128 postscale = _mm_set1_ps(aPostScale);
+		__m128 vol = _mm_add_ps(_mm_set1_ps(aVolume), _mm_mul_ps(_mm_set1_ps(aVolumeDelta), _mm_setr_ps(0, 1, 2, 3)));
+		__m128 vdelta = _mm_set1_ps(aVolumeDelta * 4);
+		unsigned int i;
+		for (i = 0; i + 4 <= aSamples; i += 4)
+		{
+			__m128 f = _mm_mul_ps(_mm_loadu_ps(aSrc + i), vol);
+			vol = _mm_add_ps(vol, vdelta);
+			f = _mm_max_ps(f, negbound);
+			f = _mm_min_ps(f, posbound);
+			_mm_storeu_ps(aDst + i, _mm_mul_ps(f, postscale));
+		}
+		if (i < aSamples)
+			clipHard_scalar(aSrc + i, aDst + i, aSamples - i, aVolume + aVolumeDelta * i, aVolumeDelta, aPostScale);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void clipRoundoff_sse2(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		__m128 negbound = _mm_set1_ps(-1.65f);
+		__m128 posbound = _mm_set1_ps(1.65f);
+		__m128 linearscale = _mm_set1_ps(0.87f);
+		__m128 cubicscale = _mm_set1_ps(-0.1f);
+		__m128 negwall = _mm_set1_ps(-0.9862875f);
+		__m128 poswall = _mm_set1_ps(0.9862875f);
+		__m128 postscale = _mm_set1_ps(aPostScale);
+		__m128 vol = _mm_add_ps(_mm_set1_ps(aVolume), _mm_mul_ps(_mm_set1_ps(aVolumeDelta), _mm_setr_ps(0, 1, 2, 3)));
+		__m128 vdelta = _mm_set1_ps(aVolumeDelta * 4);
+		unsigned int i;
+		for (i = 0; i + 4 <= aSamples; i += 4)
+		{
+			__m128 f = _mm_mul_ps(_mm_loadu_ps(aSrc + i), vol);
+			vol = _mm_add_ps(vol, vdelta);
+			__m128 u = _mm_cmpgt_ps(f, negbound);
+			__m128 o = _mm_cmplt_ps(f, posbound);
+			__m128 lin = _mm_mul_ps(f, linearscale);
+			__m128 cubic = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(f, f), f), cubicscale);
+			f = _mm_add_ps(cubic, lin);
+			f = _mm_or_ps(_mm_andnot_ps(u, negwall), _mm_and_ps(u, f));
+			f = _mm_or_ps(_mm_andnot_ps(o, poswall), _mm_and_ps(o, f));
+			_mm_storeu_ps(aDst + i, _mm_mul_ps(f, postscale));
+		}
+		if (i < aSamples)
+			clipRoundoff_scalar(aSrc + i, aDst + i, aSamples - i, aVolume + aVolumeDelta * i, aVolumeDelta, aPostScale);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void resample_sse2(const float *aSrc, const float *aSrc1, unsigned int aSrcSampleCount, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed)
+	{
+		int i = 0;
+		int pos = aSrcOffset;
+		// Samples that interpolate against the previous block
+		while (i < aDstSampleCount && (pos >> FIXPOINT_FRAC_BITS) == 0)
+		{
+			i++;
+			pos += aStepFixed;
+		}
+		resample_scalar(aSrc, aSrc1, aSrcSampleCount, aDst, aSrcOffset, i, aStepFixed);
+
+		__m128 scale = _mm_set1_ps(1 / (float)FIXPOINT_FRAC_MUL);
+		__m128i mask = _mm_set1_epi32(FIXPOINT_FRAC_MASK);
+		for (; i + 4 <= aDstSampleCount; i += 4, pos += aStepFixed * 4)
+		{
+			int p0 = pos >> FIXPOINT_FRAC_BITS;
+			int p1 = (pos + aStepFixed) >> FIXPOINT_FRAC_BITS;
+			int p2 = (pos + aStepFixed * 2) >> FIXPOINT_FRAC_BITS;
+			int p3 = (pos + aStepFixed * 3) >> FIXPOINT_FRAC_BITS;
+			__m128 s1 = _mm_setr_ps(aSrc[p0 - 1], aSrc[p1 - 1], aSrc[p2 - 1], aSrc[p3 - 1]);
+			__m128 s2 = _mm_setr_ps(aSrc[p0], aSrc[p1], aSrc[p2], aSrc[p3]);
+			__m128i posv = _mm_setr_epi32(pos, pos + aStepFixed, pos + aStepFixed * 2, pos + aStepFixed * 3);
+			__m128 f = _mm_cvtepi32_ps(_mm_and_si128(posv, mask));
+			__m128 d = _mm_add_ps(s1, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(s2, s1), f), scale));
+			_mm_storeu_ps(aDst + i, d);
+		}
+		if (i < aDstSampleCount)
+			resample_scalar(aSrc, aSrc1, aSrcSampleCount, aDst + i, pos, aDstSampleCount - i, aStepFixed);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void mixRamp_sse2(const float *aSrc, float *aDst, unsigned int aSamples, float aPan, float aPanDelta)
+	{
+		__m128 pan = _mm_add_ps(_mm_set1_ps(aPan), _mm_mul_ps(_mm_set1_ps(aPanDelta), _mm_setr_ps(1, 2, 3, 4)));
+		__m128 pdelta = _mm_set1_ps(aPanDelta * 4);
+		unsigned int i;
+		for (i = 0; i + 4 <= aSamples; i += 4)
+		{
+			__m128 d = _mm_loadu_ps(aDst + i);
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(aSrc + i), pan));
+			_mm_storeu_ps(aDst + i, d);
+			pan = _mm_add_ps(pan, pdelta);
+		}
+		if (i < aSamples)
+			mixRamp_scalar(aSrc + i, aDst + i, aSamples - i, aPan + aPanDelta * i, aPanDelta);
+	}
+
+	SOLOUD_TARGET_SSE2
+	static void complexMulAdd_sse2(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aCount)
+	{
+		// (a + bi)(c + di): a*c and b*c, plus the swapped b*d and a*d with the real part negated
+		__m128 sign = _mm_setr_ps(-1, 1, -1, 1);
+		unsigned int i;
+		for (i = 0; i + 2 <= aCount; i += 2)
+		{
+			__m128 x = _mm_loadu_ps(aSrc0 + i * 2);
+			__m128 y = _mm_loadu_ps(aSrc1 + i * 2);
+			__m128 yre = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 yim = _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1));
+			__m128 xswap = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+			__m128 r = _mm_add_ps(_mm_mul_ps(x, yre), _mm_mul_ps(_mm_mul_ps(xswap, yim), sign));
+			_mm_storeu_ps(aDst + i * 2, _mm_add_ps(_mm_loadu_ps(aDst + i * 2), r));
+		}
+		if (i < aCount)
+			complexMulAdd_scalar(aSrc0 + i * 2, aSrc1 + i * 2, aDst + i * 2, aCount - i);
+	}
+
+	// Samples that interpolate against the previous block, and the tail, go to the scalar kernel
+	template <unsigned int SRC, unsigned int DST, bool POINT>
+	SOLOUD_TARGET_SSE2
+	static void mixVoice_sse2(const float *aSrc, unsigned int aSrcPitch, const float *aPrev, float *aDst, unsigned int aDstPitch, unsigned int aSamples, int aSrcOffset, int aStepFixed, const float *aPan, const float *aPanDelta)
+	{
+		unsigned int i = 0;
+		int pos = aSrcOffset;
+		while (!POINT && i < aSamples && (pos >> FIXPOINT_FRAC_BITS) == 0)
+		{
+			i++;
+			pos += aStepFixed;
+		}
+		mixVoice_scalar<SRC, DST, POINT>(aSrc, aSrcPitch, aPrev, aDst, aDstPitch, i, aSrcOffset, aStepFixed, aPan, aPanDelta);
+
+		unsigned int c, k;
+		__m128 pan[DST];
+		__m128 pdelta[DST];
+		for (k = 0; k < DST; k++)
+		{
+			pan[k] = _mm_add_ps(_mm_set1_ps(aPan[k] + aPanDelta[k] * i), _mm_mul_ps(_mm_set1_ps(aPanDelta[k]), _mm_setr_ps(1, 2, 3, 4)));
+			pdelta[k] = _mm_set1_ps(aPanDelta[k] * 4);
+		}
+		__m128 scale = _mm_set1_ps(1 / (float)FIXPOINT_FRAC_MUL);
+		__m128i mask = _mm_set1_epi32(FIXPOINT_FRAC_MASK);
+		for (; i + 4 <= aSamples; i += 4, pos += aStepFixed * 4)
+		{
+			int p0 = pos >> FIXPOINT_FRAC_BITS;
+			int p1 = (pos + aStepFixed) >> FIXPOINT_FRAC_BITS;
+			int p2 = (pos + aStepFixed * 2) >> FIXPOINT_FRAC_BITS;
+			int p3 = (pos + aStepFixed * 3) >> FIXPOINT_FRAC_BITS;
+			__m128 f = _mm_setzero_ps();
+			if (!POINT)
+			{
+				__m128i posv = _mm_setr_epi32(pos, pos + aStepFixed, pos + aStepFixed * 2, pos + aStepFixed * 3);
+				f = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(posv, mask)), scale);
+			}
+			__m128 s[SRC];
+			for (c = 0; c < SRC; c++)
+			{
+				const float *src = aSrc + aSrcPitch * c;
+				s[c] = _mm_setr_ps(src[p0], src[p1], src[p2], src[p3]);
+				if (!POINT)
+				{
+					__m128 s1 = _mm_setr_ps(src[p0 - 1], src[p1 - 1], src[p2 - 1], src[p3 - 1]);
+					s[c] = _mm_add_ps(s1, _mm_mul_ps(_mm_sub_ps(s[c], s1), f));
+				}
+			}
+			for (k = 0; k < DST; k++)
+			{
+				float *dst = aDst + aDstPitch * k + i;
+				__m128 d = _mm_loadu_ps(dst);
+				if (DST == 1)
+				{
+					for (c = 0; c < SRC; c++)
+						d = _mm_add_ps(d, _mm_mul_ps(s[c], pan[0]));
+				}
+				else
+				{
+					d = _mm_add_ps(d, _mm_mul_ps(s[SRC == 1 ? 0 : k], pan[k]));
+				}
+				_mm_storeu_ps(dst, d);
+				pan[k] = _mm_add_ps(pan[k], pdelta[k]);
+			}
+		}
+		if (i < aSamples)
+		{
+			float tailpan[DST];
+			for (k = 0; k < DST; k++)
+				tailpan[k] = aPan[k] + aPanDelta[k] * i;
+			mixVoice_scalar<SRC, DST, POINT>(aSrc, aSrcPitch, aPrev, aDst + i, aDstPitch, aSamples - i, pos, aStepFixed, tailpan, aPanDelta);
+		}
+	}
+
+	static const SimdKernels gSSE2Kernels =
+	{
+		clipHard_sse2,
+		clipRoundoff_sse2,
+#if defined(RESAMPLER_LINEAR)
+		resample_sse2,
+#else
+		resample_scalar,
+#endif
+		resamplePoint_scalar,
+		mixRamp_sse2,
+		complexMulAdd_sse2
+	};
+#endif
+
+#ifdef SOLOUD_AVX_INTRINSICS
+	////////////////////////////////////////////////////////////
+	// AVX2 kernels. Tails go to the SSE2 kernels.
+
+	SOLOUD_TARGET_AVX2
+	static void clipHard_avx2(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		__m256 negbound = _mm256_set1_ps(-1.0f);
+		__m256 posbound = _mm256_set1_ps(1.0f);
+		__m256 postscale = _mm256_set1_ps(aPostScale);
+		__m256 vol = _mm256_add_ps(_mm256_set1_ps(aVolume), _mm256_mul_ps(_mm256_set1_ps(aVolumeDelta), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)));
+		__m256 vdelta = _mm256_set1_ps(aVolumeDelta * 8);
+		unsigned int i;
+		for (i = 0; i + 8 <= aSamples; i += 8)
+		{
+			__m256 f = _mm256_mul_ps(_mm256_loadu_ps(aSrc + i), vol);
+			vol = _mm256_add_ps(vol, vdelta);
+			f = _mm256_max_ps(f, negbound);
+			f = _mm256_min_ps(f, posbound);
+			_mm256_storeu_ps(aDst + i, _mm256_mul_ps(f, postscale));
+		}
+		if (i < aSamples)
+			clipHard_sse2(aSrc + i, aDst + i, aSamples - i, aVolume + aVolumeDelta * i, aVolumeDelta, aPostScale);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void clipRoundoff_avx2(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		__m256 negbound = _mm256_set1_ps(-1.65f);
+		__m256 posbound = _mm256_set1_ps(1.65f);
+		__m256 linearscale = _mm256_set1_ps(0.87f);
+		__m256 cubicscale = _mm256_set1_ps(-0.1f);
+		__m256 negwall = _mm256_set1_ps(-0.9862875f);
+		__m256 poswall = _mm256_set1_ps(0.9862875f);
+		__m256 postscale = _mm256_set1_ps(aPostScale);
+		__m256 vol = _mm256_add_ps(_mm256_set1_ps(aVolume), _mm256_mul_ps(_mm256_set1_ps(aVolumeDelta), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)));
+		__m256 vdelta = _mm256_set1_ps(aVolumeDelta * 8);
+		unsigned int i;
+		for (i = 0; i + 8 <= aSamples; i += 8)
+		{
+			__m256 f = _mm256_mul_ps(_mm256_loadu_ps(aSrc + i), vol);
+			vol = _mm256_add_ps(vol, vdelta);
+			__m256 u = _mm256_cmp_ps(f, negbound, _CMP_GT_OQ);
+			__m256 o = _mm256_cmp_ps(f, posbound, _CMP_LT_OQ);
+			__m256 lin = _mm256_mul_ps(f, linearscale);
+			__m256 cubic = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(f, f), f), cubicscale);
+			f = _mm256_add_ps(cubic, lin);
+			f = _mm256_blendv_ps(negwall, f, u);
+			f = _mm256_blendv_ps(poswall, f, o);
+			_mm256_storeu_ps(aDst + i, _mm256_mul_ps(f, postscale));
+		}
+		if (i < aSamples)
+			clipRoundoff_sse2(aSrc + i, aDst + i, aSamples - i, aVolume + aVolumeDelta * i, aVolumeDelta, aPostScale);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void resample_avx2(const float *aSrc, const float *aSrc1, unsigned int aSrcSampleCount, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed)
+	{
+		int i = 0;
+		int pos = aSrcOffset;
+		while (i < aDstSampleCount && (pos >> FIXPOINT_FRAC_BITS) == 0)
+		{
+			i++;
+			pos += aStepFixed;
+		}
+		resample_scalar(aSrc, aSrc1, aSrcSampleCount, aDst, aSrcOffset, i, aStepFixed);
+
+		__m256 scale = _mm256_set1_ps(1 / (float)FIXPOINT_FRAC_MUL);
+		__m256i mask = _mm256_set1_epi32(FIXPOINT_FRAC_MASK);
+		__m256i one = _mm256_set1_epi32(1);
+		__m256i posv = _mm256_add_epi32(_mm256_set1_epi32(pos), _mm256_mullo_epi32(_mm256_set1_epi32(aStepFixed), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+		__m256i step = _mm256_set1_epi32(aStepFixed * 8);
+		for (; i + 8 <= aDstSampleCount; i += 8, pos += aStepFixed * 8)
+		{
+			__m256i p = _mm256_srai_epi32(posv, FIXPOINT_FRAC_BITS);
+			__m256 s1 = _mm256_i32gather_ps(aSrc, _mm256_sub_epi32(p, one), 4);
+			__m256 s2 = _mm256_i32gather_ps(aSrc, p, 4);
+			__m256 f = _mm256_cvtepi32_ps(_mm256_and_si256(posv, mask));
+			__m256 d = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(s2, s1), f), scale));
+			_mm256_storeu_ps(aDst + i, d);
+			posv = _mm256_add_epi32(posv, step);
+		}
+		if (i < aDstSampleCount)
+			resample_sse2(aSrc, aSrc1, aSrcSampleCount, aDst + i, pos, aDstSampleCount - i, aStepFixed);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void mixRamp_avx2(const float *aSrc, float *aDst, unsigned int aSamples, float aPan, float aPanDelta)
+	{
+		__m256 pan = _mm256_add_ps(_mm256_set1_ps(aPan), _mm256_mul_ps(_mm256_set1_ps(aPanDelta), _mm256_setr_ps(1, 2, 3, 4, 5, 6, 7, 8)));
+		__m256 pdelta = _mm256_set1_ps(aPanDelta * 8);
+		unsigned int i;
+		for (i = 0; i + 8 <= aSamples; i += 8)
+		{
+			__m256 d = _mm256_loadu_ps(aDst + i);
+			d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_loadu_ps(aSrc + i), pan));
+			_mm256_storeu_ps(aDst + i, d);
+			pan = _mm256_add_ps(pan, pdelta);
+		}
+		if (i < aSamples)
+			mixRamp_sse2(aSrc + i, aDst + i, aSamples - i, aPan + aPanDelta * i, aPanDelta);
+	}
+
+	SOLOUD_TARGET_AVX2
+	static void complexMulAdd_avx2(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aCount)
+	{
+		unsigned int i;
+		for (i = 0; i + 4 <= aCount; i += 4)
+		{
+			__m256 x = _mm256_loadu_ps(aSrc0 + i * 2);
+			__m256 y = _mm256_loadu_ps(aSrc1 + i * 2);
+			__m256 xswap = _mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1));
+			__m256 r = _mm256_addsub_ps(_mm256_mul_ps(x, _mm256_moveldup_ps(y)), _mm256_mul_ps(xswap, _mm256_movehdup_ps(y)));
+			_mm256_storeu_ps(aDst + i * 2, _mm256_add_ps(_mm256_loadu_ps(aDst + i * 2), r));
+		}
+		if (i < aCount)
+			complexMulAdd_sse2(aSrc0 + i * 2, aSrc1 + i * 2, aDst + i * 2, aCount - i);
+	}
+
+	template <unsigned int SRC, unsigned int DST, bool POINT>
+	SOLOUD_TARGET_AVX2
+	static void mixVoice_avx2(const float *aSrc, unsigned int aSrcPitch, const float *aPrev, float *aDst, unsigned int aDstPitch, unsigned int aSamples, int aSrcOffset, int aStepFixed, const float *aPan, const float *aPanDelta)
+	{
+		unsigned int i = 0;
+		int pos = aSrcOffset;
+		while (!POINT && i < aSamples && (pos >> FIXPOINT_FRAC_BITS) == 0)
+		{
+			i++;
+			pos += aStepFixed;
+		}
+		mixVoice_scalar<SRC, DST, POINT>(aSrc, aSrcPitch, aPrev, aDst, aDstPitch, i, aSrcOffset, aStepFixed, aPan, aPanDelta);
+
+		unsigned int c, k;
+		__m256 pan[DST];
+		__m256 pdelta[DST];
+		for (k = 0; k < DST; k++)
+		{
+			pan[k] = _mm256_add_ps(_mm256_set1_ps(aPan[k] + aPanDelta[k] * i), _mm256_mul_ps(_mm256_set1_ps(aPanDelta[k]), _mm256_setr_ps(1, 2, 3, 4, 5, 6, 7, 8)));
+			pdelta[k] = _mm256_set1_ps(aPanDelta[k] * 8);
+		}
+		__m256 scale = _mm256_set1_ps(1 / (float)FIXPOINT_FRAC_MUL);
+		__m256i mask = _mm256_set1_epi32(FIXPOINT_FRAC_MASK);
+		__m256i one = _mm256_set1_epi32(1);
+		__m256i posv = _mm256_add_epi32(_mm256_set1_epi32(pos), _mm256_mullo_epi32(_mm256_set1_epi32(aStepFixed), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+		__m256i step = _mm256_set1_epi32(aStepFixed * 8);
+		for (; i + 8 <= aSamples; i += 8, pos += aStepFixed * 8)
+		{
+			__m256i p = _mm256_srai_epi32(posv, FIXPOINT_FRAC_BITS);
+			__m256i p1 = _mm256_sub_epi32(p, one);
+			__m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(posv, mask)), scale);
+			posv = _mm256_add_epi32(posv, step);
+			__m256 s[SRC];
+			for (c = 0; c < SRC; c++)
+			{
+				const float *src = aSrc + aSrcPitch * c;
+				s[c] = _mm256_i32gather_ps(src, p, 4);
+				if (!POINT)
+				{
+					__m256 s1 = _mm256_i32gather_ps(src, p1, 4);
+					s[c] = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_sub_ps(s[c], s1), f));
+				}
+			}
+			for (k = 0; k < DST; k++)
+			{
+				float *dst = aDst + aDstPitch * k + i;
+				__m256 d = _mm256_loadu_ps(dst);
+				if (DST == 1)
+				{
+					for (c = 0; c < SRC; c++)
+						d = _mm256_add_ps(d, _mm256_mul_ps(s[c], pan[0]));
+				}
+				else
+				{
+					d = _mm256_add_ps(d, _mm256_mul_ps(s[SRC == 1 ? 0 : k], pan[k]));
+				}
+				_mm256_storeu_ps(dst, d);
+				pan[k] = _mm256_add_ps(pan[k], pdelta[k]);
+			}
+		}
+		if (i < aSamples)
+		{
+			float tailpan[DST];
+			for (k = 0; k < DST; k++)
+				tailpan[k] = aPan[k] + aPanDelta[k] * i;
+			mixVoice_sse2<SRC, DST, POINT>(aSrc, aSrcPitch, aPrev, aDst + i, aDstPitch, aSamples - i, pos, aStepFixed, tailpan, aPanDelta);
+		}
+	}
+
+	static const SimdKernels gAVX2Kernels =
+	{
+		clipHard_avx2,
+		clipRoundoff_avx2,
+#if defined(RESAMPLER_LINEAR)
+		resample_avx2,
+#else
+		resample_scalar,
+#endif
+		resamplePoint_scalar,
+		mixRamp_avx2,
+		complexMulAdd_avx2
+	};
+
+	////////////////////////////////////////////////////////////
+	// AVX-512 kernels. Tails go to the AVX2 kernels.
+
+	SOLOUD_TARGET_AVX512
+	static void clipHard_avx512(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		__m512 negbound = _mm512_set1_ps(-1.0f);
+		__m512 posbound = _mm512_set1_ps(1.0f);
+		__m512 postscale = _mm512_set1_ps(aPostScale);
+		__m512 ramp = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		__m512 vol = _mm512_add_ps(_mm512_set1_ps(aVolume), _mm512_mul_ps(_mm512_set1_ps(aVolumeDelta), ramp));
+		__m512 vdelta = _mm512_set1_ps(aVolumeDelta * 16);
+		unsigned int i;
+		for (i = 0; i + 16 <= aSamples; i += 16)
+		{
+			__m512 f = _mm512_mul_ps(_mm512_loadu_ps(aSrc + i), vol);
+			vol = _mm512_add_ps(vol, vdelta);
+			f = _mm512_max_ps(f, negbound);
+			f = _mm512_min_ps(f, posbound);
+			_mm512_storeu_ps(aDst + i, _mm512_mul_ps(f, postscale));
+		}
+		if (i < aSamples)
+			clipHard_avx2(aSrc + i, aDst + i, aSamples - i, aVolume + aVolumeDelta * i, aVolumeDelta, aPostScale);
+	}
+
+	SOLOUD_TARGET_AVX512
+	static void clipRoundoff_avx512(const float *aSrc, float *aDst, unsigned int aSamples, float aVolume, float aVolumeDelta, float aPostScale)
+	{
+		__m512 negbound = _mm512_set1_ps(-1.65f);
+		__m512 posbound = _mm512_set1_ps(1.65f);
+		__m512 linearscale = _mm512_set1_ps(0.87f);
+		__m512 cubicscale = _mm512_set1_ps(-0.1f);
+		__m512 negwall = _mm512_set1_ps(-0.9862875f);
+		__m512 poswall = _mm512_set1_ps(0.9862875f);
+		__m512 postscale = _mm512_set1_ps(aPostScale);
+		__m512 ramp = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		__m512 vol = _mm512_add_ps(_mm512_set1_ps(aVolume), _mm512_mul_ps(_mm512_set1_ps(aVolumeDelta), ramp));
+		__m512 vdelta = _mm512_set1_ps(aVolumeDelta * 16);
+		unsigned int i;
+		for (i = 0; i + 16 <= aSamples; i += 16)
+		{
+			__m512 f = _mm512_mul_ps(_mm512_loadu_ps(aSrc + i), vol);
+			vol = _mm512_add_ps(vol, vdelta);
+			__mmask16 u = _mm512_cmp_ps_mask(f, negbound, _CMP_GT_OQ);
+			__mmask16 o = _mm512_cmp_ps_mask(f, posbound, _CMP_LT_OQ);
+			__m512 lin = _mm512_mul_ps(f, linearscale);
+			__m512 cubic = _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(f, f), f), cubicscale);
+			f = _mm512_add_ps(cubic, lin);
+			f = _mm512_mask_blend_ps(u, negwall, f);
+			f = _mm512_mask_blend_ps(o, poswall, f);
+			_mm512_storeu_ps(aDst + i, _mm512_mul_ps(f, postscale));
+		}
+		if (i < aSamples)
+			clipRoundoff_avx2(aSrc + i, aDst + i, aSamples - i, aVolume + aVolumeDelta * i, aVolumeDelta, aPostScale);
+	}
+
+	SOLOUD_TARGET_AVX512
+	static void resample_avx512(const float *aSrc, const float *aSrc1, unsigned int aSrcSampleCount, float *aDst, int aSrcOffset, int aDstSampleCount, int aStepFixed)
+	{
+		int i = 0;
+		int pos = aSrcOffset;
+		while (i < aDstSampleCount && (pos >> FIXPOINT_FRAC_BITS) == 0)
+		{
+			i++;
+			pos += aStepFixed;
+		}
+		resample_scalar(aSrc, aSrc1, aSrcSampleCount, aDst, aSrcOffset, i, aStepFixed);
+
+		__m512 scale = _mm512_set1_ps(1 / (float)FIXPOINT_FRAC_MUL);
+		__m512i mask = _mm512_set1_epi32(FIXPOINT_FRAC_MASK);
+		__m512i one = _mm512_set1_epi32(1);
+		__m512i ramp = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		__m512i posv = _mm512_add_epi32(_mm512_set1_epi32(pos), _mm512_mullo_epi32(_mm512_set1_epi32(aStepFixed), ramp));
+		__m512i step = _mm512_set1_epi32(aStepFixed * 16);
+		for (; i + 16 <= aDstSampleCount; i += 16, pos += aStepFixed * 16)
+		{
+			__m512i p = _mm512_srai_epi32(posv, FIXPOINT_FRAC_BITS);
+			__m512 s1 = _mm512_i32gather_ps(_mm512_sub_epi32(p, one), aSrc, 4);
+			__m512 s2 = _mm512_i32gather_ps(p, aSrc, 4);
+			__m512 f = _mm512_cvtepi32_ps(_mm512_and_si512(posv, mask));
+			__m512 d = _mm512_add_ps(s1, _mm512_mul_ps(_mm512_mul_ps(_mm512_sub_ps(s2, s1), f), scale));
+			_mm512_storeu_ps(aDst + i, d);
+			posv = _mm512_add_epi32(posv, step);
+		}
+		if (i < aDstSampleCount)
+			resample_avx2(aSrc, aSrc1, aSrcSampleCount, aDst + i, pos, aDstSampleCount - i, aStepFixed);
+	}
+
+	SOLOUD_TARGET_AVX512
+	static void mixRamp_avx512(const float *aSrc, float *aDst, unsigned int aSamples, float aPan, float aPanDelta)
+	{
+		__m512 ramp = _mm512_setr_ps(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+		__m512 pan = _mm512_add_ps(_mm512_set1_ps(aPan), _mm512_mul_ps(_mm512_set1_ps(aPanDelta), ramp));
+		__m512 pdelta = _mm512_set1_ps(aPanDelta * 16);
+		unsigned int i;
+		for (i = 0; i + 16 <= aSamples; i += 16)
+		{
+			__m512 d = _mm512_loadu_ps(aDst + i);
+			d = _mm512_add_ps(d, _mm512_mul_ps(_mm512_loadu_ps(aSrc + i), pan));
+			_mm512_storeu_ps(aDst + i, d);
+			pan = _mm512_add_ps(pan, pdelta);
+		}
+		if (i < aSamples)
+			mixRamp_avx2(aSrc + i, aDst + i, aSamples - i, aPan + aPanDelta * i, aPanDelta);
+	}
+
+	SOLOUD_TARGET_AVX512
+	static void complexMulAdd_avx512(const float *aSrc0, const float *aSrc1, float *aDst, unsigned int aCount)
+	{
+		unsigned int i;
+		for (i = 0; i + 8 <= aCount; i += 8)
+		{
+			__m512 x = _mm512_loadu_ps(aSrc0 + i * 2);
+			__m512 y = _mm512_loadu_ps(aSrc1 + i * 2);
+			__m512 xswap = _mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1));
+			__m512 r = _mm512_fmaddsub_ps(x, _mm512_moveldup_ps(y), _mm512_mul_ps(xswap, _mm512_movehdup_ps(y)));
+			_mm512_storeu_ps(aDst + i * 2, _mm512_add_ps(_mm512_loadu_ps(aDst + i * 2), r));
+		}
+		if (i < aCount)
+			complexMulAdd_avx2(aSrc0 + i * 2, aSrc1 + i * 2, aDst + i * 2, aCount - i);
+	}
+
+	static const SimdKernels gAVX512Kernels =
+	{
+		clipHard_avx512,
+		clipRoundoff_avx512,
+#if defined(RESAMPLER_LINEAR)
+		resample_avx512,
+#else
+		resample_scalar,
+#endif
+		resamplePoint_scalar,
+		mixRamp_avx512,
+		complexMulAdd_avx512
+	};
+#endif
+
+	////////////////////////////////////////////////////////////
+	// CPU detection
+
+#ifdef SOLOUD_SSE_INTRINSICS
+	static void cpuid(unsigned int aLeaf, unsigned int aSubLeaf, unsigned int *aRegs)
+	{
+#if defined(_MSC_VER)
+		int r[4];
+		__cpuidex(r, (int)aLeaf, (int)aSubLeaf);
+		aRegs[0] = r[0];
+		aRegs[1] = r[1];
+		aRegs[2] = r[2];
+		aRegs[3] = r[3];
+#else
+		__cpuid_count(aLeaf, aSubLeaf, aRegs[0], aRegs[1], aRegs[2], aRegs[3]);
+#endif
+	}
+
+#ifdef SOLOUD_AVX_INTRINSICS
+	// Which register sets the OS saves on context switch
+	static unsigned long long xgetbv()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int lo, hi;
+		__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		return ((unsigned long long)hi << 32) | lo;
+#endif
+	}
+#endif
+
+	static unsigned int detectSimdLevel_internal()
+	{
+		unsigned int r[4];
+		cpuid(0, 0, r);
+		unsigned int maxleaf = r[0];
+		if (maxleaf < 1)
+			return Soloud::SIMD_SCALAR;
+
+		cpuid(1, 0, r);
+		if (!(r[3] & (1 << 26))) // SSE2
+			return Soloud::SIMD_SCALAR;
+
+		unsigned int level = Soloud::SIMD_SSE2;
+#ifdef SOLOUD_AVX_INTRINSICS
+		bool osxsave = (r[2] & (1 << 27)) != 0;
+		bool avx = (r[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || maxleaf < 7)
+			return level;
+		unsigned long long xcr0 = xgetbv();
+		// XMM and YMM state
+		if ((xcr0 & 0x6) != 0x6)
+			return level;
+
+		cpuid(7, 0, r);
+		if (!(r[1] & (1 << 5))) // AVX2
+			return level;
+		level = Soloud::SIMD_AVX2;
+
+		// Opmask and ZMM state
+		if ((r[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6) // AVX-512F
+			level = Soloud::SIMD_AVX512;
+#endif
+		return level;
+	}
+#endif
+
+	unsigned int detectSimdLevel()
+	{
+#ifdef SOLOUD_SSE_INTRINSICS
+		static int level = -1;
+		if (level < 0)
+			level = (int)detectSimdLevel_internal();
+		return (unsigned int)level;
+#else
+		return Soloud::SIMD_SCALAR;
+#endif
+	}
+
+	const SimdKernels *getSimdKernels(unsigned int aLevel)
+	{
+		switch (aLevel)
+		{
+#ifdef SOLOUD_AVX_INTRINSICS
+		case Soloud::SIMD_AVX512:
+			return &gAVX512Kernels;
+		case Soloud::SIMD_AVX2:
+			return &gAVX2Kernels;
+#else
+		case Soloud::SIMD_AVX512:
+		case Soloud::SIMD_AVX2:
+#endif
+#ifdef SOLOUD_SSE_INTRINSICS
+		case Soloud::SIMD_SSE2:
+			return &gSSE2Kernels;
+#endif
+		default:
+			return &gScalarKernels;
+		}
+	}
+
+	template <unsigned int SRC, unsigned int DST>
+	static MixVoiceKernel getMixVoiceKernel(unsigned int aLevel, bool aPoint)
+	{
+#ifdef SOLOUD_AVX_INTRINSICS
+		if (aLevel >= Soloud::SIMD_AVX2)
+			return aPoint ? mixVoice_avx2<SRC, DST, true> : mixVoice_avx2<SRC, DST, false>;
+#endif
+#ifdef SOLOUD_SSE_INTRINSICS
+		if (aLevel >= Soloud::SIMD_SSE2)
+			return aPoint ? mixVoice_sse2<SRC, DST, true> : mixVoice_sse2<SRC, DST, false>;
+#endif
+		return aPoint ? mixVoice_scalar<SRC, DST, true> : mixVoice_scalar<SRC, DST, false>;
+	}
+
+	MixVoiceKernel getMixVoiceKernel(unsigned int aLevel, unsigned int aSrcChannels, unsigned int aDstChannels, bool aPoint)
+	{
+#if !defined(RESAMPLER_LINEAR)
+		aPoint = true;
+#endif
+		if (aDstChannels == 1)
+		{
+			switch (aSrcChannels)
+			{
+			case 1: return getMixVoiceKernel<1, 1>(aLevel, aPoint);
+			case 2: return getMixVoiceKernel<2, 1>(aLevel, aPoint);
+			case 4: return getMixVoiceKernel<4, 1>(aLevel, aPoint);
+			case 6: return getMixVoiceKernel<6, 1>(aLevel, aPoint);
+			case 8: return getMixVoiceKernel<8, 1>(aLevel, aPoint);
+			}
+		}
+		else if (aSrcChannels == 1)
+		{
+			switch (aDstChannels)
+			{
+			case 2: return getMixVoiceKernel<1, 2>(aLevel, aPoint);
+			case 4: return getMixVoiceKernel<1, 4>(aLevel, aPoint);
+			case 6: return getMixVoiceKernel<1, 6>(aLevel, aPoint);
+			case 8: return getMixVoiceKernel<1, 8>(aLevel, aPoint);
+			}
+		}
+		else if (aSrcChannels == aDstChannels)
+		{
+			switch (aDstChannels)
+			{
+			case 2: return getMixVoiceKernel<2, 2>(aLevel, aPoint);
+			case 4: return getMixVoiceKernel<4, 4>(aLevel, aPoint);
+			case 6: return getMixVoiceKernel<6, 6>(aLevel, aPoint);
+			case 8: return getMixVoiceKernel<8, 8>(aLevel, aPoint);
+			}
+		}
+		return NULL;
+	}
+};
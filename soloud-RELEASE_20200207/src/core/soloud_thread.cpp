@@ -22,11 +22,16 @@ freely, subject to the following restrictions:
    distribution.
 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // CPU_SET
+#endif
+
 #if defined(_WIN32)||defined(_WIN64)
 #include <windows.h>
 #else
 #include <inttypes.h>
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include <time.h>
 #endif
@@ -51,6 +56,12 @@ namespace SoLoud
 			return (void*)cs;
 		}
 
+		void * createPriorityInheritanceMutex()
+		{
+			// Windows boosts the owners of contended critical sections on its own
+			return NULL;
+		}
+
 		void destroyMutex(void *aHandle)
 		{
 			CRITICAL_SECTION *cs = (CRITICAL_SECTION*)aHandle;
@@ -76,6 +87,47 @@ namespace SoLoud
 			}
 		}
 
+		void * createCondition()
+		{
+			CONDITION_VARIABLE * cv = new CONDITION_VARIABLE;
+			InitializeConditionVariable(cv);
+			return (void*)cv;
+		}
+
+		void destroyCondition(void *aHandle)
+		{
+			CONDITION_VARIABLE *cv = (CONDITION_VARIABLE*)aHandle;
+			delete cv;
+		}
+
+		void waitCondition(void *aCondition, void *aMutex)
+		{
+			CONDITION_VARIABLE *cv = (CONDITION_VARIABLE*)aCondition;
+			CRITICAL_SECTION *cs = (CRITICAL_SECTION*)aMutex;
+			if (cv && cs)
+			{
+				SleepConditionVariableCS(cv, cs, INFINITE);
+			}
+		}
+
+		void signalCondition(void *aCondition)
+		{
+			CONDITION_VARIABLE *cv = (CONDITION_VARIABLE*)aCondition;
+			if (cv)
+			{
+				WakeConditionVariable(cv);
+			}
+		}
+
+		void broadcastCondition(void *aCondition)
+		{
+			CONDITION_VARIABLE *cv = (CONDITION_VARIABLE*)aCondition;
+			if (cv)
+			{
+				WakeAllConditionVariable(cv);
+			}
+		}
+
 		struct soloud_thread_data
 		{
 			threadFunction mFunc;
@@ -105,6 +157,28 @@ namespace SoLoud
             return threadHandle;
 		}
 
+		unsigned int setThreadScheduling(unsigned int aPolicy, int aPriority)
+		{
+			// No real-time policies on Windows; use the highest priority class a normal process can
+			if (aPolicy == Soloud::SCHEDULE_NORMAL)
+			{
+				SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+				return Soloud::SCHEDULE_NORMAL;
+			}
+			if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+				return aPolicy;
+			return Soloud::SCHEDULE_NORMAL;
+		}
+
+		unsigned long long setThreadAffinity(unsigned long long aCoreMask)
+		{
+			if (aCoreMask == 0)
+				return 0;
+			if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)aCoreMask) == 0)
+				return 0;
+			return aCoreMask;
+		}
+
 		void sleep(int aMSec)
 		{
 			Sleep(aMSec);
@@ -126,6 +200,49 @@ namespace SoLoud
 			return GetTickCount();
 		}
 
+		unsigned long long getTimeMicros()
+		{
+			LARGE_INTEGER frequency, counter;
+			QueryPerformanceFrequency(&frequency);
+			QueryPerformanceCounter(&counter);
+			return (unsigned long long)(counter.QuadPart / frequency.QuadPart) * 1000000 +
+				(unsigned long long)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+		}
+
+		int getCoreCount()
+		{
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			if (info.dwNumberOfProcessors < 1)
+				return 1;
+			return (int)info.dwNumberOfProcessors;
+		}
+
+		unsigned int atomicLoad(volatile unsigned int *aValue)
+		{
+			return (unsigned int)InterlockedCompareExchange((volatile LONG*)aValue, 0, 0);
+		}
+
+		void atomicStore(volatile unsigned int *aValue, unsigned int aNewValue)
+		{
+			InterlockedExchange((volatile LONG*)aValue, (LONG)aNewValue);
+		}
+
+		unsigned int atomicAdd(volatile unsigned int *aValue, int aDelta)
+		{
+			return (unsigned int)InterlockedExchangeAdd((volatile LONG*)aValue, (LONG)aDelta) + aDelta;
+		}
+
+		void * atomicCompareExchangePointer(void * volatile *aValue, void *aExpected, void *aNewValue)
+		{
+			return InterlockedCompareExchangePointer(aValue, aNewValue, aExpected);
+		}
+
+		void * atomicExchangePointer(void * volatile *aValue, void *aNewValue)
+		{
+			return InterlockedExchangePointer(aValue, aNewValue);
+		}
+
 #else // pthreads
         struct ThreadHandleData
         {
@@ -145,6 +262,29 @@ namespace SoLoud
 			return (void*)mutex;
 		}
 
+		void * createPriorityInheritanceMutex()
+		{
+#if defined(_POSIX_THREAD_PRIO_INHERIT) && _POSIX_THREAD_PRIO_INHERIT > 0
+			pthread_mutexattr_t attr;
+			pthread_mutexattr_init(&attr);
+			if (pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT) != 0)
+			{
+				pthread_mutexattr_destroy(&attr);
+				return NULL;
+			}
+			pthread_mutex_t *mutex = new pthread_mutex_t;
+			if (pthread_mutex_init(mutex, &attr) != 0)
+			{
+				delete mutex;
+				mutex = NULL;
+			}
+			pthread_mutexattr_destroy(&attr);
+			return (void*)mutex;
+#else
+			return NULL;
+#endif
+		}
+
 		void destroyMutex(void *aHandle)
 		{
 			pthread_mutex_t *mutex = (pthread_mutex_t*)aHandle;
@@ -174,6 +314,53 @@ namespace SoLoud
 			}
 		}
 
+		void * createCondition()
+		{
+			pthread_cond_t *cond;
+			cond = new pthread_cond_t;
+			pthread_cond_init(cond, NULL);
+			return (void*)cond;
+		}
+
+		void destroyCondition(void *aHandle)
+		{
+			pthread_cond_t *cond = (pthread_cond_t*)aHandle;
+
+			if (cond)
+			{
+				pthread_cond_destroy(cond);
+				delete cond;
+			}
+		}
+
+		void waitCondition(void *aCondition, void *aMutex)
+		{
+			pthread_cond_t *cond = (pthread_cond_t*)aCondition;
+			pthread_mutex_t *mutex = (pthread_mutex_t*)aMutex;
+			if (cond && mutex)
+			{
+				pthread_cond_wait(cond, mutex);
+			}
+		}
+
+		void signalCondition(void *aCondition)
+		{
+			pthread_cond_t *cond = (pthread_cond_t*)aCondition;
+			if (cond)
+			{
+				pthread_cond_signal(cond);
+			}
+		}
+
+		void broadcastCondition(void *aCondition)
+		{
+			pthread_cond_t *cond = (pthread_cond_t*)aCondition;
+			if (cond)
+			{
+				pthread_cond_broadcast(cond);
+			}
+		}
+
 		struct soloud_thread_data
 		{
 			threadFunction mFunc;
@@ -199,6 +386,66 @@ namespace SoLoud
             return threadHandle;
 		}
 
+		unsigned int setThreadScheduling(unsigned int aPolicy, int aPriority)
+		{
+			int policy = SCHED_OTHER;
+			if (aPolicy == Soloud::SCHEDULE_FIFO)
+				policy = SCHED_FIFO;
+			if (aPolicy == Soloud::SCHEDULE_RR)
+				policy = SCHED_RR;
+			struct sched_param param;
+			param.sched_priority = 0;
+			if (policy != SCHED_OTHER)
+			{
+				int lo = sched_get_priority_min(policy);
+				int hi = sched_get_priority_max(policy);
+				param.sched_priority = aPriority ? aPriority : (lo + hi) / 2;
+				if (param.sched_priority < lo) param.sched_priority = lo;
+				if (param.sched_priority > hi) param.sched_priority = hi;
+			}
+			// Fails without the privilege (root, CAP_SYS_NICE or an rtprio limit); the thread keeps its old policy then
+			pthread_setschedparam(pthread_self(), policy, &param);
+
+			if (pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+				return Soloud::SCHEDULE_NORMAL;
+			if (policy == SCHED_FIFO)
+				return Soloud::SCHEDULE_FIFO;
+			if (policy == SCHED_RR)
+				return Soloud::SCHEDULE_RR;
+			return Soloud::SCHEDULE_NORMAL;
+		}
+
+		unsigned long long setThreadAffinity(unsigned long long aCoreMask)
+		{
+#if defined(__linux__) && defined(CPU_SET)
+			if (aCoreMask == 0)
+				return 0;
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			int i;
+			for (i = 0; i < 64; i++)
+			{
+				if (aCoreMask & (1ULL << i))
+					CPU_SET(i, &set);
+			}
+			// pid 0 is the calling thread
+			if (sched_setaffinity(0, sizeof(set), &set) != 0)
+				return 0;
+			unsigned long long mask = 0;
+			if (sched_getaffinity(0, sizeof(set), &set) != 0)
+				return 0;
+			for (i = 0; i < 64; i++)
+			{
+				if (CPU_ISSET(i, &set))
+					mask |= 1ULL << i;
+			}
+			return mask;
+#else
+			(void)aCoreMask;
+			return 0;
+#endif
+		}
+
 		void sleep(int aMSec)
 		{
 			//usleep(aMSec * 1000);
@@ -224,23 +471,158 @@ namespace SoLoud
 			clock_gettime(CLOCK_REALTIME, &spec);
 			return spec.tv_sec * 1000 + (int)(spec.tv_nsec / 1.0e6);
 		}
+
+		unsigned long long getTimeMicros()
+		{
+			struct timespec spec;
+			clock_gettime(CLOCK_MONOTONIC, &spec);
+			return (unsigned long long)spec.tv_sec * 1000000 + spec.tv_nsec / 1000;
+		}
+
+		int getCoreCount()
+		{
+			long count = sysconf(_SC_NPROCESSORS_ONLN);
+			if (count < 1)
+				return 1;
+			return (int)count;
+		}
+
+		unsigned int atomicLoad(volatile unsigned int *aValue)
+		{
+			return __atomic_load_n(aValue, __ATOMIC_ACQUIRE);
+		}
+
+		void atomicStore(volatile unsigned int *aValue, unsigned int aNewValue)
+		{
+			__atomic_store_n(aValue, aNewValue, __ATOMIC_RELEASE);
+		}
+
+		unsigned int atomicAdd(volatile unsigned int *aValue, int aDelta)
+		{
+			return __atomic_add_fetch(aValue, (unsigned int)aDelta, __ATOMIC_SEQ_CST);
+		}
+
+		void * atomicCompareExchangePointer(void * volatile *aValue, void *aExpected, void *aNewValue)
+		{
+			__atomic_compare_exchange_n(aValue, &aExpected, aNewValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+			return aExpected;
+		}
+
+		void * atomicExchangePointer(void * volatile *aValue, void *aNewValue)
+		{
+			return __atomic_exchange_n(aValue, aNewValue, __ATOMIC_SEQ_CST);
+		}
 #endif
 
 		static void poolWorker(void *aParam)
 		{
-			Pool *myPool = (Pool*)aParam;
-			while (myPool->mRunning)
+			PoolQueue *myQueue = (PoolQueue*)aParam;
+			Pool *myPool = myQueue->mPool;
+			PoolTask *t;
+			while ((t = myPool->waitWork(myQueue->mWorker)) != 0)
 			{
-				PoolTask *t = myPool->getWork();
-				if (!t)
-				{
-					sleep(1);
-				}
-				else
-				{
-					t->work();
-				}
+				myPool->runTask_internal(t);
+			}
+		}
+
+		PoolTask::PoolTask()
+		{
+			mGroup = 0;
+		}
+
+		PoolTaskGroup::PoolTaskGroup()
+		{
+			mMutex = createMutex();
+			mCondition = createCondition();
+			mPending = 0;
+		}
+
+		PoolTaskGroup::~PoolTaskGroup()
+		{
+			destroyCondition(mCondition);
+			destroyMutex(mMutex);
+		}
+
+		unsigned int PoolTaskGroup::getPendingCount()
+		{
+			lockMutex(mMutex);
+			unsigned int pending = mPending;
+			unlockMutex(mMutex);
+			return pending;
+		}
+
+		void PoolTaskGroup::taskDone_internal()
+		{
+			lockMutex(mMutex);
+			mPending--;
+			// Wake the waiters before unlocking; a waiter may destroy the group as soon as it sees this.
+			if (mPending == 0)
+				broadcastCondition(mCondition);
+			unlockMutex(mMutex);
+		}
+
+		PoolQueue::PoolQueue()
+		{
+			mMutex = createMutex();
+			mTask = 0;
+			mCapacity = 0;
+			mHead = 0;
+			mCount = 0;
+			mPool = 0;
+			mWorker = 0;
+		}
+
+		PoolQueue::~PoolQueue()
+		{
+			delete[] mTask;
+			destroyMutex(mMutex);
+		}
+
+		void PoolQueue::push(PoolTask *aTask)
+		{
+			lockMutex(mMutex);
+			if (mCount == mCapacity)
+			{
+				unsigned int newcap = mCapacity ? mCapacity * 2 : 64;
+				PoolTask **n = new PoolTask*[newcap];
+				unsigned int i;
+				for (i = 0; i < mCount; i++)
+					n[i] = mTask[(mHead + i) % mCapacity];
+				delete[] mTask;
+				mTask = n;
+				mCapacity = newcap;
+				mHead = 0;
+			}
+			mTask[(mHead + mCount) % mCapacity] = aTask;
+			mCount++;
+			unlockMutex(mMutex);
+		}
+
+		PoolTask * PoolQueue::pop()
+		{
+			PoolTask *t = 0;
+			lockMutex(mMutex);
+			if (mCount > 0)
+			{
+				mCount--;
+				t = mTask[(mHead + mCount) % mCapacity];
+			}
+			unlockMutex(mMutex);
+			return t;
+		}
+
+		PoolTask * PoolQueue::steal()
+		{
+			PoolTask *t = 0;
+			lockMutex(mMutex);
+			if (mCount > 0)
+			{
+				t = mTask[mHead];
+				mHead = (mHead + 1) % mCapacity;
+				mCount--;
 			}
+			unlockMutex(mMutex);
+			return t;
 		}
 
 		Pool::Pool()
@@ -248,16 +630,20 @@ namespace SoLoud
 			mRunning = 0;
 			mThreadCount = 0;
 			mThread = 0;
-			mWorkMutex = 0;
+			mQueue = 0;
+			mQueued = 0;
+			mSleeping = 0;
 			mRobin = 0;
-			mMaxTask = 0;
-			for (int i = 0; i < MAX_THREADPOOL_TASKS; i++)
-				mTaskArray[i] = 0;
+			mSleepMutex = 0;
+			mSleepCondition = 0;
 		}
 
 		Pool::~Pool()
 		{
+			if (mSleepMutex) lockMutex(mSleepMutex);
 			mRunning = 0;
+			if (mSleepMutex) unlockMutex(mSleepMutex);
+			broadcastCondition(mSleepCondition);
 			int i;
 			for (i = 0; i < mThreadCount; i++)
 			{
@@ -265,66 +651,143 @@ namespace SoLoud
 				release(mThread[i]);
 			}
 			delete[] mThread;
-			if (mWorkMutex)
-				destroyMutex(mWorkMutex);
+			delete[] mQueue;
+			if (mSleepCondition)
+				destroyCondition(mSleepCondition);
+			if (mSleepMutex)
+				destroyMutex(mSleepMutex);
 		}
 
 		void Pool::init(int aThreadCount)
 		{
 			if (aThreadCount > 0)
 			{
-				mMaxTask = 0;
-				mWorkMutex = createMutex();
+				mSleepMutex = createMutex();
+				mSleepCondition = createCondition();
 				mRunning = 1;
 				mThreadCount = aThreadCount;
+				mQueue = new PoolQueue[aThreadCount];
 				mThread = new ThreadHandle[aThreadCount];
 				int i;
 				for (i = 0; i < mThreadCount; i++)
 				{
-					mThread[i] = createThread(poolWorker, this);
+					mQueue[i].mPool = this;
+					mQueue[i].mWorker = i;
+				}
+				for (i = 0; i < mThreadCount; i++)
+				{
+					mThread[i] = createThread(poolWorker, &mQueue[i]);
 				}
 			}
 		}
 
-		void Pool::addWork(PoolTask *aTask)
+		void Pool::addWork(PoolTask *aTask, PoolTaskGroup *aGroup)
 		{
+			aTask->mGroup = aGroup;
+			if (aGroup)
+			{
+				lockMutex(aGroup->mMutex);
+				aGroup->mPending++;
+				unlockMutex(aGroup->mMutex);
+			}
 			if (mThreadCount == 0)
 			{
-				aTask->work();
+				runTask_internal(aTask);
+				return;
+			}
+			// Count the task before it's visible, so a worker taking it can't push the count below zero
+			atomicAdd(&mQueued, 1);
+			mQueue[atomicAdd(&mRobin, 1) % mThreadCount].push(aTask);
+			// A worker going to sleep counts itself as sleeping before it checks for work,
+			// and we add the work before checking for sleepers, so one of us sees the other.
+			if (atomicLoad(&mSleeping))
+			{
+				lockMutex(mSleepMutex);
+				signalCondition(mSleepCondition);
+				unlockMutex(mSleepMutex);
 			}
-			else
+		}
+
+		void Pool::runTask_internal(PoolTask *aTask)
+		{
+			// The task may be reused or deleted once its work is done
+			PoolTaskGroup *group = aTask->mGroup;
+			aTask->work();
+			if (group)
+				group->taskDone_internal();
+		}
+
+		void Pool::waitGroup(PoolTaskGroup *aGroup)
+		{
+			for (;;)
 			{
-				if (mWorkMutex) lockMutex(mWorkMutex);
-				if (mMaxTask == MAX_THREADPOOL_TASKS)
+				lockMutex(aGroup->mMutex);
+				unsigned int pending = aGroup->mPending;
+				unlockMutex(aGroup->mMutex);
+				if (pending == 0)
+					return;
+
+				// Help out instead of blocking a thread the tasks may need
+				PoolTask *t = getWork();
+				if (t)
 				{
-					// If we're at max tasks, do the task on calling thread 
-					// (we're in trouble anyway, might as well slow down adding more work)
-					if (mWorkMutex) unlockMutex(mWorkMutex);
-					aTask->work();
+					runTask_internal(t);
+					continue;
 				}
-				else
+
+				// Everything left is running on other threads
+				lockMutex(aGroup->mMutex);
+				while (aGroup->mPending && atomicLoad(&mQueued) == 0)
+					waitCondition(aGroup->mCondition, aGroup->mMutex);
+				pending = aGroup->mPending;
+				unlockMutex(aGroup->mMutex);
+				if (pending == 0)
+					return;
+			}
+		}
+
+		PoolTask * Pool::getWork()
+		{
+			int i;
+			for (i = 0; i < mThreadCount; i++)
+			{
+				PoolTask *t = mQueue[i].steal();
+				if (t)
 				{
-					mTaskArray[mMaxTask] = aTask;
-					mMaxTask++;
-					if (mWorkMutex) unlockMutex(mWorkMutex);
+					atomicAdd(&mQueued, -1);
+					return t;
 				}
 			}
+			return 0;
 		}
 
-		PoolTask * Pool::getWork()
+		PoolTask * Pool::waitWork(int aWorker)
 		{
-			PoolTask *t = 0;
-			if (mWorkMutex) lockMutex(mWorkMutex);
-			if (mMaxTask > 0)
+			while (mRunning)
 			{
-				int r = mRobin % mMaxTask;
-				mRobin++;
-				t = mTaskArray[r];
-				mTaskArray[r] = mTaskArray[mMaxTask - 1];
-				mMaxTask--;
+				// Own queue newest first, while the data it touched is still in cache
+				PoolTask *t = mQueue[aWorker].pop();
+				int i;
+				for (i = 1; t == 0 && i < mThreadCount; i++)
+				{
+					t = mQueue[(aWorker + i) % mThreadCount].steal();
+				}
+				if (t)
+				{
+					atomicAdd(&mQueued, -1);
+					return t;
+				}
+
+				lockMutex(mSleepMutex);
+				atomicAdd(&mSleeping, 1);
+				while (mRunning && atomicLoad(&mQueued) == 0)
+				{
+					waitCondition(mSleepCondition, mSleepMutex);
+				}
+				atomicAdd(&mSleeping, -1);
+				unlockMutex(mSleepMutex);
 			}
-			if (mWorkMutex) unlockMutex(mWorkMutex);
-			return t;
+			return 0;
 		}
 	}
 }
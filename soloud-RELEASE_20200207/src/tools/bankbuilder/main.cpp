@@ -0,0 +1,172 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+claim that you wrote the original software. If you use this software
+in a product, an acknowledgment in the product documentation would be
+appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be
+misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+// Builds a pre-decoded sound bank for SoLoud::SoundBank.
+//
+// Usage: bankbuilder output.bank [-l looppoint] file[=name] [[-l looppoint] file[=name] ...]
+//
+// Every input is decoded with SoLoud::Wav and stored as deinterleaved floats.
+// The name defaults to the file name. "-l" marks the next file as looping,
+// with the loop point given in samples.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_soundbank.h"
+
+#define VERSION "SoLoud Sound Bank Builder (c)2020 Jari Komppa http://iki.fi/sol/"
+
+struct Input
+{
+	char *mFilename;
+	char *mName;
+	unsigned int mLoopPoint;
+	bool mLooping;
+	SoLoud::Wav mWav;
+};
+
+static unsigned int align(unsigned int aOffset)
+{
+	return (aOffset + SOLOUD_SOUNDBANK_ALIGN - 1) & ~(SOLOUD_SOUNDBANK_ALIGN - 1);
+}
+
+static void pad(FILE *f, unsigned int &aPos, unsigned int aTarget)
+{
+	while (aPos < aTarget)
+	{
+		fputc(0, f);
+		aPos++;
+	}
+}
+
+int main(int parc, char ** pars)
+{
+	printf(VERSION "\n");
+	if (parc < 3)
+	{
+		printf("Usage: %s output.bank [-l looppoint] file[=name] ...\n", pars[0]);
+		return 0;
+	}
+
+	Input *input = new Input[parc];
+	int count = 0;
+	int i;
+	bool loopnext = false;
+	unsigned int looppoint = 0;
+	for (i = 2; i < parc; i++)
+	{
+		if (strcmp(pars[i], "-l") == 0 && i + 1 < parc)
+		{
+			loopnext = true;
+			looppoint = (unsigned int)atoi(pars[i + 1]);
+			i++;
+			continue;
+		}
+		Input &in = input[count];
+		in.mFilename = pars[i];
+		in.mName = pars[i];
+		char *eq = strchr(pars[i], '=');
+		if (eq)
+		{
+			*eq = 0;
+			in.mName = eq + 1;
+		}
+		in.mLooping = loopnext;
+		in.mLoopPoint = looppoint;
+		loopnext = false;
+		looppoint = 0;
+
+		SoLoud::result res = in.mWav.load(in.mFilename);
+		if (res != SoLoud::SO_NO_ERROR)
+		{
+			printf("Can't load \"%s\" (error %d)\n", in.mFilename, res);
+			delete[] input;
+			return -1;
+		}
+		printf("%s: %d channels, %d samples at %.0fHz\n", in.mName, in.mWav.mChannels, in.mWav.mSampleCount, in.mWav.mBaseSamplerate);
+		count++;
+	}
+
+	// Layout: header, index, names, then 16-byte aligned sample data
+	SoLoud::SoundBankHeader header;
+	memset(&header, 0, sizeof(header));
+	header.mMagic = SOLOUD_SOUNDBANK_MAGIC;
+	header.mVersion = SOLOUD_SOUNDBANK_VERSION;
+	header.mCount = count;
+	header.mIndexOffset = sizeof(SoLoud::SoundBankHeader);
+
+	SoLoud::SoundBankEntry *entry = new SoLoud::SoundBankEntry[count];
+	memset(entry, 0, sizeof(SoLoud::SoundBankEntry) * count);
+	unsigned int pos = header.mIndexOffset + sizeof(SoLoud::SoundBankEntry) * count;
+	for (i = 0; i < count; i++)
+	{
+		entry[i].mNameOffset = pos;
+		pos += (unsigned int)strlen(input[i].mName) + 1;
+	}
+	for (i = 0; i < count; i++)
+	{
+		pos = align(pos);
+		entry[i].mDataOffset = pos;
+		entry[i].mSampleCount = input[i].mWav.mSampleCount;
+		entry[i].mChannels = input[i].mWav.mChannels;
+		entry[i].mSamplerate = input[i].mWav.mBaseSamplerate;
+		entry[i].mLoopPoint = input[i].mLoopPoint;
+		entry[i].mFlags = input[i].mLooping ? SoLoud::SoundBankEntry::LOOPING : 0;
+		pos += input[i].mWav.mSampleCount * input[i].mWav.mChannels * sizeof(float);
+	}
+	header.mFileSize = pos;
+
+	FILE *f = fopen(pars[1], "wb");
+	if (!f)
+	{
+		printf("Can't open \"%s\" for writing\n", pars[1]);
+		delete[] entry;
+		delete[] input;
+		return -1;
+	}
+	fwrite(&header, sizeof(header), 1, f);
+	fwrite(entry, sizeof(SoLoud::SoundBankEntry), count, f);
+	pos = header.mIndexOffset + sizeof(SoLoud::SoundBankEntry) * count;
+	for (i = 0; i < count; i++)
+	{
+		unsigned int len = (unsigned int)strlen(input[i].mName) + 1;
+		fwrite(input[i].mName, 1, len, f);
+		pos += len;
+	}
+	for (i = 0; i < count; i++)
+	{
+		pad(f, pos, entry[i].mDataOffset);
+		unsigned int bytes = entry[i].mSampleCount * entry[i].mChannels * sizeof(float);
+		fwrite(input[i].mWav.mData, 1, bytes, f);
+		pos += bytes;
+	}
+	fclose(f);
+
+	printf("Wrote %d sounds, %d bytes to \"%s\"\n", count, pos, pars[1]);
+	delete[] entry;
+	delete[] input;
+	return 0;
+}
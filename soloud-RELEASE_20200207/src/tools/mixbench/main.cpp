@@ -0,0 +1,119 @@
+/*
+SoLoud audio engine
+Copyright (c) 2013-2020 Jari Komppa
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+claim that you wrote the original software. If you use this software
+in a product, an acknowledgment in the product documentation would be
+appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be
+misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+// Measures mixer CPU cost against the mix granularity.
+//
+// Usage: mixbench [voices] [seconds]
+//
+// Plays looping voices at varying speeds (so every one is resampled), half
+// of them through a biquad filter, and mixes them with the null driver one
+// granularity-sized block at a time, like a low-latency backend would.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_biquadresonantfilter.h"
+#include "soloud_thread.h"
+
+#define VERSION "SoLoud Mixer Benchmark (c)2020 Jari Komppa http://iki.fi/sol/"
+
+#define SOURCE_SAMPLES 44100
+
+int main(int parc, char ** pars)
+{
+	printf(VERSION "\n");
+	int voices = 64;
+	int seconds = 60;
+	if (parc > 1) voices = atoi(pars[1]);
+	if (parc > 2) seconds = atoi(pars[2]);
+	if (voices < 1 || voices >= (int)VOICE_COUNT_MAX || seconds < 1)
+	{
+		printf("Usage: %s [voices (1-%d)] [seconds]\n", pars[0], VOICE_COUNT_MAX - 1);
+		return 0;
+	}
+
+	// Stereo noise, so that nothing gets optimized away
+	float *data = new float[SOURCE_SAMPLES * 2];
+	unsigned int seed = 1;
+	int i;
+	for (i = 0; i < SOURCE_SAMPLES * 2; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		data[i] = ((seed >> 9) / (float)(1 << 23)) * 2 - 1;
+	}
+	SoLoud::Wav wav;
+	wav.loadRawWave(data, SOURCE_SAMPLES, 44100, 2, true);
+	wav.setLooping(true);
+	delete[] data;
+
+	SoLoud::BiquadResonantFilter lowpass;
+	lowpass.setParams(SoLoud::BiquadResonantFilter::LOWPASS, 4000, 2);
+
+	printf("%d voices, %d seconds of audio at 44100Hz\n\n", voices, seconds);
+	printf("granularity  latency     ms total   us/block   x realtime\n");
+
+	unsigned int granularity;
+	for (granularity = SAMPLE_GRANULARITY_MIN; granularity <= SAMPLE_GRANULARITY; granularity *= 2)
+	{
+		SoLoud::Soloud soloud;
+		SoLoud::result res = soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER, 44100, granularity, 2, granularity);
+		if (res != SoLoud::SO_NO_ERROR)
+		{
+			printf("init failed: %s\n", soloud.getErrorString(res));
+			return -1;
+		}
+		if (voices >= VOICE_COUNT)
+			soloud.setVoiceCapacity(voices + 1);
+		soloud.setMaxActiveVoiceCount(voices);
+		for (i = 0; i < voices; i++)
+		{
+			// Full volume, so no voice is culled as inaudible; the clipper takes care of the sum
+			wav.setFilter(0, (i & 1) ? &lowpass : 0);
+			SoLoud::handle h = soloud.play(wav);
+			soloud.setRelativePlaySpeed(h, 0.5f + (i % 16) / 16.0f);
+			soloud.setPan(h, (i % 9) / 4.0f - 1);
+		}
+		wav.setFilter(0, 0);
+
+		float *buf = new float[granularity * 2];
+		unsigned int blocks = seconds * 44100 / granularity;
+		unsigned int b;
+		int start = SoLoud::Thread::getTimeMillis();
+		for (b = 0; b < blocks; b++)
+			soloud.mix(buf, granularity);
+		int ms = SoLoud::Thread::getTimeMillis() - start;
+		if (ms < 1) ms = 1;
+		delete[] buf;
+
+		printf("%11d  %5.1f ms  %11d  %9.2f  %11.1f\n",
+			granularity,
+			granularity * 1000.0f / 44100,
+			ms,
+			ms * 1000.0f / blocks,
+			seconds * 1000.0f / ms);
+		soloud.deinit();
+	}
+	return 0;
+}
@@ -47,6 +47,7 @@ distribution.
 #include "soloud_lofifilter.h"
 #include "soloud_monotone.h"
 #include "soloud_openmpt.h"
+#include "soloud_queue.h"
 #include "soloud_robotizefilter.h"
 #include "soloud_sfxr.h"
 #include "soloud_speech.h"
@@ -100,7 +101,7 @@ long getmsec()
 
 	clock_gettime(CLOCK_MONOTONIC, &ts);
 
-	return (ts->tv_sec * 1000) + (ts->tv_nsec / 1000000)
+	return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
 }
 #endif
 
@@ -1430,6 +1431,212 @@ void testSpeech()
 	soloud.deinit();
 }
 
+// Test voice handles past the old 255 voice limit
+//
+// Soloud.setVoiceCapacity
+// Soloud.getVoiceCapacity
+// Soloud.getVoiceCount
+// Soloud.isValidVoiceHandle
+// Soloud.createVoiceGroup
+// Soloud.addVoiceToGroup
+// Soloud.isVoiceGroup
+// Soloud.isVoiceGroupEmpty
+// Soloud.destroyVoiceGroup
+void testHandles()
+{
+	static SoLoud::handle h[1500];
+	SoLoud::result res;
+	SoLoud::Soloud soloud;
+	SoLoud::Wav wav;
+	generateTestWave(wav);
+	res = soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER);
+	CHECK_RES(res);
+
+	CHECK(soloud.getVoiceCapacity() == VOICE_COUNT);
+	CHECK(soloud.setVoiceCapacity(VOICE_COUNT_MAX + 1) != 0);
+	res = soloud.setVoiceCapacity(2048);
+	CHECK_RES(res);
+	CHECK(soloud.getVoiceCapacity() == 2048);
+
+	int i, valid = 1, inrange = 1, unique = 1;
+	for (i = 0; i < 1500; i++)
+	{
+		h[i] = soloud.play(wav, -1, 0, true);
+		if (!soloud.isValidVoiceHandle(h[i]))
+			valid = 0;
+		if ((h[i] & VOICE_HANDLE_SLOT_MASK) == 0 || (h[i] & VOICE_HANDLE_SLOT_MASK) > 2048)
+			inrange = 0;
+		if (i > 0 && (h[i] & VOICE_HANDLE_SLOT_MASK) == (h[i - 1] & VOICE_HANDLE_SLOT_MASK))
+			unique = 0;
+	}
+	CHECK(valid);
+	CHECK(inrange);
+	CHECK(unique);
+	CHECK(soloud.getVoiceCount() == 1500);
+
+	// A reused slot gets a new handle, and the old one stays invalid
+	soloud.stop(h[1200]);
+	CHECK(!soloud.isValidVoiceHandle(h[1200]));
+	SoLoud::handle reused = soloud.play(wav, -1, 0, true);
+	CHECK((reused & VOICE_HANDLE_SLOT_MASK) == (h[1200] & VOICE_HANDLE_SLOT_MASK));
+	CHECK(reused != h[1200]);
+	CHECK(soloud.isValidVoiceHandle(reused));
+	CHECK(!soloud.isValidVoiceHandle(h[1200]));
+
+	SoLoud::handle group = soloud.createVoiceGroup();
+	CHECK(soloud.isVoiceGroup(group));
+	CHECK(!soloud.isVoiceGroup(h[1400]));
+	CHECK_RES(soloud.addVoiceToGroup(group, h[1400]));
+	CHECK(!soloud.isVoiceGroupEmpty(group));
+	CHECK(!soloud.isValidVoiceHandle(group));
+	soloud.stop(group);
+	CHECK(!soloud.isValidVoiceHandle(h[1400]));
+	CHECK_RES(soloud.destroyVoiceGroup(group));
+
+	// Shrinking stops the voices past the new capacity
+	res = soloud.setVoiceCapacity(1024);
+	CHECK_RES(res);
+	CHECK(soloud.isValidVoiceHandle(h[0]));
+	CHECK(!soloud.isValidVoiceHandle(h[1450]));
+	CHECK(soloud.getVoiceCount() == 1024);
+
+	soloud.deinit();
+}
+
+// Short tone that keeps count of its live instances
+int liveinstances = 0;
+
+class CountedInstance : public SoLoud::AudioSourceInstance
+{
+public:
+	unsigned int mOffset;
+	CountedInstance()
+	{
+		mOffset = 0;
+		liveinstances++;
+	}
+	virtual ~CountedInstance()
+	{
+		liveinstances--;
+	}
+	virtual unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int /*aBufferSize*/)
+	{
+		unsigned int i;
+		for (i = 0; i < aSamplesToRead && mOffset < 400; i++, mOffset++)
+			aBuffer[i] = (mOffset & 1) ? 0.5f : -0.5f;
+		return i;
+	}
+	virtual bool hasEnded()
+	{
+		return mOffset >= 400;
+	}
+};
+
+class CountedSource : public SoLoud::AudioSource
+{
+public:
+	virtual SoLoud::AudioSourceInstance *createInstance()
+	{
+		return new CountedInstance;
+	}
+};
+
+// Test queued sources
+//
+// Queue.setParams
+// Queue.play
+// Queue.getQueueCount
+void testQueue()
+{
+	float scratch[2048];
+	SoLoud::result res;
+	SoLoud::Soloud soloud;
+	SoLoud::Queue queue;
+	res = soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER);
+	CHECK_RES(res);
+	queue.setParams(44100, 1);
+	soloud.play(queue);
+
+	{
+		CountedSource counted;
+		res = queue.play(counted);
+		CHECK_RES(res);
+		res = queue.play(counted);
+		CHECK_RES(res);
+		CHECK(queue.getQueueCount() == 2);
+		soloud.mix(scratch, 1000);
+		CHECK(queue.getQueueCount() == 0);
+		CHECK_BUF_NONZERO(scratch, 2000);
+	}
+	// Played-out instances must be gone before their source is
+	CHECK(liveinstances == 0);
+
+	soloud.deinit();
+}
+
+// Test the play scheduler
+//
+// Soloud.playScheduled
+// Soloud.cancelScheduled
+// Soloud.cancelAllScheduled
+// Soloud.getScheduledCount
+// Wav.stop
+void testScheduler()
+{
+	float scratch[2048];
+	SoLoud::result res;
+	SoLoud::Soloud soloud;
+	SoLoud::Wav wav, other;
+	generateTestWave(wav);
+	generateTestWave(other);
+	res = soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER);
+	CHECK_RES(res);
+
+	unsigned int id = soloud.playScheduled(1, wav);
+	CHECK(id != 0);
+	CHECK(soloud.getScheduledCount() == 1);
+	CHECK_RES(soloud.cancelScheduled(id));
+	CHECK(soloud.getScheduledCount() == 0);
+	CHECK(soloud.cancelScheduled(id) != 0);
+
+	// A single stop has to cancel every pending play of the source, wherever it sits in the heap
+	SoLoud::Misc::Prg prg;
+	prg.srand(0x1337);
+	int i, j, left = 0;
+	for (i = 0; i < 50; i++)
+	{
+		unsigned int others = 0;
+		for (j = 0; j < 40; j++)
+		{
+			SoLoud::time t = 1 + (prg.rand() % 1000) / 100.0;
+			if (prg.rand() & 1)
+			{
+				soloud.playScheduled(t, wav);
+			}
+			else
+			{
+				soloud.playScheduled(t, other);
+				others++;
+			}
+		}
+		wav.stop();
+		if (soloud.getScheduledCount() != others)
+			left++;
+		soloud.cancelAllScheduled();
+	}
+	CHECK(left == 0);
+	CHECK(soloud.getScheduledCount() == 0);
+
+	soloud.playScheduled(0.01f, wav);
+	soloud.mix(scratch, 1000);
+	CHECK(soloud.getScheduledCount() == 0);
+	CHECK(soloud.getActiveVoiceCount() == 1);
+	CHECK_BUF_NONZERO(scratch, 2000);
+	soloud.stopAll();
+
+	soloud.deinit();
+}
+
 void testMixer()
 {
 	SoLoud::Soloud soloud;
@@ -1536,6 +1743,9 @@ int main(int parc, char ** pars)
 	testFilters();
 	testCore();
 	testSpeech();
+	testHandles();
+	testScheduler();
+	testQueue();
 //	testSpeedThings();
 //	testMixer();
 	printf("\n%d tests, %d error(s) ", tests, errorcount);